@@ -0,0 +1,194 @@
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <type_traits>
+
+#include "Arrow_Sink.hpp"
+#include "Arrow_Stream.hpp"
+#include "Column_Sink.hpp"
+
+template<>
+struct ArrowDictionary<MDUpdateAction>
+{
+    static constexpr int64_t ID = 0;
+    static constexpr std::pair<MDUpdateAction, std::string_view> VALUES[] = {
+        { MDUpdateAction::New, "New" },
+        { MDUpdateAction::Change, "Change" },
+        { MDUpdateAction::Delete, "Delete" } };
+};
+
+template<>
+struct ArrowDictionary<MDEntryType>
+{
+    static constexpr int64_t ID = 1;
+    static constexpr std::pair<MDEntryType, std::string_view> VALUES[] = {
+        { MDEntryType::Bid, "Bid" },
+        { MDEntryType::Offer, "Offer" },
+        { MDEntryType::EmptyBook, "EmptyBook" } };
+};
+
+template<>
+struct ArrowDictionary<SecurityTradingStatus>
+{
+    static constexpr int64_t ID = 2;
+    static constexpr std::pair<SecurityTradingStatus, std::string_view> VALUES[] = {
+        { SecurityTradingStatus::TradingHalt, "TradingHalt" },
+        { SecurityTradingStatus::ReadyToTrade, "ReadyToTrade" },
+        { SecurityTradingStatus::NotAvailableForTrading, "NotAvailableForTrading" },
+        { SecurityTradingStatus::NotTradedOnThisMarket, "NotTradedOnThisMarket" },
+        { SecurityTradingStatus::UnknownOrInvalid, "UnknownOrInvalid" },
+        { SecurityTradingStatus::PreOpen, "PreOpen" },
+        { SecurityTradingStatus::DiscreteAuctionOpen, "DiscreteAuctionOpen" },
+        { SecurityTradingStatus::DiscreteAuctionClose, "DiscreteAuctionClose" },
+        { SecurityTradingStatus::InstrumentHalt, "InstrumentHalt" } };
+};
+
+namespace
+{
+    using Time = ArrowTimestamp;
+    using OptionalTime = std::optional<ArrowTimestamp>;
+
+    std::string tablePath(const std::filesystem::path& directory, const char* name)
+    {
+        return (directory / (std::string(name) + ".arrows")).string();
+    }
+
+    // Int64NULL fields, which the decoded messages keep as plain integers
+    std::optional<int64_t> nullableInt64(int64_t value) noexcept
+    {
+        if (value == std::numeric_limits<int64_t>::max())
+            return std::nullopt;
+        return value;
+    }
+
+    OptionalTime transactTime(const SIMBAPacket& packet) noexcept
+    {
+        if (!packet.incrementalHeader)
+            return std::nullopt;
+        return Time{ packet.incrementalHeader->TransactTime };
+    }
+}
+
+struct ArrowSink::Tables
+{
+    Tables(const std::filesystem::path& root, bool complete)
+        : orderUpdate(tablePath(root, MessageTraits<OrderUpdate>::name), { "SendingTime", "MsgSeqNum", "TransactTime",
+              "MDEntryID", "MDEntryPx", "MDEntrySize", "MDFlags", "SecurityID", "RptSeq", "MDUpdateAction", "MDEntryType" }, complete),
+          orderExecution(tablePath(root, MessageTraits<OrderExecution>::name), { "SendingTime", "MsgSeqNum", "TransactTime",
+              "MDEntryID", "MDEntryPx", "MDEntrySize", "LastPx", "LastQty", "TradeID", "MDFlags", "SecurityID", "RptSeq",
+              "MDUpdateAction", "MDEntryType" }, complete),
+          orderBookSnapshot(tablePath(root, MessageTraits<OrderBookSnapshot>::name), { "SendingTime", "MsgSeqNum", "SecurityID",
+              "LastMsgSeqNumProcessed", "RptSeq", "ExchangeTradingSessionID", "MDEntryID", "TransactTime", "MDEntryPx",
+              "MDEntrySize", "TradeID", "MDFlags", "MDEntryType" }, complete),
+          bestPrices(tablePath(root, MessageTraits<BestPrices>::name), { "SendingTime", "MsgSeqNum",
+              "MktBidPx", "MktOfferPx", "MktBidSize", "MktOfferSize", "SecurityID" }, complete),
+          emptyBook(tablePath(root, MessageTraits<EmptyBook>::name), { "SendingTime", "MsgSeqNum", "LastMsgSeqNumProcessed" }, complete),
+          securityStatus(tablePath(root, MessageTraits<SecurityStatus>::name), { "SendingTime", "MsgSeqNum", "SecurityID", "Symbol",
+              "SecurityTradingStatus", "HighLimitPx", "LowLimitPx", "InitialMarginOnBuy", "InitialMarginOnSell",
+              "InitialMarginSyntetic" }, complete),
+          securityDefinitionUpdateReport(tablePath(root, MessageTraits<SecurityDefinitionUpdateReport>::name), { "SendingTime",
+              "MsgSeqNum", "SecurityID", "Volatility", "TheorPrice", "TheorPriceLimit" }, complete),
+          securityMassStatus(tablePath(root, MessageTraits<SecurityMassStatus>::name), { "SendingTime", "MsgSeqNum",
+              "SecurityID", "SecurityTradingStatus" }, complete) {}
+
+    ArrowTable<Time, uint32_t, OptionalTime, int64_t, Decimal5, int64_t, uint64_t, int32_t, uint32_t, MDUpdateAction, MDEntryType> orderUpdate;
+    ArrowTable<Time, uint32_t, OptionalTime, int64_t, Decimal5NULL, std::optional<int64_t>, Decimal5, int64_t, int64_t, uint64_t, int32_t,
+        uint32_t, MDUpdateAction, MDEntryType> orderExecution;
+    ArrowTable<Time, uint32_t, int32_t, uint32_t, uint32_t, uint32_t, int64_t, Time, Decimal5NULL, std::optional<int64_t>,
+        std::optional<int64_t>, uint64_t, MDEntryType> orderBookSnapshot;
+    ArrowTable<Time, uint32_t, Decimal5NULL, Decimal5NULL, int64_t, int64_t, int32_t> bestPrices;
+    ArrowTable<Time, uint32_t, uint32_t> emptyBook;
+    ArrowTable<Time, uint32_t, int32_t, std::string_view, SecurityTradingStatus, Decimal5NULL, Decimal5NULL, Decimal2NULL, Decimal2NULL,
+        Decimal2NULL> securityStatus;
+    ArrowTable<Time, uint32_t, int32_t, Decimal5NULL, Decimal5NULL, Decimal5NULL> securityDefinitionUpdateReport;
+    ArrowTable<Time, uint32_t, int32_t, SecurityTradingStatus> securityMassStatus;
+};
+
+ArrowSink::ArrowSink(const std::string& outputDirectory, bool complete)
+{
+    std::filesystem::create_directories(outputDirectory);
+    tables = std::make_unique<Tables>(outputDirectory, complete);
+}
+
+ArrowSink::~ArrowSink() = default; // The streams write their last record batches
+
+TemplateFilter ArrowSink::requiredTemplates()
+{
+    return ColumnSink::requiredTemplates();
+}
+
+void ArrowSink::onPacket(const SIMBAPacket& packet)
+{
+    const Time sendingTime{ packet.marketDataHeader.SendingTime };
+    const uint32_t msgSeqNum = packet.marketDataHeader.MsgSeqNum;
+
+    packet.messages.forEach([&](const auto& message)
+    {
+        using Message = std::remove_cvref_t<decltype(message)>;
+        if constexpr (std::is_same_v<Message, OrderUpdate>)
+        {
+            tables->orderUpdate.row(sendingTime, msgSeqNum, transactTime(packet), message.MDEntryID, message.MDEntryPx,
+                message.MDEntrySize, static_cast<uint64_t>(message.MDFlags), message.SecurityID, message.RptSeq,
+                message.mdUpdateAction, message.mdEntryType);
+        }
+        else if constexpr (std::is_same_v<Message, OrderExecution>)
+        {
+            tables->orderExecution.row(sendingTime, msgSeqNum, transactTime(packet), message.MDEntryID, message.MDEntryPx,
+                nullableInt64(message.MDEntrySize), message.LastPx, message.LastQty, message.TradeID, static_cast<uint64_t>(message.MDFlags),
+                message.SecurityID, message.RptSeq, message.mdUpdateAction, message.mdEntryType);
+        }
+        else if constexpr (std::is_same_v<Message, OrderBookSnapshot>)
+        {
+            if (!message.MDEntries)
+                return;
+            for (const OrderBookSnapshotEntry& entry : *message.MDEntries)
+            {
+                tables->orderBookSnapshot.row(sendingTime, msgSeqNum, message.SecurityID, message.LastMsgSeqNumProcessed,
+                    message.RptSeq, message.ExchangeTradingSessionID, entry.MDEntryID, Time{ entry.TransactTime }, entry.MDEntryPx,
+                    nullableInt64(entry.MDEntrySize), nullableInt64(entry.TradeID), static_cast<uint64_t>(entry.MDFlags), entry.mdEntryType);
+            }
+        }
+        else if constexpr (std::is_same_v<Message, BestPrices>)
+        {
+            for (const BestPricesEntry& entry : message.MDEntries)
+            {
+                tables->bestPrices.row(sendingTime, msgSeqNum, entry.MktBidPx, entry.MktOfferPx, entry.MktBidSize,
+                    entry.MktOfferSize, entry.SecurityID);
+            }
+        }
+        else if constexpr (std::is_same_v<Message, EmptyBook>)
+        {
+            tables->emptyBook.row(sendingTime, msgSeqNum, message.LastMsgSeqNumProcessed);
+        }
+        else if constexpr (std::is_same_v<Message, SecurityStatus>)
+        {
+            const std::string_view symbol(message.Symbol, strnlen(message.Symbol, sizeof(message.Symbol)));
+            tables->securityStatus.row(sendingTime, msgSeqNum, message.SecurityID, symbol, message.securityTradingStatus,
+                message.HighLimitPx, message.LowLimitPx, message.InitialMarginOnBuy, message.InitialMarginOnSell,
+                message.InitialMarginSyntetic);
+        }
+        else if constexpr (std::is_same_v<Message, SecurityDefinitionUpdateReport>)
+        {
+            tables->securityDefinitionUpdateReport.row(sendingTime, msgSeqNum, message.SecurityID, message.Volatility,
+                message.TheorPrice, message.TheorPriceLimit);
+        }
+        else if constexpr (std::is_same_v<Message, SecurityMassStatus>)
+        {
+            for (const SecurityMassStatusEntry& entry : message.Entries)
+                tables->securityMassStatus.row(sendingTime, msgSeqNum, entry.SecurityID, entry.securityTradingStatus);
+        }
+    });
+}
+
+void ArrowSink::appendPart(const std::string& partDirectory)
+{
+    const std::filesystem::path part = partDirectory;
+    tables->orderUpdate.appendPart(tablePath(part, MessageTraits<OrderUpdate>::name));
+    tables->orderExecution.appendPart(tablePath(part, MessageTraits<OrderExecution>::name));
+    tables->orderBookSnapshot.appendPart(tablePath(part, MessageTraits<OrderBookSnapshot>::name));
+    tables->bestPrices.appendPart(tablePath(part, MessageTraits<BestPrices>::name));
+    tables->emptyBook.appendPart(tablePath(part, MessageTraits<EmptyBook>::name));
+    tables->securityStatus.appendPart(tablePath(part, MessageTraits<SecurityStatus>::name));
+    tables->securityDefinitionUpdateReport.appendPart(tablePath(part, MessageTraits<SecurityDefinitionUpdateReport>::name));
+    tables->securityMassStatus.appendPart(tablePath(part, MessageTraits<SecurityMassStatus>::name));
+}
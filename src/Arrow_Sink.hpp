@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Packet_Sink.hpp"
+#include "Parser_Options.hpp"
+
+// Writes the messages of each numeric template as an Arrow IPC stream, <output>/<template>.arrows, one row
+// per message or per entry of its repeating group. Rows carry the packet's SendingTime, MsgSeqNum and
+// TransactTime (null outside incremental packets) as UTC timestamps, decimals are Decimal128 of their
+// scale, *NULL values are null and enums are dictionary encoded. The tables are the ones of ColumnSink
+class ArrowSink : public PacketSink
+{
+public:
+	// Without complete, only record batches are written, for the parts ParallelDecoder joins with appendPart
+	explicit ArrowSink(const std::string& outputDirectory, bool complete = true);
+	~ArrowSink() override;
+
+	// The templates there are tables for, nothing else is decoded
+	static TemplateFilter requiredTemplates();
+
+	void onPacket(const SIMBAPacket& packet) override;
+
+	// Appends every table of an incomplete sink's output directory to this one's
+	void appendPart(const std::string& partDirectory);
+
+private:
+	struct Tables;
+	std::unique_ptr<Tables> tables;
+};
@@ -0,0 +1,385 @@
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "Arrow_Stream.hpp"
+
+namespace
+{
+    // Builds a flatbuffer front to back: a table is written before what its offset fields point to, so
+    // every offset points forward as the format requires, and its vtable right before it
+    class FlatBuilder
+    {
+    public:
+        using Child = std::function<uint32_t(FlatBuilder&)>; // Writes an object, returns its position
+
+        struct Slot
+        {
+            uint16_t id;     // Of the field in the table's schema
+            uint8_t size;    // Of a scalar, 0 for an offset to a child object
+            uint64_t value;
+            Child child;
+        };
+
+        template<typename T>
+        static Slot scalar(uint16_t id, T value)
+        {
+            uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(T));
+            return Slot{ id, sizeof(T), bits, {} };
+        }
+
+        static Slot offset(uint16_t id, Child child) { return Slot{ id, 0, 0, std::move(child) }; }
+
+        uint32_t table(std::vector<Slot> slots)
+        {
+            // Widest fields first, so none needs padding after the first one
+            std::stable_sort(slots.begin(), slots.end(), [](const Slot& a, const Slot& b) { return width(a) > width(b); });
+
+            uint16_t fieldCount = 0;
+            std::vector<uint16_t> fieldOffsets(slots.size());
+            uint16_t tableSize = 4; // The offset to the vtable
+            for (size_t i = 0; i < slots.size(); ++i)
+            {
+                fieldCount = std::max<uint16_t>(fieldCount, slots[i].id + 1);
+                tableSize = (tableSize + width(slots[i]) - 1) / width(slots[i]) * width(slots[i]);
+                fieldOffsets[i] = tableSize;
+                tableSize += width(slots[i]);
+            }
+
+            pad(2);
+            const uint32_t vtable = position();
+            std::vector<uint16_t> entries(2 + fieldCount, 0);
+            entries[0] = static_cast<uint16_t>(entries.size() * sizeof(uint16_t));
+            entries[1] = tableSize;
+            for (size_t i = 0; i < slots.size(); ++i)
+                entries[2 + slots[i].id] = fieldOffsets[i];
+            append(entries.data(), entries.size() * sizeof(uint16_t));
+
+            pad(8);
+            const uint32_t table = position();
+            bytes.resize(table + tableSize);
+            put<int32_t>(table, static_cast<int32_t>(table - vtable));
+            for (size_t i = 0; i < slots.size(); ++i)
+            {
+                if (slots[i].size != 0)
+                    std::memcpy(bytes.data() + table + fieldOffsets[i], &slots[i].value, slots[i].size);
+            }
+            for (size_t i = 0; i < slots.size(); ++i)
+            {
+                if (slots[i].size == 0)
+                    link(table + fieldOffsets[i], slots[i].child(*this));
+            }
+            return table;
+        }
+
+        uint32_t string(std::string_view text)
+        {
+            pad(4);
+            const uint32_t start = position();
+            const uint32_t length = static_cast<uint32_t>(text.size());
+            append(&length, sizeof(length));
+            append(text.data(), text.size());
+            bytes.push_back(0);
+            return start;
+        }
+
+        uint32_t vector(const std::vector<Child>& elements)
+        {
+            pad(4);
+            const uint32_t start = position();
+            const uint32_t length = static_cast<uint32_t>(elements.size());
+            append(&length, sizeof(length));
+            bytes.resize(bytes.size() + elements.size() * sizeof(uint32_t));
+            for (size_t i = 0; i < elements.size(); ++i)
+                link(start + 4 + i * 4, elements[i](*this));
+            return start;
+        }
+
+        // A vector of structs of 64 bit fields, which have to be aligned to 8 after the length
+        uint32_t structs(const void* data, uint32_t count, size_t size)
+        {
+            pad(4);
+            if ((bytes.size() + 4) % 8 != 0)
+                bytes.resize(bytes.size() + 4);
+            const uint32_t start = position();
+            append(&count, sizeof(count));
+            append(data, count * size);
+            return start;
+        }
+
+        std::vector<char> finish(const Child& root)
+        {
+            bytes.assign(4, 0);
+            link(0, root(*this));
+            pad(8);
+            return std::move(bytes);
+        }
+
+    private:
+        static uint8_t width(const Slot& slot) noexcept { return slot.size != 0 ? slot.size : 4; }
+
+        uint32_t position() const noexcept { return static_cast<uint32_t>(bytes.size()); }
+
+        void pad(size_t alignment) { bytes.resize((bytes.size() + alignment - 1) / alignment * alignment); }
+
+        void append(const void* data, size_t size)
+        {
+            if (size == 0)
+                return;
+            const char* begin = static_cast<const char*>(data);
+            bytes.insert(bytes.end(), begin, begin + size);
+        }
+
+        template<typename T>
+        void put(uint32_t at, T value) { std::memcpy(bytes.data() + at, &value, sizeof(T)); }
+
+        void link(uint32_t at, uint32_t target) { put<uint32_t>(at, target - at); }
+
+        std::vector<char> bytes;
+    };
+
+    using Slot = FlatBuilder::Slot;
+    using Child = FlatBuilder::Child;
+
+    // Numbers from the Arrow format's Schema.fbs and Message.fbs
+    constexpr int16_t METADATA_V5 = 4;
+    constexpr uint8_t HEADER_SCHEMA = 1;
+    constexpr uint8_t HEADER_DICTIONARY_BATCH = 2;
+    constexpr uint8_t HEADER_RECORD_BATCH = 3;
+    constexpr int16_t TIME_UNIT_NANOSECOND = 3;
+    constexpr int32_t DECIMAL_PRECISION = 19; // Digits of an int64 mantissa
+
+    struct FieldNode
+    {
+        int64_t length;
+        int64_t nullCount;
+    };
+
+    struct BufferSpec
+    {
+        int64_t offset; // In the message body
+        int64_t length;
+    };
+
+    // A record batch's body, every buffer padded to 8 bytes
+    struct Body
+    {
+        std::vector<char> bytes;
+        std::vector<FieldNode> nodes;
+        std::vector<BufferSpec> buffers;
+
+        void buffer(const void* data, size_t size)
+        {
+            buffers.push_back(BufferSpec{ static_cast<int64_t>(bytes.size()), static_cast<int64_t>(size) });
+            if (size == 0)
+                return;
+            const char* begin = static_cast<const char*>(data);
+            bytes.insert(bytes.end(), begin, begin + size);
+            bytes.resize((bytes.size() + 7) / 8 * 8);
+        }
+
+        void column(const ArrowColumn& column, size_t rows, bool utf8)
+        {
+            nodes.push_back(FieldNode{ static_cast<int64_t>(rows), static_cast<int64_t>(column.nulls) });
+            if (column.nulls != 0)
+                buffer(column.validity.data(), (rows + 7) / 8);
+            else
+                buffer(nullptr, 0); // No bitmap, every value is valid
+            if (utf8)
+                buffer(column.offsets.data(), column.offsets.size() * sizeof(int32_t));
+            buffer(column.values.data(), column.values.size());
+        }
+    };
+
+    Child intType(uint8_t bitWidth, bool isSigned)
+    {
+        return [=](FlatBuilder& builder)
+        {
+            return builder.table({ FlatBuilder::scalar<int32_t>(0, bitWidth), FlatBuilder::scalar<bool>(1, isSigned) });
+        };
+    }
+
+    Child fieldType(const ArrowField& field)
+    {
+        switch (field.dictionary >= 0 ? ArrowField::Utf8 : field.type)
+        {
+        case ArrowField::Int:
+            return intType(field.bitWidth, field.isSigned);
+        case ArrowField::Utf8:
+            return [](FlatBuilder& builder) { return builder.table({}); };
+        case ArrowField::Decimal:
+            return [scale = field.scale](FlatBuilder& builder)
+            {
+                return builder.table({ FlatBuilder::scalar<int32_t>(0, DECIMAL_PRECISION), FlatBuilder::scalar<int32_t>(1, scale),
+                    FlatBuilder::scalar<int32_t>(2, 128) });
+            };
+        case ArrowField::Timestamp:
+            return [](FlatBuilder& builder)
+            {
+                return builder.table({ FlatBuilder::scalar<int16_t>(0, TIME_UNIT_NANOSECOND),
+                    FlatBuilder::offset(1, [](FlatBuilder& builder) { return builder.string("UTC"); }) });
+            };
+        }
+        throw std::runtime_error("Unknown Arrow field type.");
+    }
+
+    Child schemaField(const ArrowField& field)
+    {
+        return [&field](FlatBuilder& builder)
+        {
+            std::vector<Slot> slots{
+                FlatBuilder::offset(0, [&field](FlatBuilder& builder) { return builder.string(field.name); }),
+                FlatBuilder::scalar<bool>(1, field.nullable),
+                FlatBuilder::scalar<uint8_t>(2, field.dictionary >= 0 ? ArrowField::Utf8 : field.type),
+                FlatBuilder::offset(3, fieldType(field)),
+                FlatBuilder::offset(5, [](FlatBuilder& builder) { return builder.vector({}); }) // No children
+            };
+            if (field.dictionary >= 0)
+            {
+                slots.push_back(FlatBuilder::offset(4, [&field](FlatBuilder& builder)
+                {
+                    return builder.table({ FlatBuilder::scalar<int64_t>(0, field.dictionary), FlatBuilder::offset(1, intType(field.bitWidth, true)) });
+                }));
+            }
+            return builder.table(std::move(slots));
+        };
+    }
+
+    Child recordBatch(const Body& body, size_t rows)
+    {
+        return [&body, rows](FlatBuilder& builder)
+        {
+            return builder.table({
+                FlatBuilder::scalar<int64_t>(0, static_cast<int64_t>(rows)),
+                FlatBuilder::offset(1, [&body](FlatBuilder& builder)
+                {
+                    return builder.structs(body.nodes.data(), static_cast<uint32_t>(body.nodes.size()), sizeof(FieldNode));
+                }),
+                FlatBuilder::offset(2, [&body](FlatBuilder& builder)
+                {
+                    return builder.structs(body.buffers.data(), static_cast<uint32_t>(body.buffers.size()), sizeof(BufferSpec));
+                }) });
+        };
+    }
+
+    // An encapsulated message: continuation marker, metadata length, the Message flatbuffer and the body
+    std::vector<char> message(uint8_t headerType, const Child& header, const std::vector<char>& body)
+    {
+        FlatBuilder builder;
+        const std::vector<char> metadata = builder.finish([&](FlatBuilder& builder)
+        {
+            return builder.table({
+                FlatBuilder::scalar<int16_t>(0, METADATA_V5),
+                FlatBuilder::scalar<uint8_t>(1, headerType),
+                FlatBuilder::offset(2, header),
+                FlatBuilder::scalar<int64_t>(3, static_cast<int64_t>(body.size())) });
+        });
+
+        const int32_t prefix[2] = { -1, static_cast<int32_t>(metadata.size()) };
+        std::vector<char> bytes(sizeof(prefix) + metadata.size() + body.size());
+        std::memcpy(bytes.data(), prefix, sizeof(prefix));
+        std::copy(metadata.begin(), metadata.end(), bytes.begin() + sizeof(prefix));
+        std::copy(body.begin(), body.end(), bytes.begin() + sizeof(prefix) + metadata.size());
+        return bytes;
+    }
+
+    std::vector<char> schemaMessage(const std::vector<ArrowField>& fields)
+    {
+        return message(HEADER_SCHEMA, [&fields](FlatBuilder& builder)
+        {
+            return builder.table({ FlatBuilder::offset(1, [&fields](FlatBuilder& builder)
+            {
+                std::vector<Child> children;
+                for (const ArrowField& field : fields)
+                    children.push_back(schemaField(field));
+                return builder.vector(children);
+            }) });
+        }, {});
+    }
+
+    std::vector<char> dictionaryMessage(const ArrowField& field)
+    {
+        ArrowColumn values;
+        for (std::string_view value : field.dictionaryValues)
+            ArrowColumnType<std::string_view>::put(values, value);
+
+        Body body;
+        body.column(values, field.dictionaryValues.size(), true);
+        return message(HEADER_DICTIONARY_BATCH, [&](FlatBuilder& builder)
+        {
+            return builder.table({ FlatBuilder::scalar<int64_t>(0, field.dictionary),
+                FlatBuilder::offset(1, recordBatch(body, field.dictionaryValues.size())) });
+        }, body.bytes);
+    }
+}
+
+ArrowStream::ArrowStream(const std::string& filePath, std::vector<ArrowField> fields, bool complete)
+    : file(filePath, std::ios::out | std::ios::binary | std::ios::trunc), filePath(filePath), fieldList(std::move(fields)),
+      columnList(fieldList.size()), complete(complete)
+{
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open Arrow file " + filePath);
+    }
+    if (!complete)
+        return;
+
+    write(schemaMessage(fieldList));
+    std::vector<int64_t> written;
+    for (const ArrowField& field : fieldList)
+    {
+        if (field.dictionary < 0 || std::find(written.begin(), written.end(), field.dictionary) != written.end())
+            continue;
+        write(dictionaryMessage(field));
+        written.push_back(field.dictionary);
+    }
+}
+
+ArrowStream::~ArrowStream()
+{
+    if (rows != 0)
+        writeBatch();
+    if (complete)
+    {
+        const int32_t end[2] = { -1, 0 };
+        file.write(reinterpret_cast<const char*>(end), sizeof(end));
+    }
+}
+
+void ArrowStream::writeBatch()
+{
+    Body body;
+    for (size_t i = 0; i < columnList.size(); ++i)
+        body.column(columnList[i], rows, fieldList[i].type == ArrowField::Utf8 && fieldList[i].dictionary < 0);
+    write(message(HEADER_RECORD_BATCH, recordBatch(body, rows), body.bytes));
+
+    for (ArrowColumn& column : columnList)
+    {
+        column.values.clear();
+        column.offsets.assign(1, 0);
+        column.validity.clear();
+        column.nulls = 0;
+    }
+    rows = 0;
+}
+
+void ArrowStream::write(const std::vector<char>& bytes)
+{
+    file.write(bytes.data(), bytes.size());
+    if (file.fail()) {
+        throw std::runtime_error("Unable to write Arrow file " + filePath);
+    }
+}
+
+void ArrowStream::appendPart(const std::string& partPath)
+{
+    if (rows != 0)
+        writeBatch();
+
+    std::ifstream part(partPath, std::ios::in | std::ios::binary);
+    if (!part.is_open()) {
+        throw std::runtime_error("Unable to open Arrow file " + partPath);
+    }
+    if (part.peek() != std::ifstream::traits_type::eof())
+        file << part.rdbuf();
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SIMBA_Schema.hpp"
+
+// Arrow IPC streams (https://arrow.apache.org/docs/format/Columnar.html), written without the Arrow
+// library: the flatbuffer metadata of the few message types needed is built by hand in Arrow_Stream.cpp.
+// A stream is its schema, a dictionary batch per enum column, record batches of up to ARROW_BATCH_ROWS
+// rows and an end of stream marker, readable by pyarrow.ipc.open_stream or polars.read_ipc_stream
+
+static constexpr size_t ARROW_BATCH_ROWS = 64 * 1024;
+
+struct ArrowField
+{
+	enum Type : uint8_t { Int = 2, Utf8 = 5, Decimal = 7, Timestamp = 10 }; // Numbers in the schema's Type union
+
+	std::string name;
+	Type type = Int;
+	uint8_t bitWidth = 0;    // Of Int, and of the Decimal128 values
+	bool isSigned = false;
+	int32_t scale = 0;       // Of Decimal
+	bool nullable = false;
+	int64_t dictionary = -1; // Id of the dictionary the values index, the column's type is then Utf8
+	std::vector<std::string_view> dictionaryValues{};
+};
+
+// Buffers of one column of the record batch being filled
+struct ArrowColumn
+{
+	std::vector<char> values;          // Fixed width values, or the characters of Utf8 values
+	std::vector<int32_t> offsets{ 0 }; // Of Utf8 values into the characters
+	std::vector<uint8_t> validity;     // A bit per row, kept for nullable columns only
+	size_t nulls = 0;
+
+	void put(const void* value, size_t size)
+	{
+		const size_t used = values.size();
+		values.resize(used + size);
+		std::memcpy(values.data() + used, value, size);
+	}
+
+	void valid(size_t row, bool isValid)
+	{
+		if (row % 8 == 0)
+			validity.push_back(0);
+		if (isValid)
+			validity.back() |= static_cast<uint8_t>(1u << (row % 8));
+		else
+			++nulls;
+	}
+};
+
+// Values of an enum column as the names they index, specialised for every enum written
+template<typename Enum> struct ArrowDictionary;
+
+// Nanoseconds since the Unix epoch, a Timestamp column in UTC
+struct ArrowTimestamp
+{
+	uint64_t nanoseconds = 0;
+};
+
+// How a C++ value is written: its field in the schema, whether it is null and its bytes
+template<typename T> struct ArrowColumnType;
+
+template<std::integral T>
+struct ArrowColumnType<T>
+{
+	static ArrowField field(const char* name) { return ArrowField{ .name = name, .type = ArrowField::Int, .bitWidth = sizeof(T) * 8, .isSigned = std::is_signed_v<T> }; }
+	static bool valid(T) noexcept { return true; }
+	static void put(ArrowColumn& column, T value) { column.put(&value, sizeof(value)); }
+};
+
+template<>
+struct ArrowColumnType<ArrowTimestamp>
+{
+	static ArrowField field(const char* name) { return ArrowField{ .name = name, .type = ArrowField::Timestamp }; }
+	static bool valid(ArrowTimestamp) noexcept { return true; }
+	static void put(ArrowColumn& column, ArrowTimestamp value) { column.put(&value.nanoseconds, sizeof(value.nanoseconds)); }
+};
+
+// Decimals as Decimal128 of their mantissa and scale, the NULL_VALUE of the nullable ones as null
+template<typename Decimal>
+struct ArrowDecimalType
+{
+	static ArrowField field(const char* name)
+	{
+		ArrowField field{ .name = name, .type = ArrowField::Decimal, .bitWidth = 128, .isSigned = true, .scale = -Decimal::exponent };
+		if constexpr (requires { Decimal::NULL_VALUE; })
+			field.nullable = true;
+		return field;
+	}
+
+	static bool valid(const Decimal& value) noexcept
+	{
+		if constexpr (requires { Decimal::NULL_VALUE; })
+			return value.mantissa != Decimal::NULL_VALUE;
+		else
+			return true;
+	}
+
+	static void put(ArrowColumn& column, const Decimal& value)
+	{
+		const int64_t words[2] = { valid(value) ? value.mantissa : 0, valid(value) && value.mantissa < 0 ? -1 : 0 };
+		column.put(words, sizeof(words));
+	}
+};
+
+template<> struct ArrowColumnType<Decimal5> : ArrowDecimalType<Decimal5> {};
+template<> struct ArrowColumnType<Decimal5NULL> : ArrowDecimalType<Decimal5NULL> {};
+template<> struct ArrowColumnType<Decimal2NULL> : ArrowDecimalType<Decimal2NULL> {};
+
+// Enums as 8 bit indices into their dictionary, a value it does not have as null
+template<typename Enum> requires std::is_enum_v<Enum>
+struct ArrowColumnType<Enum>
+{
+	static constexpr std::array<int8_t, 256> INDEX = []
+	{
+		std::array<int8_t, 256> index{};
+		index.fill(-1);
+		for (size_t i = 0; i < std::size(ArrowDictionary<Enum>::VALUES); ++i)
+			index[static_cast<uint8_t>(ArrowDictionary<Enum>::VALUES[i].first)] = static_cast<int8_t>(i);
+		return index;
+	}();
+
+	static ArrowField field(const char* name)
+	{
+		ArrowField field{ .name = name, .type = ArrowField::Utf8, .bitWidth = 8, .isSigned = true, .nullable = true, .dictionary = ArrowDictionary<Enum>::ID };
+		for (const auto& [value, valueName] : ArrowDictionary<Enum>::VALUES)
+			field.dictionaryValues.push_back(valueName);
+		return field;
+	}
+
+	static bool valid(Enum value) noexcept { return INDEX[static_cast<uint8_t>(value)] >= 0; }
+
+	static void put(ArrowColumn& column, Enum value)
+	{
+		const int8_t index = std::max<int8_t>(INDEX[static_cast<uint8_t>(value)], 0);
+		column.put(&index, sizeof(index));
+	}
+};
+
+template<>
+struct ArrowColumnType<std::string_view>
+{
+	static ArrowField field(const char* name) { return ArrowField{ .name = name, .type = ArrowField::Utf8 }; }
+	static bool valid(std::string_view) noexcept { return true; }
+
+	static void put(ArrowColumn& column, std::string_view value)
+	{
+		column.put(value.data(), value.size());
+		column.offsets.push_back(static_cast<int32_t>(column.values.size()));
+	}
+};
+
+template<typename T>
+struct ArrowColumnType<std::optional<T>>
+{
+	static ArrowField field(const char* name)
+	{
+		ArrowField field = ArrowColumnType<T>::field(name);
+		field.nullable = true;
+		return field;
+	}
+
+	static bool valid(const std::optional<T>& value) noexcept { return value && ArrowColumnType<T>::valid(*value); }
+	static void put(ArrowColumn& column, const std::optional<T>& value) { ArrowColumnType<T>::put(column, value.value_or(T{})); }
+};
+
+// One Arrow IPC stream written to a file as its rows come in
+class ArrowStream
+{
+public:
+	// A stream that is not complete has neither the schema and dictionaries nor the end marker, only
+	// record batches, to be appended to a complete stream of the same fields by appendPart
+	ArrowStream(const std::string& filePath, std::vector<ArrowField> fields, bool complete = true);
+	~ArrowStream();
+
+	ArrowStream(const ArrowStream&) = delete;
+	ArrowStream& operator=(const ArrowStream&) = delete;
+
+	std::vector<ArrowColumn>& columns() noexcept { return columnList; }
+	const std::vector<ArrowField>& fields() const noexcept { return fieldList; }
+
+	void endRow()
+	{
+		if (++rows == ARROW_BATCH_ROWS)
+			writeBatch();
+	}
+
+	// Record batches of an incomplete stream written elsewhere, after the pending rows of this one
+	void appendPart(const std::string& partPath);
+
+	size_t rowCount() const noexcept { return rows; }
+
+private:
+	void writeBatch();
+	void write(const std::vector<char>& bytes);
+
+	std::ofstream file;
+	std::string filePath;
+	std::vector<ArrowField> fieldList;
+	std::vector<ArrowColumn> columnList;
+	size_t rows = 0; // Of the pending record batch
+	bool complete;
+};
+
+// The rows of one table, each value written as the ArrowColumnType of its C++ type
+template<typename... Values>
+class ArrowTable
+{
+public:
+	ArrowTable(const std::string& filePath, const std::array<const char*, sizeof...(Values)>& names, bool complete = true)
+		: stream(filePath, fields(names, std::index_sequence_for<Values...>{}), complete) {}
+
+	// By value, the fields of the packed message structs are not aligned for a reference
+	void row(Values... values)
+	{
+		put(std::index_sequence_for<Values...>{}, values...);
+		stream.endRow();
+	}
+
+	void appendPart(const std::string& partPath) { stream.appendPart(partPath); }
+
+private:
+	template<size_t... I>
+	static std::vector<ArrowField> fields(const std::array<const char*, sizeof...(Values)>& names, std::index_sequence<I...>)
+	{
+		return { ArrowColumnType<Values>::field(names[I])... };
+	}
+
+	template<size_t... I>
+	void put(std::index_sequence<I...>, const Values&... values)
+	{
+		std::vector<ArrowColumn>& columns = stream.columns();
+		const size_t row = stream.rowCount();
+		(putOne(columns[I], stream.fields()[I].nullable, row, values), ...);
+	}
+
+	template<typename T>
+	static void putOne(ArrowColumn& column, bool nullable, size_t row, const T& value)
+	{
+		if (nullable)
+			column.valid(row, ArrowColumnType<T>::valid(value));
+		ArrowColumnType<T>::put(column, value);
+	}
+
+	ArrowStream stream;
+};
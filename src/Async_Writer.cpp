@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "Async_Writer.hpp"
+
+AsyncFileWriter::AsyncFileWriter(const std::string& filePath, const CompressionOptions& compression, size_t bufferSize, size_t bufferCount)
+    : bufferSize((std::max<size_t>(bufferSize, 1) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT), buffers(std::max<size_t>(bufferCount, 2)),
+      compressor(Compressor::create(compression))
+{
+#ifdef _WIN32
+    file = CreateFile(filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Unable to open output file.");
+    }
+#else
+    fd = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open output file.");
+    }
+#endif
+
+    for (Buffer& buffer : buffers)
+    {
+        buffer.data.reset(static_cast<char*>(::operator new[](this->bufferSize, std::align_val_t{ ALIGNMENT })));
+        free.push_back(&buffer);
+    }
+    current = free.back();
+    free.pop_back();
+
+    thread = std::thread(&AsyncFileWriter::writeLoop, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n"; // A destructor cannot throw it
+    }
+}
+
+void AsyncFileWriter::write(const char* data, size_t size)
+{
+    while (size != 0)
+    {
+        const size_t chunk = std::min(size, bufferSize - current->used);
+        std::memcpy(current->data.get() + current->used, data, chunk);
+        current->used += chunk;
+        data += chunk;
+        size -= chunk;
+
+        if (current->used == bufferSize)
+            submit();
+    }
+}
+
+void AsyncFileWriter::submit()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!error.empty() && !errorReported) {
+        errorReported = true;
+        throw std::runtime_error(error);
+    }
+
+    current->offset = fileSize;
+    fileSize += current->used;
+    full.push_back(current);
+    ready.notify_one();
+
+    freed.wait(lock, [this] { return !free.empty(); }); // Only when every other buffer is still being written
+    current = free.back();
+    free.pop_back();
+    current->used = 0;
+}
+
+void AsyncFileWriter::close()
+{
+    if (closed)
+        return;
+    closed = true;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (current->used != 0)
+        {
+            current->offset = fileSize;
+            fileSize += current->used;
+            full.push_back(current);
+        }
+        finishing = true;
+    }
+    ready.notify_one();
+    thread.join();
+
+    if (compressor && error.empty())
+    {
+        try
+        {
+            compressed.clear();
+            compressor->finish(compressed);
+            writeAt(compressed.data(), compressed.size(), fileEnd);
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+        }
+    }
+#ifndef _WIN32
+    if (error.empty() && allocated > fileEnd && ftruncate(fd, static_cast<off_t>(fileEnd)) != 0) // Gives back the preallocated space past the end
+        error = std::string("Unable to write output file: ") + std::strerror(errno);
+#endif
+    closeFile();
+
+    if (!error.empty() && !errorReported) {
+        errorReported = true;
+        throw std::runtime_error(error);
+    }
+}
+
+void AsyncFileWriter::writeLoop()
+{
+    for (;;)
+    {
+        Buffer* buffer = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return !full.empty() || finishing; });
+            if (full.empty())
+                return;
+            buffer = full.front();
+            full.pop_front();
+        }
+
+        std::string failure;
+        try
+        {
+            writeBuffer(*buffer);
+        }
+        catch (const std::exception& e)
+        {
+            failure = e.what();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (error.empty())
+                error = failure;
+            free.push_back(buffer);
+        }
+        freed.notify_one();
+    }
+}
+
+void AsyncFileWriter::writeBuffer(const Buffer& buffer)
+{
+    if (!error.empty())
+        return; // Nothing more is written after a failure, the next write or close reports it
+
+    if (compressor)
+    {
+        compressed.clear();
+        compressor->compress(buffer.data.get(), buffer.used, compressed);
+        writeAt(compressed.data(), compressed.size(), fileEnd);
+    }
+    else
+    {
+        writeAt(buffer.data.get(), buffer.used, buffer.offset);
+    }
+}
+
+void AsyncFileWriter::writeAt(const char* data, size_t size, uint64_t offset)
+{
+    fileEnd = std::max(fileEnd, offset + size);
+
+#ifdef _WIN32
+    OVERLAPPED overlapped{};
+    overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+    overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+    DWORD written = 0;
+    if (!WriteFile(file, data, static_cast<DWORD>(size), &written, &overlapped) || written != size) {
+        throw std::runtime_error("Unable to write output file.");
+    }
+#else
+#ifdef __linux__
+    // Extents are reserved well ahead of the writes, a filesystem without fallocate just grows as before
+    if (preallocate && fileEnd > allocated)
+    {
+        const uint64_t length = std::max<uint64_t>(PREALLOCATE_SIZE, fileEnd - allocated);
+        if (fallocate(fd, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(allocated), static_cast<off_t>(length)) == 0)
+            allocated += length;
+        else
+            preallocate = false;
+    }
+#endif
+
+    size_t done = 0;
+    while (done < size)
+    {
+        const ssize_t written = pwrite(fd, data + done, size - done, static_cast<off_t>(offset + done));
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0) {
+            throw std::runtime_error(std::string("Unable to write output file: ") + std::strerror(errno));
+        }
+        done += static_cast<size_t>(written);
+    }
+#endif
+}
+
+void AsyncFileWriter::closeFile() noexcept
+{
+#ifdef _WIN32
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+#endif
+}
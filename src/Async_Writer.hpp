@@ -0,0 +1,171 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Compressor.hpp"
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN // Prevent old winsock.h from messing stuff up
+	#define NOMINMAX // Prevent macros for min and max
+	#include <windows.h>
+#endif
+
+// Writes a file from a background thread. Bytes are copied into the current one of a few large page
+// aligned buffers; a full buffer is handed to the writer thread, which writes it at its offset with
+// pwrite, and the caller carries on in the next free one. The caller only waits on the disk when every
+// buffer is full. On Linux the file is preallocated ahead of the writes with fallocate, keeping its
+// size, so it grows in large extents instead of a block at a time. With compression the writer thread
+// feeds the buffers to the compressor, whose own workers do the compressing for zstd, and writes what
+// comes out
+class AsyncFileWriter
+{
+public:
+	static constexpr size_t BUFFER_SIZE = 4 * 1024 * 1024;
+	static constexpr size_t BUFFER_COUNT = 3;
+
+	explicit AsyncFileWriter(const std::string& filePath, const CompressionOptions& compression = {},
+		size_t bufferSize = BUFFER_SIZE, size_t bufferCount = BUFFER_COUNT);
+	~AsyncFileWriter(); // Writes what is left, a failure is only printed, close throws it
+
+	AsyncFileWriter(const AsyncFileWriter&) = delete;
+	AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+	void write(const char* data, size_t size);
+
+	// Writes what is left and waits for the writer thread, throws if any write failed
+	void close();
+
+private:
+	static constexpr size_t ALIGNMENT = 4096;
+	static constexpr uint64_t PREALLOCATE_SIZE = 64 * 1024 * 1024;
+
+	struct AlignedDelete
+	{
+		void operator()(char* buffer) const noexcept { ::operator delete[](buffer, std::align_val_t{ ALIGNMENT }); }
+	};
+
+	struct Buffer
+	{
+		std::unique_ptr<char[], AlignedDelete> data;
+		size_t used = 0;
+		uint64_t offset = 0; // Of the first byte in the file
+	};
+
+	void submit();  // Hands the current buffer to the writer thread and takes a free one
+	void writeLoop();
+	void writeBuffer(const Buffer& buffer);
+	void writeAt(const char* data, size_t size, uint64_t offset);
+	void closeFile() noexcept;
+
+	size_t bufferSize;
+	std::vector<Buffer> buffers;
+	Buffer* current = nullptr;
+	uint64_t fileSize = 0;  // Bytes handed over so far
+	uint64_t allocated = 0;  // End of the preallocated extent, writer thread only
+	bool preallocate = true; // Until fallocate fails, on a filesystem or device without it
+	uint64_t fileEnd = 0;    // Of what the writer thread wrote, behind fileSize with compression
+
+	std::unique_ptr<Compressor> compressor; // Used by the writer thread only, null without compression
+	std::vector<char> compressed;
+
+	std::mutex mutex;
+	std::condition_variable ready; // A full buffer or the end for the writer thread
+	std::condition_variable freed; // A buffer written
+	std::deque<Buffer*> full;
+	std::vector<Buffer*> free;
+	bool finishing = false;
+	std::string error; // Of the first failed write, thrown once by the next write or close
+	bool errorReported = false;
+
+	std::thread thread;
+	bool closed = false;
+
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+#else
+	int fd = -1;
+#endif
+};
+
+// An ostream writing through an AsyncFileWriter, for the sinks that format their output with operator<<
+class AsyncFileStream : public std::ostream
+{
+public:
+	explicit AsyncFileStream(const std::string& filePath, const CompressionOptions& compression = {})
+		: std::ostream(nullptr), buffer(filePath, compression)
+	{
+		rdbuf(&buffer);
+	}
+
+	// Writes what is left and waits for the writer thread, throws if any write failed. A failure inside
+	// operator<< only sets badbit, so that is checked too
+	void close()
+	{
+		buffer.pubsync();
+		buffer.writer.close();
+		if (bad()) {
+			throw std::runtime_error("Unable to write output file.");
+		}
+	}
+
+private:
+	class Buffer : public std::streambuf
+	{
+	public:
+		Buffer(const std::string& filePath, const CompressionOptions& compression) : writer(filePath, compression)
+		{
+			setp(text, text + sizeof(text));
+		}
+
+		~Buffer() override
+		{
+			try
+			{
+				sync(); // The writer then writes it when destroyed
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << "Error: " << e.what() << "\n";
+			}
+		}
+
+		AsyncFileWriter writer;
+
+	protected:
+		int_type overflow(int_type character) override
+		{
+			sync();
+			if (!traits_type::eq_int_type(character, traits_type::eof()))
+			{
+				*pptr() = traits_type::to_char_type(character);
+				pbump(1);
+			}
+			return traits_type::not_eof(character);
+		}
+
+		int sync() override
+		{
+			writer.write(pbase(), static_cast<size_t>(pptr() - pbase()));
+			setp(text, text + sizeof(text));
+			return 0;
+		}
+
+	private:
+		char text[64 * 1024];
+	};
+
+	Buffer buffer;
+};
@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <iostream>
+#include <type_traits>
+
+#include "Book_Builder.hpp"
+#include "SIMBA_JSON.hpp"
+
+BookBuilder::BookBuilder(std::ostream& output, const ParserOptions& options)
+    : output(output), mode(options.mode), verifier(book, std::cerr), depth(options.depth), depthLevels(options.depth), depthInterval(options.interval)
+{
+    if (options.verifyBooks)
+        recovery.setVerifier(&verifier);
+    if (mode == OutputMode::L2Depth)
+        book.setListener(&depth);
+    else if (mode == OutputMode::BBO)
+        book.setListener(&topOfBook);
+}
+
+TemplateFilter BookBuilder::requiredTemplates(OutputMode mode)
+{
+    TemplateFilter filter;
+    filter.addMessage(MessageTraits<OrderUpdate>::templateId);
+    filter.addMessage(MessageTraits<OrderExecution>::templateId);
+    filter.addMessage(MessageTraits<OrderBookSnapshot>::templateId);
+    filter.addMessage(MessageTraits<SecurityDefinition>::templateId);
+    filter.addMessage(MessageTraits<SecurityDefinitionUpdateReport>::templateId);
+    if (mode == OutputMode::BBO)
+        filter.addMessage(MessageTraits<BestPrices>::templateId);
+    return filter;
+}
+
+void BookBuilder::onPacket(const SIMBAPacket& packet)
+{
+    const uint64_t sendingTime = packet.marketDataHeader.SendingTime;
+
+    if (mode == OutputMode::L2Depth && depthInterval != 0 && sendingTime >= nextDepthTime)
+    {
+        // This packet starts a new interval, the books as they are now close the previous one
+        if (nextDepthTime != 0)
+            writeDepth(nextDepthTime);
+        nextDepthTime = (sendingTime / depthInterval + 1) * depthInterval;
+    }
+
+    if (!packet.marketDataHeader.incremental())
+    {
+        // Reference data comes from the instrument channel
+        packet.messages.forEach([this](const auto& message)
+        {
+            using Message = std::remove_cvref_t<decltype(message)>;
+            if constexpr (std::is_same_v<Message, SecurityDefinition>)
+                instruments.onDefinition(message);
+            else if constexpr (std::is_same_v<Message, SecurityDefinitionUpdateReport>)
+                instruments.onUpdate(message);
+        });
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    recovery.onPacket(packet);
+    bookTime += std::chrono::steady_clock::now() - begin;
+
+    if (mode == OutputMode::L2Depth && depthInterval == 0)
+        writeDepth(sendingTime);
+    else if (mode == OutputMode::BBO)
+        writeQuotes(packet);
+}
+
+void BookBuilder::writeQuotes(const SIMBAPacket& packet)
+{
+    const uint64_t sendingTime = packet.marketDataHeader.SendingTime;
+
+    topOfBook.takeTouched([this, sendingTime](uint32_t index)
+    {
+        if (recovery.state(index) != BookRecovery::State::Live)
+            return; // Touched again by the replay once it recovers
+
+        const TopOfBook::Quote quote = TopOfBook::quoteOf(book, index);
+        if (topOfBook.report(index, quote))
+            writeQuote(sendingTime, book.books()[index].securityId, quote);
+    });
+
+    // The exchange's own best prices, only for instruments the order feed does not give a live book for
+    packet.messages.forEach([this, sendingTime](const auto& message)
+    {
+        if constexpr (std::is_same_v<std::remove_cvref_t<decltype(message)>, BestPrices>)
+        {
+            for (const BestPricesEntry& entry : message.MDEntries)
+            {
+                const uint32_t index = book.bookFor(entry.SecurityID);
+                if (recovery.state(index) == BookRecovery::State::Live)
+                    continue;
+
+                TopOfBook::Quote quote;
+                if (entry.MktBidPx.mantissa != Decimal5NULL::NULL_VALUE)
+                {
+                    quote.bidPrice = entry.MktBidPx.mantissa;
+                    quote.bidSize = entry.MktBidSize;
+                }
+                if (entry.MktOfferPx.mantissa != Decimal5NULL::NULL_VALUE)
+                {
+                    quote.offerPrice = entry.MktOfferPx.mantissa;
+                    quote.offerSize = entry.MktOfferSize;
+                }
+                if (topOfBook.report(index, quote))
+                    writeQuote(sendingTime, entry.SecurityID, quote);
+            }
+        }
+    });
+}
+
+void BookBuilder::writeQuote(uint64_t time, int32_t securityId, const TopOfBook::Quote& quote)
+{
+    output << "{\"SendingTime\":" << time << ",\"SecurityID\":" << securityId << ",\"BidPx\":";
+    if (quote.bidPrice == Decimal5NULL::NULL_VALUE)
+        output << "null";
+    else
+        output << quote.bidPrice;
+    output << ",\"BidSize\":" << quote.bidSize << ",\"OfferPx\":";
+    if (quote.offerPrice == Decimal5NULL::NULL_VALUE)
+        output << "null";
+    else
+        output << quote.offerPrice;
+    output << ",\"OfferSize\":" << quote.offerSize << "}\n";
+}
+
+void BookBuilder::writeDepth(uint64_t time)
+{
+    depth.takeChanged([this, time](uint32_t index)
+    {
+        if (recovery.state(index) != BookRecovery::State::Live)
+            return false; // Written once it has recovered
+
+        const OrderBook::Book& state = book.books()[index];
+        output << "{\"SendingTime\":" << time << ",\"SecurityID\":" << state.securityId << ",\"RptSeq\":" << state.rptSeq;
+        for (OrderBook::Side side : { OrderBook::Bid, OrderBook::Offer })
+        {
+            output << (side == OrderBook::Bid ? ",\"Bids\":[" : ",\"Offers\":[");
+            const size_t count = depth.top(index, side, depthLevels);
+            for (size_t level = 0; level < count; ++level)
+            {
+                output << (level == 0 ? "[" : ",[") << depthLevels[level].price << "," << depthLevels[level].size << ","
+                    << depthLevels[level].orderCount << "]";
+            }
+            output << "]";
+        }
+        output << "}\n";
+        return true;
+    });
+}
+
+void BookBuilder::writeBooks()
+{
+    const auto& books = book.books();
+    for (uint32_t index = 0; index < books.size(); ++index)
+    {
+        const OrderBook::Book& state = books[index];
+        const BookRecovery::State bookState = recovery.state(index);
+        output << "{\"SecurityID\":" << state.securityId;
+        if (instruments.defined(index))
+            output << ",\"Symbol\":\"" << instruments.symbol(index) << "\"";
+        output << ",\"State\":\""
+            << (bookState == BookRecovery::State::Live ? "Live" : bookState == BookRecovery::State::Snapshot ? "Snapshot" : "Stale")
+            << "\",\"RptSeq\":" << state.rptSeq << ",\"Orders\":" << state.orderCount;
+
+        for (OrderBook::Side side : { OrderBook::Bid, OrderBook::Offer })
+        {
+            output << (side == OrderBook::Bid ? ",\"Bids\":[" : ",\"Offers\":[");
+            bool firstLevel = true;
+            book.forEachLevel(index, side, [&](const OrderBook::PriceLevel& level)
+            {
+                output << (firstLevel ? "" : ",") << "{\"Price\":" << Decimal5(level.price) << ",\"Size\":" << level.size << ",\"Orders\":[";
+                firstLevel = false;
+
+                bool firstOrder = true;
+                book.forEachOrder(level, [&](const OrderBook::Order& order)
+                {
+                    output << (firstOrder ? "" : ",") << "{\"MDEntryID\":" << order.id << ",\"MDEntrySize\":" << order.size << "}";
+                    firstOrder = false;
+                });
+                output << "]}";
+            });
+            output << "]";
+        }
+        output << "}\n";
+    }
+}
+
+void BookBuilder::finish()
+{
+    if (mode == OutputMode::L3Book)
+        writeBooks();
+    else if (mode == OutputMode::L2Depth && depthInterval != 0 && nextDepthTime != 0)
+        writeDepth(nextDepthTime); // Close the last interval
+}
+
+void BookBuilder::save(CheckpointWriter& writer) const
+{
+    instruments.save(writer);
+    book.save(writer);
+    recovery.save(writer);
+    topOfBook.save(writer);
+    writer.write(nextDepthTime);
+}
+
+void BookBuilder::restore(CheckpointReader& reader)
+{
+    instruments.restore(reader);
+    book.restore(reader);
+    recovery.restore(reader);
+    topOfBook.restore(reader);
+    nextDepthTime = reader.read<uint64_t>();
+
+    // Every level came back through the listener, but none of them changed since the checkpoint
+    depth.takeChanged([](uint32_t) { return true; });
+}
+
+BookBuilder::Statistics BookBuilder::statistics() const
+{
+    return Statistics{ book.statistics(), recovery.statistics(), verifier.statistics(), bookTime };
+}
+
+void BookBuilder::Statistics::add(const Statistics& other)
+{
+    book.updates += other.book.updates;
+    book.duplicates += other.book.duplicates;
+    book.gaps += other.book.gaps;
+    book.unknownOrders += other.book.unknownOrders;
+
+    recovery.snapshots += other.recovery.snapshots;
+    recovery.recoveries += other.recovery.recoveries;
+    recovery.failedRecoveries += other.recovery.failedRecoveries;
+    recovery.replayed += other.recovery.replayed;
+    recovery.overflows += other.recovery.overflows;
+    recovery.rptSeqGaps += other.recovery.rptSeqGaps;
+    recovery.packetGaps = std::max(recovery.packetGaps, other.recovery.packetGaps); // Every shard sees every packet header
+
+    verification.verified += other.verification.verified;
+    verification.mismatches += other.verification.mismatches;
+    verification.skipped += other.verification.skipped;
+
+    bookTime += other.bookTime;
+}
+
+void BookBuilder::Statistics::print(std::ostream& os) const
+{
+    const double seconds = std::chrono::duration<double>(bookTime).count();
+    os << book.updates << " book updates applied in " << std::chrono::duration_cast<std::chrono::milliseconds>(bookTime)
+        << " (" << static_cast<uint64_t>(seconds > 0 ? book.updates / seconds : 0) << " updates/s) | "
+        << book.duplicates << " duplicates | " << book.unknownOrders << " unknown orders" << "\n";
+
+    os << recovery.snapshots << " snapshots loaded | " << recovery.recoveries << " books recovered | "
+        << recovery.failedRecoveries << " failed recoveries | " << recovery.replayed << " updates replayed | "
+        << recovery.overflows << " buffer overflows | " << recovery.rptSeqGaps << " RptSeq gaps | "
+        << recovery.packetGaps << " packet gaps" << "\n";
+
+    if (verification.verified + verification.mismatches + verification.skipped != 0)
+    {
+        os << verification.verified << " snapshots verified | " << verification.mismatches << " mismatches | "
+            << verification.skipped << " skipped, book at another RptSeq" << "\n";
+    }
+}
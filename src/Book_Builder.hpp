@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+#include "Book_Recovery.hpp"
+#include "Book_Verifier.hpp"
+#include "Depth_Book.hpp"
+#include "Instrument_Directory.hpp"
+#include "Order_Book.hpp"
+#include "Parser_Options.hpp"
+#include "SIMBA_Decoder.hpp"
+#include "Top_Of_Book.hpp"
+
+// Feeds OrderUpdate, OrderExecution and OrderBookSnapshot through snapshot recovery into the L3 book and
+// writes what the output mode asks for. L3Book writes the final state of every book, one JSON object per
+// instrument and line, from finish(). L2Depth writes the top levels of every live book as a line whenever
+// they change, or conflated to the end of each interval of SendingTime. BBO writes a line whenever the
+// best bid or offer of an instrument changes, from the live book or, while there is none, from BestPrices
+class BookBuilder
+{
+public:
+	struct Statistics
+	{
+		OrderBook::Statistics book;
+		BookRecovery::Statistics recovery;
+		BookVerifier::Statistics verification;
+		std::chrono::nanoseconds bookTime{ 0 }; // Time spent applying updates, for the throughput report
+
+		void add(const Statistics& other);
+		void print(std::ostream& os) const;
+	};
+
+	BookBuilder(std::ostream& output, const ParserOptions& options);
+
+	// Templates the mode is built from, decoding anything else would be wasted work
+	static TemplateFilter requiredTemplates(OutputMode mode);
+
+	void onPacket(const SIMBAPacket& packet);
+	void finish(); // Output that is only written once the capture is done
+
+	// Directory, books, recovery and reported quotes. The L2 levels are rebuilt from the restored L3 book
+	void save(CheckpointWriter& writer) const;
+	void restore(CheckpointReader& reader);
+
+	Statistics statistics() const;
+
+private:
+	void writeBooks();
+	void writeDepth(uint64_t time);
+	void writeQuotes(const SIMBAPacket& packet);
+	void writeQuote(uint64_t time, int32_t securityId, const TopOfBook::Quote& quote);
+
+	std::ostream& output;
+	OutputMode mode;
+	InstrumentDirectory instruments;
+	OrderBook book{ instruments };
+	BookRecovery recovery{ book };
+	BookVerifier verifier;
+
+	DepthBook depth;
+	std::vector<DepthBook::Level> depthLevels; // Scratch space for one side's top levels
+	uint64_t depthInterval;
+	uint64_t nextDepthTime = 0; // End of the current interval
+
+	TopOfBook topOfBook;
+	std::chrono::nanoseconds bookTime{ 0 };
+};
@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Book_Recovery.hpp"
+
+BookRecovery::BookRecovery(OrderBook& books, size_t bufferCapacity)
+    : books(books), bufferCapacity(bufferCapacity)
+{
+}
+
+bool BookRecovery::UpdateRing::push(const BufferedUpdate& update, size_t capacity)
+{
+    size_t limit = 1;
+    while (limit < capacity)
+        limit <<= 1;
+
+    bool dropped = false;
+    if (count == slots.size())
+    {
+        if (slots.size() < limit)
+        {
+            grow(limit);
+        }
+        else
+        {
+            pop();
+            dropped = true;
+        }
+    }
+
+    slots[(head + count) & (slots.size() - 1)] = update;
+    ++count;
+    return !dropped;
+}
+
+void BookRecovery::UpdateRing::grow(size_t limit)
+{
+    // Doubles from a few slots, re-packed from head so the oldest update is at 0 again
+    std::vector<BufferedUpdate> grown(std::min(std::max<size_t>(slots.size() * 2, INITIAL_SLOTS), limit));
+    for (size_t i = 0; i < count; ++i)
+        grown[i] = (*this)[i];
+    slots = std::move(grown);
+    head = 0;
+}
+
+void BookRecovery::onPacket(const SIMBAPacket& packet)
+{
+    const MarketDataPacketHeader& header = packet.marketDataHeader;
+    if (header.incremental())
+    {
+        // Both feeds carry the same packets, only a jump forward is a loss
+        if (lastIncrementalSeq != 0 && header.MsgSeqNum > lastIncrementalSeq + 1)
+            ++stats.packetGaps;
+        if (header.MsgSeqNum > lastIncrementalSeq)
+            lastIncrementalSeq = header.MsgSeqNum;
+    }
+
+    packet.messages.forEach([this, &header](const auto& message)
+    {
+        using Message = std::remove_cvref_t<decltype(message)>;
+        if constexpr (std::is_same_v<Message, OrderUpdate> || std::is_same_v<Message, OrderExecution>)
+            onIncremental(message, header.MsgSeqNum);
+        else if constexpr (std::is_same_v<Message, OrderBookSnapshot>)
+            onSnapshot(message, header);
+    });
+}
+
+template<typename Message>
+void BookRecovery::onIncremental(const Message& message, uint32_t msgSeqNum)
+{
+    const uint32_t book = books.bookFor(message.SecurityID);
+    Instrument& instrument = instrumentFor(book);
+    const uint32_t lastRptSeq = books.books()[book].rptSeq;
+
+    if (instrument.state == State::Live) [[likely]]
+    {
+        if (message.RptSeq <= lastRptSeq + 1)
+        {
+            books.apply(book, message); // Copies from the other feed are dropped by the book
+            return;
+        }
+
+        // Lost updates, the book is wrong until the next snapshot
+        instrument.state = State::Stale;
+        ++stats.rptSeqGaps;
+    }
+    else if (instrument.state == State::Stale && lastRptSeq == 0 && message.RptSeq == 1 && instrument.pending.empty())
+    {
+        instrument.state = State::Live;
+        books.apply(book, message);
+        return;
+    }
+
+    if (!instrument.pending.push(BufferedUpdate{ msgSeqNum, message }, bufferCapacity))
+        ++stats.overflows;
+}
+
+void BookRecovery::onSnapshot(const OrderBookSnapshot& snapshot, const MarketDataPacketHeader& header)
+{
+    const uint32_t book = books.bookFor(snapshot.SecurityID);
+    Instrument& instrument = instrumentFor(book);
+    const SnapshotFragments::Fragment fragment = instrument.fragments.next(snapshot, header);
+    if (fragment == SnapshotFragments::Fragment::Duplicate)
+        return;
+
+    if (instrument.state == State::Live)
+    {
+        // Already in sync
+        if (verifier)
+            verifier->onSnapshot(book, snapshot, header, fragment);
+        return;
+    }
+
+    if (fragment == SnapshotFragments::Fragment::First)
+    {
+        books.reset(book, snapshot.RptSeq);
+        instrument.state = State::Snapshot;
+        instrument.snapshotLastMsgSeqNum = snapshot.LastMsgSeqNumProcessed;
+    }
+    else if (fragment == SnapshotFragments::Fragment::Lost || instrument.state != State::Snapshot)
+    {
+        instrument.state = State::Stale;
+        return;
+    }
+
+    if (snapshot.MDEntries)
+    {
+        for (const OrderBookSnapshotEntry& entry : *snapshot.MDEntries)
+            books.addSnapshotOrder(book, entry);
+    }
+
+    if (header.MsgFlags & static_cast<uint16_t>(MsgFlagsSet::EndOfSnapshot))
+    {
+        ++stats.snapshots;
+        replay(book, instrument);
+    }
+}
+
+void BookRecovery::replay(uint32_t book, Instrument& instrument)
+{
+    while (!instrument.pending.empty())
+    {
+        const BufferedUpdate& buffered = instrument.pending.front();
+        const uint32_t rptSeq = std::visit([](const auto& message) { return message.RptSeq; }, buffered.message);
+        const uint32_t lastRptSeq = books.books()[book].rptSeq;
+
+        if (buffered.msgSeqNum > instrument.snapshotLastMsgSeqNum && rptSeq > lastRptSeq)
+        {
+            if (rptSeq != lastRptSeq + 1)
+            {
+                // The ring lost updates the snapshot does not cover, keep the rest for the next snapshot
+                instrument.state = State::Stale;
+                ++stats.failedRecoveries;
+                return;
+            }
+
+            std::visit([this, book](const auto& message) { books.apply(book, message); }, buffered.message);
+            ++stats.replayed;
+        }
+        instrument.pending.pop(); // Applied, or already contained in the snapshot
+    }
+
+    instrument.state = State::Live;
+    instrument.pending.release(); // Buffering again only after the next gap
+    ++stats.recoveries;
+}
+
+void BookRecovery::save(CheckpointWriter& writer) const
+{
+    writer.write(lastIncrementalSeq);
+    writer.write(stats);
+    writer.write<uint64_t>(instruments.size());
+    for (const Instrument& instrument : instruments)
+    {
+        writer.write(instrument.state);
+        writer.write(instrument.fragments.lastSeq);
+        writer.write(instrument.fragments.rptSeq);
+        writer.write(instrument.snapshotLastMsgSeqNum);
+
+        writer.write<uint64_t>(instrument.pending.size());
+        for (size_t i = 0; i < instrument.pending.size(); ++i)
+        {
+            const BufferedUpdate& buffered = instrument.pending[i];
+            writer.write(buffered.msgSeqNum);
+            writer.write<uint8_t>(static_cast<uint8_t>(buffered.message.index()));
+            std::visit([&writer](const auto& message) { writer.write(message); }, buffered.message);
+        }
+    }
+}
+
+void BookRecovery::restore(CheckpointReader& reader)
+{
+    lastIncrementalSeq = reader.read<uint32_t>();
+    stats = reader.read<Statistics>();
+
+    const uint64_t count = reader.read<uint64_t>();
+    if (count > books.books().size())
+        throw std::runtime_error("Checkpoint file has recovery state of an unknown book.");
+
+    instruments.resize(count);
+    for (Instrument& instrument : instruments)
+    {
+        instrument.state = reader.read<State>();
+        instrument.fragments.lastSeq = reader.read<uint32_t>();
+        instrument.fragments.rptSeq = reader.read<uint32_t>();
+        instrument.fragments.loading = instrument.state == State::Snapshot; // A live book's snapshot is verified from the next one
+        instrument.snapshotLastMsgSeqNum = reader.read<uint32_t>();
+
+        const uint64_t pending = reader.read<uint64_t>();
+        for (uint64_t i = 0; i < pending; ++i)
+        {
+            const uint32_t msgSeqNum = reader.read<uint32_t>();
+            if (reader.read<uint8_t>() == 0)
+                instrument.pending.push(BufferedUpdate{ msgSeqNum, reader.read<OrderUpdate>() }, bufferCapacity);
+            else
+                instrument.pending.push(BufferedUpdate{ msgSeqNum, reader.read<OrderExecution>() }, bufferCapacity);
+        }
+    }
+}
+
+BookRecovery::Instrument& BookRecovery::instrumentFor(uint32_t book)
+{
+    if (book >= instruments.size())
+        instruments.resize(book + 1);
+    return instruments[book];
+}
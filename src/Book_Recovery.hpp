@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+#include "Book_Verifier.hpp"
+#include "Order_Book.hpp"
+#include "SIMBA_Messages.hpp"
+#include "Snapshot_Fragments.hpp"
+
+// MOEX snapshot recovery for the L3 book, per instrument. A book that has not been synchronized yet, or
+// that saw an RptSeq jump, is stale: its incremental updates are buffered in a bounded ring until a full
+// OrderBookSnapshot (StartOfSnapshot to EndOfSnapshot) has been loaded, then the buffered updates past the
+// snapshot's LastMsgSeqNumProcessed and RptSeq are replayed and the book goes live. Books whose first
+// update is RptSeq 1 start live, the capture began with the session and nothing was missed
+class BookRecovery
+{
+public:
+	enum class State : uint8_t
+	{
+		Stale,    // Out of sync, waiting for the next snapshot
+		Snapshot, // Loading snapshot fragments
+		Live      // Applying incremental updates as they arrive
+	};
+
+	struct Statistics
+	{
+		uint64_t snapshots = 0;         // Complete snapshots loaded into a stale book
+		uint64_t recoveries = 0;        // Books that went live from a snapshot
+		uint64_t failedRecoveries = 0;  // Snapshots the buffered updates did not connect to
+		uint64_t replayed = 0;          // Buffered updates applied after a snapshot
+		uint64_t overflows = 0;         // Buffered updates dropped because a ring was full
+		uint64_t rptSeqGaps = 0;        // Live books that lost updates and went stale
+		uint64_t packetGaps = 0;        // Jumps in the incremental feed's MsgSeqNum
+	};
+
+	explicit BookRecovery(OrderBook& books, size_t bufferCapacity = 8192);
+
+	// Snapshots of live books go to verifier, if there is one
+	void setVerifier(BookVerifier* snapshotVerifier) noexcept { verifier = snapshotVerifier; }
+
+	void onPacket(const SIMBAPacket& packet);
+
+	// Per book state with the updates still buffered, and where the incremental feed is. restore is for
+	// a fresh object, after the books were restored
+	void save(CheckpointWriter& writer) const;
+	void restore(CheckpointReader& reader);
+
+	State state(uint32_t book) const noexcept
+	{
+		return book < instruments.size() ? instruments[book].state : State::Stale;
+	}
+	const Statistics& statistics() const noexcept { return stats; }
+
+private:
+	struct BufferedUpdate
+	{
+		uint32_t msgSeqNum; // Incremental packet the update arrived in
+		std::variant<OrderUpdate, OrderExecution> message;
+	};
+
+	// Bounded FIFO, the oldest update is overwritten when full. Storage starts small once the instrument
+	// actually has to buffer and doubles up to the capacity
+	class UpdateRing
+	{
+	public:
+		bool empty() const noexcept { return count == 0; }
+		size_t size() const noexcept { return count; }
+		const BufferedUpdate& front() const noexcept { return slots[head]; }
+		const BufferedUpdate& operator[](size_t index) const noexcept { return slots[(head + index) & (slots.size() - 1)]; } // 0 is the oldest
+		void pop() noexcept
+		{
+			head = (head + 1) & (slots.size() - 1);
+			--count;
+		}
+
+		// Returns false when the oldest update had to be dropped to make room
+		bool push(const BufferedUpdate& update, size_t capacity);
+
+		// Gives the storage back once empty, a live instrument does not keep it
+		void release() noexcept
+		{
+			slots = {};
+			head = 0;
+		}
+
+	private:
+		static constexpr size_t INITIAL_SLOTS = 16;
+
+		void grow(size_t limit);
+
+		std::vector<BufferedUpdate> slots; // Power of two size, doubled as needed up to the capacity
+		size_t head = 0;
+		size_t count = 0;
+	};
+
+	struct Instrument
+	{
+		State state = State::Stale;
+		SnapshotFragments fragments; // Of the snapshot being loaded, or verified once live
+		uint32_t snapshotLastMsgSeqNum = 0; // LastMsgSeqNumProcessed of the snapshot being loaded
+		UpdateRing pending;
+	};
+
+	template<typename Message>
+	void onIncremental(const Message& message, uint32_t msgSeqNum);
+	void onSnapshot(const OrderBookSnapshot& snapshot, const MarketDataPacketHeader& header);
+	void replay(uint32_t book, Instrument& instrument);
+
+	Instrument& instrumentFor(uint32_t book);
+
+	OrderBook& books;
+	BookVerifier* verifier = nullptr;
+	std::vector<Instrument> instruments; // Same positions as OrderBook::books()
+	size_t bufferCapacity;
+	uint32_t lastIncrementalSeq = 0;
+	Statistics stats;
+};
@@ -0,0 +1,42 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "Book_Sink.hpp"
+
+BookSink::BookSink(const std::string& outputFilePath, const ParserOptions& options)
+    : outputFile(outputFilePath, options.compression), builder(outputFile, options)
+{
+}
+
+void BookSink::onPacket(const SIMBAPacket& packet)
+{
+    builder.onPacket(packet);
+}
+
+void BookSink::save(CheckpointWriter& writer)
+{
+    writer.write<uint32_t>(1); // Shards
+    builder.save(writer);
+}
+
+void BookSink::restore(CheckpointReader& reader)
+{
+    if (reader.read<uint32_t>() != 1)
+        throw std::runtime_error("Checkpoint was written with a different number of book threads.");
+    builder.restore(reader);
+}
+
+BookSink::~BookSink()
+{
+    try
+    {
+        builder.finish();
+        outputFile.close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+
+    builder.statistics().print(std::cout);
+}
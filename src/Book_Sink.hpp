@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+#include "Async_Writer.hpp"
+#include "Book_Builder.hpp"
+#include "Packet_Sink.hpp"
+#include "Parser_Options.hpp"
+
+// Builds the books on the parsing thread and writes the mode's output straight to the output file
+class BookSink : public PacketSink
+{
+public:
+	BookSink(const std::string& outputFilePath, const ParserOptions& options);
+	~BookSink() override;
+
+	void onPacket(const SIMBAPacket& packet) override;
+	void save(CheckpointWriter& writer) override;
+	void restore(CheckpointReader& reader) override;
+
+private:
+	AsyncFileStream outputFile;
+	BookBuilder builder;
+};
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+#include "Book_Verifier.hpp"
+
+void BookVerifier::onSnapshot(uint32_t book, const OrderBookSnapshot& snapshot, const MarketDataPacketHeader& header,
+    SnapshotFragments::Fragment fragment)
+{
+    if (fragment == SnapshotFragments::Fragment::First)
+    {
+        snapshotBook = book;
+        snapshotRptSeq = snapshot.RptSeq;
+        snapshotHash = 0;
+        snapshotEntries.clear();
+    }
+    else if (fragment != SnapshotFragments::Fragment::Next || book != snapshotBook)
+    {
+        snapshotBook = OrderBook::NIL; // Joined in the middle or lost a fragment
+        return;
+    }
+
+    if (snapshot.MDEntries)
+    {
+        for (const OrderBookSnapshotEntry& entry : *snapshot.MDEntries)
+        {
+            if (entry.mdEntryType != MDEntryType::Bid && entry.mdEntryType != MDEntryType::Offer)
+                continue;
+
+            const OrderBook::Side side = entry.mdEntryType == MDEntryType::Offer ? OrderBook::Offer : OrderBook::Bid;
+            snapshotHash += OrderBook::orderHash(entry.MDEntryID, entry.MDEntryPx.mantissa, entry.MDEntrySize, side);
+            snapshotEntries.push_back(Entry{ entry.MDEntryID, entry.MDEntryPx.mantissa, entry.MDEntrySize, side });
+        }
+    }
+
+    if (header.MsgFlags & static_cast<uint16_t>(MsgFlagsSet::EndOfSnapshot))
+    {
+        compare(book);
+        snapshotBook = OrderBook::NIL;
+    }
+}
+
+void BookVerifier::compare(uint32_t book)
+{
+    const OrderBook::Book& state = books.books()[book];
+    if (state.rptSeq != snapshotRptSeq)
+    {
+        ++stats.skipped;
+        return;
+    }
+
+    if (state.hash == snapshotHash && state.orderCount == snapshotEntries.size()) [[likely]]
+    {
+        ++stats.verified;
+        return;
+    }
+
+    ++stats.mismatches;
+    writeDifferences(book);
+
+    books.reset(book, snapshotRptSeq);
+    for (const Entry& entry : snapshotEntries)
+    {
+        OrderBookSnapshotEntry order{};
+        order.MDEntryID = entry.id;
+        order.MDEntryPx.mantissa = entry.price;
+        order.MDEntrySize = entry.size;
+        order.mdEntryType = entry.side == OrderBook::Offer ? MDEntryType::Offer : MDEntryType::Bid;
+        books.addSnapshotOrder(book, order);
+    }
+}
+
+void BookVerifier::writeDifferences(uint32_t book)
+{
+    bookEntries.clear();
+    for (OrderBook::Side side : { OrderBook::Bid, OrderBook::Offer })
+    {
+        books.forEachLevel(book, side, [this](const OrderBook::PriceLevel& level)
+        {
+            books.forEachOrder(level, [this](const OrderBook::Order& order)
+            {
+                bookEntries.push_back(Entry{ order.id, order.price, order.size, order.side });
+            });
+        });
+    }
+
+    const auto byId = [](const Entry& left, const Entry& right) { return left.id < right.id; };
+    std::sort(bookEntries.begin(), bookEntries.end(), byId);
+    std::vector<Entry> snapshotById = snapshotEntries; // Snapshot order is time priority, needed for the reload
+    std::sort(snapshotById.begin(), snapshotById.end(), byId);
+
+    const OrderBook::Book& state = books.books()[book];
+    std::ostringstream text; // One write, shards may be logging at the same time
+    text << "Book of SecurityID " << state.securityId << " differs from its snapshot at RptSeq " << snapshotRptSeq
+        << " (" << state.orderCount << " orders, snapshot " << snapshotEntries.size() << "):";
+
+    const auto describe = [](const Entry& entry)
+    {
+        std::ostringstream order;
+        order << (entry.side == OrderBook::Bid ? "bid " : "offer ") << entry.size << " @ " << entry.price;
+        return order.str();
+    };
+
+    size_t differences = 0;
+    const auto report = [&](int64_t id, const std::string& inBookAs, const std::string& inSnapshotAs)
+    {
+        if (differences++ < MAX_REPORTED_DIFFERENCES)
+            text << "\n  MDEntryID " << id << ": book " << inBookAs << ", snapshot " << inSnapshotAs;
+    };
+
+    auto inBook = bookEntries.begin();
+    auto inSnapshot = snapshotById.begin();
+    while (inBook != bookEntries.end() || inSnapshot != snapshotById.end())
+    {
+        if (inSnapshot == snapshotById.end() || (inBook != bookEntries.end() && inBook->id < inSnapshot->id))
+        {
+            report(inBook->id, describe(*inBook), "none");
+            ++inBook;
+        }
+        else if (inBook == bookEntries.end() || inSnapshot->id < inBook->id)
+        {
+            report(inSnapshot->id, "none", describe(*inSnapshot));
+            ++inSnapshot;
+        }
+        else
+        {
+            if (inBook->price != inSnapshot->price || inBook->size != inSnapshot->size || inBook->side != inSnapshot->side)
+                report(inBook->id, describe(*inBook), describe(*inSnapshot));
+            ++inBook;
+            ++inSnapshot;
+        }
+    }
+
+    if (differences > MAX_REPORTED_DIFFERENCES)
+        text << "\n  ... " << differences - MAX_REPORTED_DIFFERENCES << " more";
+    text << "\n";
+    log << text.str();
+}
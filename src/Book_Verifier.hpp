@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "Order_Book.hpp"
+#include "SIMBA_Messages.hpp"
+#include "Snapshot_Fragments.hpp"
+
+// Checks live books against the snapshot feed. The snapshot of an instrument is hashed as its fragments
+// arrive, and if the book is at the snapshot's RptSeq when the last fragment is in, its running
+// Book::hash and order count are compared with the snapshot's, an O(1) check whatever the book's size.
+// Only a mismatch walks both to write the differing orders, after which the book is reloaded from the
+// snapshot. A book that has already moved past the snapshot cannot be compared and is skipped
+class BookVerifier
+{
+public:
+	struct Statistics
+	{
+		uint64_t verified = 0;   // Snapshots the book matched
+		uint64_t mismatches = 0; // Snapshots the book differed from, each reloaded the book
+		uint64_t skipped = 0;    // Snapshots of a book that was already at another RptSeq
+	};
+
+	BookVerifier(OrderBook& books, std::ostream& log) : books(books), log(log) {}
+
+	// A snapshot fragment of a live book, sequenced by the caller's SnapshotFragments of the instrument
+	void onSnapshot(uint32_t book, const OrderBookSnapshot& snapshot, const MarketDataPacketHeader& header,
+		SnapshotFragments::Fragment fragment);
+
+	const Statistics& statistics() const noexcept { return stats; }
+
+private:
+	static constexpr size_t MAX_REPORTED_DIFFERENCES = 10;
+
+	struct Entry
+	{
+		int64_t id;
+		int64_t price;
+		int64_t size;
+		OrderBook::Side side;
+	};
+
+	void compare(uint32_t book);
+	void writeDifferences(uint32_t book);
+
+	OrderBook& books;
+	std::ostream& log;
+
+	// Snapshot being collected, fragments of one instrument follow each other on the snapshot feed
+	uint32_t snapshotBook = OrderBook::NIL;
+	uint32_t snapshotRptSeq = 0;
+	uint64_t snapshotHash = 0;
+	std::vector<Entry> snapshotEntries; // In snapshot order, kept for the diff and the reload on a mismatch
+	std::vector<Entry> bookEntries;     // Scratch space for the diff
+
+	Statistics stats;
+};
@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+#include "Checkpoint.hpp"
+#include "Flat_Index.hpp"
+
+uint64_t captureFingerprint(std::span<const char> start) noexcept
+{
+    constexpr size_t FINGERPRINT_BYTES = 4096;
+
+    uint64_t hash = start.size();
+    const size_t length = std::min(start.size(), FINGERPRINT_BYTES);
+    for (size_t offset = 0; offset < length; offset += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, start.data() + offset, std::min(sizeof(uint64_t), length - offset));
+        hash = mixHash(hash ^ word);
+    }
+    return hash;
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& filePath)
+    : filePath(filePath), temporaryPath(filePath + ".tmp"), file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc)
+{
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open checkpoint file.");
+    }
+}
+
+void CheckpointWriter::commit()
+{
+    file.close();
+    if (file.fail()) {
+        throw std::runtime_error("Unable to write checkpoint file.");
+    }
+
+    std::remove(filePath.c_str()); // rename does not replace an existing file on Windows
+    if (std::rename(temporaryPath.c_str(), filePath.c_str()) != 0) {
+        throw std::runtime_error("Unable to rename checkpoint file.");
+    }
+}
+
+CheckpointReader::CheckpointReader(const std::string& filePath)
+    : mapper(filePath, std::numeric_limits<size_t>::max())
+{
+    // One mapping of the whole file, the chunk size is not limiting it
+    if (!mapper.fetchNextChunk(data, size)) {
+        throw std::runtime_error("Checkpoint file is empty.");
+    }
+    mapping = std::make_unique<MemoryMappedChunk>(const_cast<char*>(data), size);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "IO_Mapper.hpp"
+
+// Where in the capture a checkpoint was taken, followed in the file by the state of the sink
+struct CheckpointHeader
+{
+	static constexpr char MAGIC[8] = { 'S', 'I', 'M', 'B', 'A', 'C', 'K', 'P' };
+	static constexpr uint32_t VERSION = 1;
+
+	char magic[8];
+	uint32_t version;
+	uint32_t lastMsgSeqNum;      // Last MsgSeqNum of the incremental feed processed
+	uint64_t captureOffset;      // Byte offset in the capture of the first pcap record not yet processed
+	uint64_t captureFingerprint; // Of the start of the capture, to tell whether a restore can seek into it
+	uint64_t packets;            // pcap records processed
+	uint64_t sendingTime;        // Of the last packet processed
+};
+
+// Identifies a capture file by its first bytes, which include the first packets' timestamps
+uint64_t captureFingerprint(std::span<const char> start) noexcept;
+
+// Writes a checkpoint as a flat run of trivially copyable values and length prefixed arrays in host
+// byte order. The file only replaces an existing one of the same name once it is complete
+class CheckpointWriter
+{
+public:
+	explicit CheckpointWriter(const std::string& filePath);
+
+	template<typename T>
+	void write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Checkpoints hold trivially copyable values only");
+		file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<typename T>
+	void writeVector(const std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Checkpoints hold trivially copyable values only");
+		write<uint64_t>(values.size());
+		file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+	}
+
+	void commit();
+
+private:
+	std::string filePath;
+	std::string temporaryPath;
+	std::ofstream file;
+};
+
+// Maps a whole checkpoint file at once and reads it back in the order it was written
+class CheckpointReader
+{
+public:
+	explicit CheckpointReader(const std::string& filePath);
+
+	template<typename T>
+	T read()
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Checkpoints hold trivially copyable values only");
+		T value;
+		std::memcpy(&value, take(sizeof(T)), sizeof(T));
+		return value;
+	}
+
+	template<typename T>
+	void readVector(std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Checkpoints hold trivially copyable values only");
+		const uint64_t count = read<uint64_t>();
+		if (count > (size - position) / sizeof(T))
+			throw std::runtime_error("Checkpoint file is truncated.");
+		values.resize(count);
+		if (count != 0) // An empty vector's data() may be null
+			std::memcpy(values.data(), take(count * sizeof(T)), count * sizeof(T));
+	}
+
+	bool atEnd() const noexcept { return position == size; }
+
+private:
+	const char* take(size_t bytes)
+	{
+		if (bytes > size - position)
+			throw std::runtime_error("Checkpoint file is truncated.");
+		const char* at = data + position;
+		position += bytes;
+		return at;
+	}
+
+	IOMapper mapper;
+	std::unique_ptr<MemoryMappedChunk> mapping;
+	const char* data = nullptr;
+	size_t size = 0;
+	size_t position = 0;
+};
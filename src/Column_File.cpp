@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <charconv>
+
+#include "Column_File.hpp"
+
+namespace
+{
+    size_t columnWidth(ColumnType type)
+    {
+        switch (type)
+        {
+        case ColumnType::UInt8: return 1;
+        case ColumnType::Int32:
+        case ColumnType::UInt32: return 4;
+        case ColumnType::Int64:
+        case ColumnType::UInt64: return 8;
+        }
+        throw std::runtime_error("Unknown column type.");
+    }
+
+    template<typename T>
+    T parseBound(const std::string& text, T open)
+    {
+        if (text.empty())
+            return open;
+
+        // Parsed as the column's own type, so a fraction, a sign on an unsigned column or a value that
+        // does not fit is an error instead of a wrong bound
+        T bound{};
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), bound);
+        if (error != std::errc() || end != text.data() + text.size())
+            throw std::runtime_error("Invalid bound for the column's type: " + text);
+        return bound;
+    }
+
+    template<typename T>
+    ColumnScan scan(const ColumnReader& column, const std::string& lowText, const std::string& highText)
+    {
+        const T low = parseBound<T>(lowText, std::numeric_limits<T>::min());
+        const T high = parseBound<T>(highText, std::numeric_limits<T>::max());
+
+        ColumnScan result;
+        result.rows = column.rows();
+        result.chunks = column.chunks().size();
+        for (const ColumnReader::Chunk& chunk : column.chunks())
+        {
+            if (!column.mayContain<T>(chunk, low, high))
+                continue;
+            ++result.chunksRead;
+            for (const T value : column.values<T>(chunk))
+                result.matches += value >= low && value <= high;
+        }
+        return result;
+    }
+}
+
+ColumnReader::ColumnReader(const std::string& filePath)
+    : mapper(filePath, std::numeric_limits<size_t>::max())
+{
+    // One mapping of the whole file, the chunk size is not limiting it
+    if (!mapper.fetchNextChunk(data, size) || size < sizeof(ColumnFileHeader)) {
+        throw std::runtime_error("Not a column file: " + filePath);
+    }
+    mapping = std::make_unique<MemoryMappedChunk>(const_cast<char*>(data), size);
+
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, ColumnFileHeader::MAGIC, sizeof(header.magic)) != 0 || header.version != ColumnFileHeader::VERSION
+        || header.width != columnWidth(header.type)) {
+        throw std::runtime_error("Not a column file: " + filePath);
+    }
+
+    // Footers from the last one back, each tells how far back its chunk starts
+    uint64_t end = size;
+    while (end != sizeof(ColumnFileHeader))
+    {
+        ColumnChunkFooter footer;
+        if (end - sizeof(ColumnFileHeader) < sizeof(footer)) {
+            throw std::runtime_error("Column file is truncated: " + filePath);
+        }
+        std::memcpy(&footer, data + end - sizeof(footer), sizeof(footer));
+
+        const uint64_t bytes = paddedColumnBytes(footer.rows * header.width);
+        if (footer.magic != ColumnChunkFooter::MAGIC || footer.rows > COLUMN_CHUNK_ROWS
+            || end - sizeof(ColumnFileHeader) - sizeof(footer) < bytes) {
+            throw std::runtime_error("Column file is truncated: " + filePath);
+        }
+        end -= sizeof(footer) + bytes;
+        chunkList.push_back(Chunk{ end, footer.rows, 0, footer.min, footer.max });
+    }
+
+    std::reverse(chunkList.begin(), chunkList.end());
+    for (Chunk& chunk : chunkList)
+    {
+        chunk.firstRow = rowCount;
+        rowCount += chunk.rows;
+    }
+}
+
+ColumnScan scanColumn(const ColumnReader& column, const std::string& low, const std::string& high)
+{
+    switch (column.type())
+    {
+    case ColumnType::UInt8: return scan<uint8_t>(column, low, high);
+    case ColumnType::Int32: return scan<int32_t>(column, low, high);
+    case ColumnType::UInt32: return scan<uint32_t>(column, low, high);
+    case ColumnType::Int64: return scan<int64_t>(column, low, high);
+    case ColumnType::UInt64: return scan<uint64_t>(column, low, high);
+    }
+    throw std::runtime_error("Unknown column type.");
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "IO_Mapper.hpp"
+
+// One column of a table as a file: a header, then chunks of at most CHUNK_ROWS fixed width values in
+// host byte order, each padded to 8 bytes and followed by a footer with its row count and the smallest
+// and largest value in it. Every column of a table is cut into chunks at the same rows, so a chunk
+// skipped by the statistics of one column is skipped in the others by its index
+enum class ColumnType : uint8_t
+{
+	UInt8 = 1,
+	Int32 = 2,
+	UInt32 = 3,
+	Int64 = 4,
+	UInt64 = 5
+};
+
+template<typename T> struct ColumnTypeOf;
+template<> struct ColumnTypeOf<uint8_t> { static constexpr ColumnType type = ColumnType::UInt8; };
+template<> struct ColumnTypeOf<int32_t> { static constexpr ColumnType type = ColumnType::Int32; };
+template<> struct ColumnTypeOf<uint32_t> { static constexpr ColumnType type = ColumnType::UInt32; };
+template<> struct ColumnTypeOf<int64_t> { static constexpr ColumnType type = ColumnType::Int64; };
+template<> struct ColumnTypeOf<uint64_t> { static constexpr ColumnType type = ColumnType::UInt64; };
+
+struct ColumnFileHeader
+{
+	static constexpr char MAGIC[8] = { 'S', 'I', 'M', 'B', 'A', 'C', 'O', 'L' };
+	static constexpr uint32_t VERSION = 1;
+
+	char magic[8];
+	uint32_t version;
+	ColumnType type;
+	uint8_t width;     // Bytes per value
+	uint16_t reserved;
+};
+static_assert(sizeof(ColumnFileHeader) == 16, "ColumnFileHeader size is incorrect");
+
+struct ColumnChunkFooter
+{
+	static constexpr uint32_t MAGIC = 0x4b4e4843; // "CHNK"
+
+	uint64_t rows;
+	uint64_t min; // Smallest value of the chunk in its first width bytes
+	uint64_t max; // Largest value
+	uint32_t magic;
+	uint32_t reserved;
+};
+static_assert(sizeof(ColumnChunkFooter) == 32, "ColumnChunkFooter size is incorrect");
+
+static constexpr size_t COLUMN_CHUNK_ROWS = 64 * 1024;
+
+constexpr uint64_t paddedColumnBytes(uint64_t bytes) noexcept { return (bytes + 7) & ~uint64_t(7); }
+
+// Appends the values of one column, writing a chunk whenever COLUMN_CHUNK_ROWS are buffered and the
+// last, shorter one when it is destroyed
+template<typename T>
+class ColumnWriter
+{
+public:
+	explicit ColumnWriter(const std::string& filePath)
+		: file(filePath, std::ios::out | std::ios::binary | std::ios::trunc)
+	{
+		if (!file.is_open()) {
+			throw std::runtime_error("Unable to open column file " + filePath);
+		}
+		values.reserve(COLUMN_CHUNK_ROWS);
+
+		ColumnFileHeader header{};
+		std::memcpy(header.magic, ColumnFileHeader::MAGIC, sizeof(header.magic));
+		header.version = ColumnFileHeader::VERSION;
+		header.type = ColumnTypeOf<T>::type;
+		header.width = sizeof(T);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+
+	~ColumnWriter()
+	{
+		if (!values.empty())
+			writeChunk();
+	}
+
+	ColumnWriter(const ColumnWriter&) = delete;
+	ColumnWriter& operator=(const ColumnWriter&) = delete;
+
+	void append(T value)
+	{
+		if (values.empty())
+		{
+			min = value;
+			max = value;
+		}
+		else
+		{
+			min = value < min ? value : min;
+			max = value > max ? value : max;
+		}
+		values.push_back(value);
+		if (values.size() == COLUMN_CHUNK_ROWS)
+			writeChunk();
+	}
+
+private:
+	void writeChunk()
+	{
+		static constexpr char PADDING[8] = {};
+		const uint64_t bytes = values.size() * sizeof(T);
+		file.write(reinterpret_cast<const char*>(values.data()), bytes);
+		file.write(PADDING, paddedColumnBytes(bytes) - bytes);
+
+		ColumnChunkFooter footer{};
+		footer.rows = values.size();
+		std::memcpy(&footer.min, &min, sizeof(T));
+		std::memcpy(&footer.max, &max, sizeof(T));
+		footer.magic = ColumnChunkFooter::MAGIC;
+		file.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+		values.clear();
+	}
+
+	std::ofstream file;
+	std::vector<T> values; // Of the chunk being filled
+	T min{};
+	T max{};
+};
+
+// Maps a column file in one go. The chunks are found from the end of the file by their footers, and
+// their values are read in place, aligned to 8 bytes by the padding
+class ColumnReader
+{
+public:
+	struct Chunk
+	{
+		uint64_t offset;   // Of the first value in the file
+		uint64_t rows;
+		uint64_t firstRow; // Of the column
+		uint64_t min;      // As in the footer
+		uint64_t max;
+	};
+
+	explicit ColumnReader(const std::string& filePath);
+
+	ColumnType type() const noexcept { return header.type; }
+	uint64_t rows() const noexcept { return rowCount; }
+	const std::vector<Chunk>& chunks() const noexcept { return chunkList; }
+
+	template<typename T>
+	std::span<const T> values(const Chunk& chunk) const
+	{
+		checkType<T>();
+		return std::span<const T>(reinterpret_cast<const T*>(data + chunk.offset), chunk.rows);
+	}
+
+	template<typename T>
+	T min(const Chunk& chunk) const
+	{
+		checkType<T>();
+		T value;
+		std::memcpy(&value, &chunk.min, sizeof(T));
+		return value;
+	}
+
+	template<typename T>
+	T max(const Chunk& chunk) const
+	{
+		checkType<T>();
+		T value;
+		std::memcpy(&value, &chunk.max, sizeof(T));
+		return value;
+	}
+
+	// Whether the statistics leave room for a value in [low, high], a chunk that does not need not be read
+	template<typename T>
+	bool mayContain(const Chunk& chunk, T low, T high) const
+	{
+		return !(max<T>(chunk) < low || high < min<T>(chunk));
+	}
+
+private:
+	template<typename T>
+	void checkType() const
+	{
+		if (ColumnTypeOf<T>::type != header.type) {
+			throw std::runtime_error("Column is read as the wrong type.");
+		}
+	}
+
+	IOMapper mapper;
+	std::unique_ptr<MemoryMappedChunk> mapping;
+	const char* data = nullptr;
+	size_t size = 0;
+	ColumnFileHeader header{};
+	std::vector<Chunk> chunkList;
+	uint64_t rowCount = 0;
+};
+
+// Counts the values of a column in [low, high], an empty bound being open, reading only the chunks
+// whose statistics allow for a match
+struct ColumnScan
+{
+	uint64_t rows = 0;
+	uint64_t matches = 0;
+	size_t chunks = 0;
+	size_t chunksRead = 0;
+};
+
+ColumnScan scanColumn(const ColumnReader& column, const std::string& low, const std::string& high);
@@ -0,0 +1,356 @@
+#include <filesystem>
+#include <type_traits>
+
+#include "Column_Sink.hpp"
+#include "Column_File.hpp"
+
+namespace
+{
+    // Creates the table's directory before its columns open their files in it
+    std::filesystem::path tableDirectory(const std::filesystem::path& root, const char* name)
+    {
+        const std::filesystem::path directory = root / name;
+        std::filesystem::create_directories(directory);
+        return directory;
+    }
+
+    std::string columnPath(const std::filesystem::path& table, const char* name)
+    {
+        return (table / (std::string(name) + ".col")).string();
+    }
+
+    struct PacketColumns
+    {
+        explicit PacketColumns(const std::filesystem::path& table)
+            : sendingTime(columnPath(table, "SendingTime")), msgSeqNum(columnPath(table, "MsgSeqNum")) {}
+
+        void append(const SIMBAPacket& packet)
+        {
+            sendingTime.append(packet.marketDataHeader.SendingTime);
+            msgSeqNum.append(packet.marketDataHeader.MsgSeqNum);
+        }
+
+        ColumnWriter<uint64_t> sendingTime;
+        ColumnWriter<uint32_t> msgSeqNum;
+    };
+
+    uint64_t transactTime(const SIMBAPacket& packet) noexcept
+    {
+        return packet.incrementalHeader ? packet.incrementalHeader->TransactTime : 0;
+    }
+
+    struct OrderUpdateTable
+    {
+        explicit OrderUpdateTable(const std::filesystem::path& root)
+            : directory(tableDirectory(root, MessageTraits<OrderUpdate>::name)), packet(directory),
+              transactTime(columnPath(directory, "TransactTime")), mdEntryId(columnPath(directory, "MDEntryID")),
+              mdEntryPx(columnPath(directory, "MDEntryPx")), mdEntrySize(columnPath(directory, "MDEntrySize")),
+              mdFlags(columnPath(directory, "MDFlags")), securityId(columnPath(directory, "SecurityID")),
+              rptSeq(columnPath(directory, "RptSeq")), mdUpdateAction(columnPath(directory, "MDUpdateAction")),
+              mdEntryType(columnPath(directory, "MDEntryType")) {}
+
+        void append(const SIMBAPacket& from, const OrderUpdate& update)
+        {
+            packet.append(from);
+            transactTime.append(::transactTime(from));
+            mdEntryId.append(update.MDEntryID);
+            mdEntryPx.append(update.MDEntryPx.mantissa);
+            mdEntrySize.append(update.MDEntrySize);
+            mdFlags.append(static_cast<uint64_t>(update.MDFlags));
+            securityId.append(update.SecurityID);
+            rptSeq.append(update.RptSeq);
+            mdUpdateAction.append(static_cast<uint8_t>(update.mdUpdateAction));
+            mdEntryType.append(static_cast<uint8_t>(update.mdEntryType));
+        }
+
+        std::filesystem::path directory;
+        PacketColumns packet;
+        ColumnWriter<uint64_t> transactTime;
+        ColumnWriter<int64_t> mdEntryId;
+        ColumnWriter<int64_t> mdEntryPx;
+        ColumnWriter<int64_t> mdEntrySize;
+        ColumnWriter<uint64_t> mdFlags;
+        ColumnWriter<int32_t> securityId;
+        ColumnWriter<uint32_t> rptSeq;
+        ColumnWriter<uint8_t> mdUpdateAction;
+        ColumnWriter<uint8_t> mdEntryType;
+    };
+
+    struct OrderExecutionTable
+    {
+        explicit OrderExecutionTable(const std::filesystem::path& root)
+            : directory(tableDirectory(root, MessageTraits<OrderExecution>::name)), packet(directory),
+              transactTime(columnPath(directory, "TransactTime")), mdEntryId(columnPath(directory, "MDEntryID")),
+              mdEntryPx(columnPath(directory, "MDEntryPx")), mdEntrySize(columnPath(directory, "MDEntrySize")),
+              lastPx(columnPath(directory, "LastPx")), lastQty(columnPath(directory, "LastQty")),
+              tradeId(columnPath(directory, "TradeID")), mdFlags(columnPath(directory, "MDFlags")),
+              securityId(columnPath(directory, "SecurityID")), rptSeq(columnPath(directory, "RptSeq")),
+              mdUpdateAction(columnPath(directory, "MDUpdateAction")), mdEntryType(columnPath(directory, "MDEntryType")) {}
+
+        void append(const SIMBAPacket& from, const OrderExecution& execution)
+        {
+            packet.append(from);
+            transactTime.append(::transactTime(from));
+            mdEntryId.append(execution.MDEntryID);
+            mdEntryPx.append(execution.MDEntryPx.mantissa);
+            mdEntrySize.append(execution.MDEntrySize);
+            lastPx.append(execution.LastPx.mantissa);
+            lastQty.append(execution.LastQty);
+            tradeId.append(execution.TradeID);
+            mdFlags.append(static_cast<uint64_t>(execution.MDFlags));
+            securityId.append(execution.SecurityID);
+            rptSeq.append(execution.RptSeq);
+            mdUpdateAction.append(static_cast<uint8_t>(execution.mdUpdateAction));
+            mdEntryType.append(static_cast<uint8_t>(execution.mdEntryType));
+        }
+
+        std::filesystem::path directory;
+        PacketColumns packet;
+        ColumnWriter<uint64_t> transactTime;
+        ColumnWriter<int64_t> mdEntryId;
+        ColumnWriter<int64_t> mdEntryPx;
+        ColumnWriter<int64_t> mdEntrySize;
+        ColumnWriter<int64_t> lastPx;
+        ColumnWriter<int64_t> lastQty;
+        ColumnWriter<int64_t> tradeId;
+        ColumnWriter<uint64_t> mdFlags;
+        ColumnWriter<int32_t> securityId;
+        ColumnWriter<uint32_t> rptSeq;
+        ColumnWriter<uint8_t> mdUpdateAction;
+        ColumnWriter<uint8_t> mdEntryType;
+    };
+
+    // One row per entry, with the snapshot's own fields repeated
+    struct OrderBookSnapshotTable
+    {
+        explicit OrderBookSnapshotTable(const std::filesystem::path& root)
+            : directory(tableDirectory(root, MessageTraits<OrderBookSnapshot>::name)), packet(directory),
+              securityId(columnPath(directory, "SecurityID")), lastMsgSeqNumProcessed(columnPath(directory, "LastMsgSeqNumProcessed")),
+              rptSeq(columnPath(directory, "RptSeq")), exchangeTradingSessionId(columnPath(directory, "ExchangeTradingSessionID")),
+              mdEntryId(columnPath(directory, "MDEntryID")), transactTime(columnPath(directory, "TransactTime")),
+              mdEntryPx(columnPath(directory, "MDEntryPx")), mdEntrySize(columnPath(directory, "MDEntrySize")),
+              tradeId(columnPath(directory, "TradeID")), mdFlags(columnPath(directory, "MDFlags")),
+              mdEntryType(columnPath(directory, "MDEntryType")) {}
+
+        void append(const SIMBAPacket& from, const OrderBookSnapshot& snapshot)
+        {
+            if (!snapshot.MDEntries)
+                return;
+            for (const OrderBookSnapshotEntry& entry : *snapshot.MDEntries)
+            {
+                packet.append(from);
+                securityId.append(snapshot.SecurityID);
+                lastMsgSeqNumProcessed.append(snapshot.LastMsgSeqNumProcessed);
+                rptSeq.append(snapshot.RptSeq);
+                exchangeTradingSessionId.append(snapshot.ExchangeTradingSessionID);
+                mdEntryId.append(entry.MDEntryID);
+                transactTime.append(entry.TransactTime);
+                mdEntryPx.append(entry.MDEntryPx.mantissa);
+                mdEntrySize.append(entry.MDEntrySize);
+                tradeId.append(entry.TradeID);
+                mdFlags.append(static_cast<uint64_t>(entry.MDFlags));
+                mdEntryType.append(static_cast<uint8_t>(entry.mdEntryType));
+            }
+        }
+
+        std::filesystem::path directory;
+        PacketColumns packet;
+        ColumnWriter<int32_t> securityId;
+        ColumnWriter<uint32_t> lastMsgSeqNumProcessed;
+        ColumnWriter<uint32_t> rptSeq;
+        ColumnWriter<uint32_t> exchangeTradingSessionId;
+        ColumnWriter<int64_t> mdEntryId;
+        ColumnWriter<uint64_t> transactTime;
+        ColumnWriter<int64_t> mdEntryPx;
+        ColumnWriter<int64_t> mdEntrySize;
+        ColumnWriter<int64_t> tradeId;
+        ColumnWriter<uint64_t> mdFlags;
+        ColumnWriter<uint8_t> mdEntryType;
+    };
+
+    struct BestPricesTable
+    {
+        explicit BestPricesTable(const std::filesystem::path& root)
+            : directory(tableDirectory(root, MessageTraits<BestPrices>::name)), packet(directory),
+              mktBidPx(columnPath(directory, "MktBidPx")), mktOfferPx(columnPath(directory, "MktOfferPx")),
+              mktBidSize(columnPath(directory, "MktBidSize")), mktOfferSize(columnPath(directory, "MktOfferSize")),
+              securityId(columnPath(directory, "SecurityID")) {}
+
+        void append(const SIMBAPacket& from, const BestPrices& prices)
+        {
+            for (const BestPricesEntry& entry : prices.MDEntries)
+            {
+                packet.append(from);
+                mktBidPx.append(entry.MktBidPx.mantissa);
+                mktOfferPx.append(entry.MktOfferPx.mantissa);
+                mktBidSize.append(entry.MktBidSize);
+                mktOfferSize.append(entry.MktOfferSize);
+                securityId.append(entry.SecurityID);
+            }
+        }
+
+        std::filesystem::path directory;
+        PacketColumns packet;
+        ColumnWriter<int64_t> mktBidPx;
+        ColumnWriter<int64_t> mktOfferPx;
+        ColumnWriter<int64_t> mktBidSize;
+        ColumnWriter<int64_t> mktOfferSize;
+        ColumnWriter<int32_t> securityId;
+    };
+
+    struct EmptyBookTable
+    {
+        explicit EmptyBookTable(const std::filesystem::path& root)
+            : directory(tableDirectory(root, MessageTraits<EmptyBook>::name)), packet(directory),
+              lastMsgSeqNumProcessed(columnPath(directory, "LastMsgSeqNumProcessed")) {}
+
+        void append(const SIMBAPacket& from, const EmptyBook& emptyBook)
+        {
+            packet.append(from);
+            lastMsgSeqNumProcessed.append(emptyBook.LastMsgSeqNumProcessed);
+        }
+
+        std::filesystem::path directory;
+        PacketColumns packet;
+        ColumnWriter<uint32_t> lastMsgSeqNumProcessed;
+    };
+
+    struct SecurityStatusTable
+    {
+        explicit SecurityStatusTable(const std::filesystem::path& root)
+            : directory(tableDirectory(root, MessageTraits<SecurityStatus>::name)), packet(directory),
+              securityId(columnPath(directory, "SecurityID")), securityTradingStatus(columnPath(directory, "SecurityTradingStatus")),
+              highLimitPx(columnPath(directory, "HighLimitPx")), lowLimitPx(columnPath(directory, "LowLimitPx")),
+              initialMarginOnBuy(columnPath(directory, "InitialMarginOnBuy")), initialMarginOnSell(columnPath(directory, "InitialMarginOnSell")),
+              initialMarginSyntetic(columnPath(directory, "InitialMarginSyntetic")) {}
+
+        void append(const SIMBAPacket& from, const SecurityStatus& status)
+        {
+            packet.append(from);
+            securityId.append(status.SecurityID);
+            securityTradingStatus.append(static_cast<uint8_t>(status.securityTradingStatus));
+            highLimitPx.append(status.HighLimitPx.mantissa);
+            lowLimitPx.append(status.LowLimitPx.mantissa);
+            initialMarginOnBuy.append(status.InitialMarginOnBuy.mantissa);
+            initialMarginOnSell.append(status.InitialMarginOnSell.mantissa);
+            initialMarginSyntetic.append(status.InitialMarginSyntetic.mantissa);
+        }
+
+        std::filesystem::path directory;
+        PacketColumns packet;
+        ColumnWriter<int32_t> securityId;
+        ColumnWriter<uint8_t> securityTradingStatus;
+        ColumnWriter<int64_t> highLimitPx;
+        ColumnWriter<int64_t> lowLimitPx;
+        ColumnWriter<int64_t> initialMarginOnBuy;
+        ColumnWriter<int64_t> initialMarginOnSell;
+        ColumnWriter<int64_t> initialMarginSyntetic;
+    };
+
+    struct SecurityDefinitionUpdateReportTable
+    {
+        explicit SecurityDefinitionUpdateReportTable(const std::filesystem::path& root)
+            : directory(tableDirectory(root, MessageTraits<SecurityDefinitionUpdateReport>::name)), packet(directory),
+              securityId(columnPath(directory, "SecurityID")), volatility(columnPath(directory, "Volatility")),
+              theorPrice(columnPath(directory, "TheorPrice")), theorPriceLimit(columnPath(directory, "TheorPriceLimit")) {}
+
+        void append(const SIMBAPacket& from, const SecurityDefinitionUpdateReport& report)
+        {
+            packet.append(from);
+            securityId.append(report.SecurityID);
+            volatility.append(report.Volatility.mantissa);
+            theorPrice.append(report.TheorPrice.mantissa);
+            theorPriceLimit.append(report.TheorPriceLimit.mantissa);
+        }
+
+        std::filesystem::path directory;
+        PacketColumns packet;
+        ColumnWriter<int32_t> securityId;
+        ColumnWriter<int64_t> volatility;
+        ColumnWriter<int64_t> theorPrice;
+        ColumnWriter<int64_t> theorPriceLimit;
+    };
+
+    struct SecurityMassStatusTable
+    {
+        explicit SecurityMassStatusTable(const std::filesystem::path& root)
+            : directory(tableDirectory(root, MessageTraits<SecurityMassStatus>::name)), packet(directory),
+              securityId(columnPath(directory, "SecurityID")), securityTradingStatus(columnPath(directory, "SecurityTradingStatus")) {}
+
+        void append(const SIMBAPacket& from, const SecurityMassStatus& massStatus)
+        {
+            for (const SecurityMassStatusEntry& entry : massStatus.Entries)
+            {
+                packet.append(from);
+                securityId.append(entry.SecurityID);
+                securityTradingStatus.append(static_cast<uint8_t>(entry.securityTradingStatus));
+            }
+        }
+
+        std::filesystem::path directory;
+        PacketColumns packet;
+        ColumnWriter<int32_t> securityId;
+        ColumnWriter<uint8_t> securityTradingStatus;
+    };
+}
+
+struct ColumnSink::Tables
+{
+    explicit Tables(const std::filesystem::path& root)
+        : orderUpdate(root), orderExecution(root), orderBookSnapshot(root), bestPrices(root), emptyBook(root),
+          securityStatus(root), securityDefinitionUpdateReport(root), securityMassStatus(root) {}
+
+    OrderUpdateTable orderUpdate;
+    OrderExecutionTable orderExecution;
+    OrderBookSnapshotTable orderBookSnapshot;
+    BestPricesTable bestPrices;
+    EmptyBookTable emptyBook;
+    SecurityStatusTable securityStatus;
+    SecurityDefinitionUpdateReportTable securityDefinitionUpdateReport;
+    SecurityMassStatusTable securityMassStatus;
+};
+
+ColumnSink::ColumnSink(const std::string& outputDirectory)
+    : tables(std::make_unique<Tables>(outputDirectory))
+{
+}
+
+ColumnSink::~ColumnSink() = default; // The column writers write their last chunks
+
+TemplateFilter ColumnSink::requiredTemplates()
+{
+    TemplateFilter filter;
+    filter.addMessage(MessageTraits<OrderUpdate>::templateId);
+    filter.addMessage(MessageTraits<OrderExecution>::templateId);
+    filter.addMessage(MessageTraits<OrderBookSnapshot>::templateId);
+    filter.addMessage(MessageTraits<BestPrices>::templateId);
+    filter.addMessage(MessageTraits<EmptyBook>::templateId);
+    filter.addMessage(MessageTraits<SecurityStatus>::templateId);
+    filter.addMessage(MessageTraits<SecurityDefinitionUpdateReport>::templateId);
+    filter.addMessage(MessageTraits<SecurityMassStatus>::templateId);
+    return filter;
+}
+
+void ColumnSink::onPacket(const SIMBAPacket& packet)
+{
+    packet.messages.forEach([&](const auto& message)
+    {
+        using Message = std::remove_cvref_t<decltype(message)>;
+        if constexpr (std::is_same_v<Message, OrderUpdate>)
+            tables->orderUpdate.append(packet, message);
+        else if constexpr (std::is_same_v<Message, OrderExecution>)
+            tables->orderExecution.append(packet, message);
+        else if constexpr (std::is_same_v<Message, OrderBookSnapshot>)
+            tables->orderBookSnapshot.append(packet, message);
+        else if constexpr (std::is_same_v<Message, BestPrices>)
+            tables->bestPrices.append(packet, message);
+        else if constexpr (std::is_same_v<Message, EmptyBook>)
+            tables->emptyBook.append(packet, message);
+        else if constexpr (std::is_same_v<Message, SecurityStatus>)
+            tables->securityStatus.append(packet, message);
+        else if constexpr (std::is_same_v<Message, SecurityDefinitionUpdateReport>)
+            tables->securityDefinitionUpdateReport.append(packet, message);
+        else if constexpr (std::is_same_v<Message, SecurityMassStatus>)
+            tables->securityMassStatus.append(packet, message);
+    });
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "Packet_Sink.hpp"
+#include "Parser_Options.hpp"
+
+// Writes the messages of each numeric template as a table of column files under the output directory,
+// <output>/<template>/<column>.col, one row per message or per entry of its repeating group. Rows carry
+// the SendingTime and MsgSeqNum of their packet, decimals their mantissa and enums their wire value.
+// SecurityDefinition and the session messages have no table, the reference data is mostly text
+class ColumnSink : public PacketSink
+{
+public:
+	explicit ColumnSink(const std::string& outputDirectory);
+	~ColumnSink() override;
+
+	// The templates there are tables for, nothing else is decoded
+	static TemplateFilter requiredTemplates();
+
+	void onPacket(const SIMBAPacket& packet) override;
+
+private:
+	struct Tables;
+	std::unique_ptr<Tables> tables;
+};
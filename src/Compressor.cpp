@@ -0,0 +1,173 @@
+#include <cstring>
+#include <stdexcept>
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+#include "Compressor.hpp"
+
+namespace
+{
+#ifdef HAVE_ZSTD
+    // One zstd frame for the whole file. With workers, ZSTD_compressStream2 hands the input to them in
+    // jobs and returns, the frame's blocks coming back in order as the jobs finish
+    class ZstdCompressor : public Compressor
+    {
+    public:
+        explicit ZstdCompressor(const CompressionOptions& options) : context(ZSTD_createCCtx())
+        {
+            if (context == nullptr) {
+                throw std::runtime_error("Unable to create a zstd context.");
+            }
+            check(ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, options.level != 0 ? options.level : ZSTD_CLEVEL_DEFAULT));
+            ZSTD_CCtx_setParameter(context, ZSTD_c_nbWorkers, static_cast<int>(options.threads)); // A library built without threads compresses inline
+        }
+
+        ~ZstdCompressor() override { ZSTD_freeCCtx(context); }
+
+        void compress(const char* data, size_t size, std::vector<char>& output) override { run(data, size, ZSTD_e_continue, output); }
+        void finish(std::vector<char>& output) override { run(nullptr, 0, ZSTD_e_end, output); }
+
+    private:
+        static size_t check(size_t result)
+        {
+            if (ZSTD_isError(result)) {
+                throw std::runtime_error(std::string("zstd compression failed: ") + ZSTD_getErrorName(result));
+            }
+            return result;
+        }
+
+        void run(const char* data, size_t size, ZSTD_EndDirective mode, std::vector<char>& output)
+        {
+            ZSTD_inBuffer input{ data, size, 0 };
+            size_t remaining = 0;
+            do
+            {
+                const size_t used = output.size();
+                output.resize(used + ZSTD_CStreamOutSize());
+                ZSTD_outBuffer out{ output.data() + used, output.size() - used, 0 };
+                remaining = check(ZSTD_compressStream2(context, &out, &input, mode));
+                output.resize(used + out.pos);
+            } while (mode == ZSTD_e_end ? remaining != 0 : input.pos < input.size);
+        }
+
+        ZSTD_CCtx* context;
+    };
+#endif
+
+#ifdef HAVE_LZ4
+    // One lz4 frame, compressed on the calling thread
+    class LZ4Compressor : public Compressor
+    {
+    public:
+        explicit LZ4Compressor(const CompressionOptions& options)
+        {
+            check(LZ4F_createCompressionContext(&context, LZ4F_VERSION));
+            preferences.compressionLevel = options.level;
+            preferences.frameInfo.blockSizeID = LZ4F_max4MB;
+            preferences.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+        }
+
+        ~LZ4Compressor() override { LZ4F_freeCompressionContext(context); }
+
+        void compress(const char* data, size_t size, std::vector<char>& output) override
+        {
+            begin(output);
+            const size_t used = output.size();
+            output.resize(used + LZ4F_compressBound(size, &preferences));
+            output.resize(used + check(LZ4F_compressUpdate(context, output.data() + used, output.size() - used, data, size, nullptr)));
+        }
+
+        void finish(std::vector<char>& output) override
+        {
+            begin(output);
+            const size_t used = output.size();
+            output.resize(used + LZ4F_compressBound(0, &preferences));
+            output.resize(used + check(LZ4F_compressEnd(context, output.data() + used, output.size() - used, nullptr)));
+        }
+
+    private:
+        static size_t check(size_t result)
+        {
+            if (LZ4F_isError(result)) {
+                throw std::runtime_error(std::string("lz4 compression failed: ") + LZ4F_getErrorName(result));
+            }
+            return result;
+        }
+
+        void begin(std::vector<char>& output)
+        {
+            if (started)
+                return;
+            const size_t used = output.size();
+            output.resize(used + LZ4F_HEADER_SIZE_MAX);
+            output.resize(used + check(LZ4F_compressBegin(context, output.data() + used, LZ4F_HEADER_SIZE_MAX, &preferences)));
+            started = true;
+        }
+
+        LZ4F_cctx* context = nullptr;
+        LZ4F_preferences_t preferences{};
+        bool started = false;
+    };
+#endif
+}
+
+CompressionOptions CompressionOptions::parse(const std::string& text)
+{
+    CompressionOptions options;
+    const size_t colon = text.find(':');
+    const std::string codec = text.substr(0, colon);
+    if (codec == "zstd")
+        options.codec = Codec::Zstd;
+    else if (codec == "lz4")
+        options.codec = Codec::LZ4;
+    else if (codec == "none")
+        options.codec = Codec::None;
+    else
+        throw std::runtime_error("Unknown compression: " + codec);
+
+    if (colon != std::string::npos)
+        options.level = std::stoi(text.substr(colon + 1));
+    return options;
+}
+
+bool CompressionOptions::available(Codec codec) noexcept
+{
+    switch (codec)
+    {
+    case Codec::None: return true;
+#ifdef HAVE_ZSTD
+    case Codec::Zstd: return true;
+#endif
+#ifdef HAVE_LZ4
+    case Codec::LZ4: return true;
+#endif
+    default: return false;
+    }
+}
+
+std::unique_ptr<Compressor> Compressor::create(const CompressionOptions& options)
+{
+    switch (options.codec)
+    {
+#ifdef HAVE_ZSTD
+    case CompressionOptions::Codec::Zstd: return std::make_unique<ZstdCompressor>(options);
+#endif
+#ifdef HAVE_LZ4
+    case CompressionOptions::Codec::LZ4: return std::make_unique<LZ4Compressor>(options);
+#endif
+    case CompressionOptions::Codec::None: return nullptr;
+    default: throw std::runtime_error("This build has no support for the requested compression, zstd or lz4 was not found.");
+    }
+}
+
+bool isCompressedFile(const char* data, size_t size) noexcept
+{
+    static constexpr unsigned char ZSTD_MAGIC[] = { 0x28, 0xB5, 0x2F, 0xFD };
+    static constexpr unsigned char LZ4_MAGIC[] = { 0x04, 0x22, 0x4D, 0x18 };
+    return size >= 4 && (std::memcmp(data, ZSTD_MAGIC, 4) == 0 || std::memcmp(data, LZ4_MAGIC, 4) == 0);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Codec and settings of compressed output, parsed from --compress such as "zstd" or "lz4:9"
+struct CompressionOptions
+{
+	enum class Codec : uint8_t { None, Zstd, LZ4 };
+
+	Codec codec = Codec::None;
+	int level = 0;      // 0 for the codec's default
+	size_t threads = 1; // zstd workers compressing parts of the stream in parallel, next to the writer thread
+
+	static CompressionOptions parse(const std::string& text);
+
+	// Whether the codec was found when the parser was built
+	static bool available(Codec codec) noexcept;
+
+	bool enabled() const noexcept { return codec != Codec::None; }
+};
+
+// Streaming compressor of one output file. The input is fed in any number of pieces and the compressed
+// stream is appended to an output vector as it becomes ready, so it can be written while input keeps coming.
+// The result is a standard .zst or .lz4 frame that the command line tools decompress
+class Compressor
+{
+public:
+	// Throws if the codec was not built in
+	static std::unique_ptr<Compressor> create(const CompressionOptions& options);
+
+	virtual ~Compressor() = default;
+
+	virtual void compress(const char* data, size_t size, std::vector<char>& output) = 0;
+
+	// Ends the frame, appending everything still held back
+	virtual void finish(std::vector<char>& output) = 0;
+};
+
+// Whether a file starts like a zstd or lz4 frame, for an input that has to be decompressed first
+bool isCompressedFile(const char* data, size_t size) noexcept;
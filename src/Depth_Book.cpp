@@ -0,0 +1,92 @@
+#include <algorithm>
+
+#include "Depth_Book.hpp"
+
+DepthBook::DepthBook(size_t depth)
+    : depth(depth)
+{
+}
+
+// Position of the first level that is not worse than price, the insertion point that keeps the array sorted
+template<OrderBook::Side side>
+size_t DepthBook::findLevel(const std::vector<Level>& levels, int64_t price) noexcept
+{
+    constexpr auto worse = [](int64_t levelPrice, int64_t price) noexcept
+    {
+        return side == OrderBook::Bid ? levelPrice < price : levelPrice > price;
+    };
+
+    size_t position = levels.size();
+    const size_t linearEnd = position > LINEAR_SEARCH_LEVELS ? position - LINEAR_SEARCH_LEVELS : 0;
+    while (position > linearEnd)
+    {
+        if (worse(levels[position - 1].price, price))
+            return position;
+        --position;
+    }
+
+    // Deep in the book, binary search what is left below the scanned levels
+    const auto first = std::partition_point(levels.begin(), levels.begin() + position,
+        [price, worse](const Level& level) { return worse(level.price, price); });
+    return static_cast<size_t>(first - levels.begin());
+}
+
+void DepthBook::onLevel(uint32_t book, OrderBook::Side side, int64_t price, int64_t size, uint32_t orderCount)
+{
+    if (book >= books.size())
+        books.resize(book + 1);
+
+    std::vector<Level>& levels = books[book].levels[side];
+    const size_t position = side == OrderBook::Bid ? findLevel<OrderBook::Bid>(levels, price) : findLevel<OrderBook::Offer>(levels, price);
+    const bool found = position < levels.size() && levels[position].price == price;
+    const size_t rank = levels.size() - position + (found ? 0 : 1); // 1 for the best level
+
+    if (orderCount == 0)
+    {
+        if (!found)
+            return;
+        levels.erase(levels.begin() + position);
+    }
+    else if (found)
+    {
+        levels[position].size = size;
+        levels[position].orderCount = orderCount;
+    }
+    else
+    {
+        levels.insert(levels.begin() + position, Level{ price, size, orderCount });
+    }
+
+    if (rank <= depth)
+        markChanged(book);
+}
+
+void DepthBook::onClear(uint32_t book)
+{
+    if (book >= books.size())
+        books.resize(book + 1);
+
+    for (std::vector<Level>& levels : books[book].levels)
+        levels.clear();
+    markChanged(book);
+}
+
+size_t DepthBook::top(uint32_t book, OrderBook::Side side, std::span<Level> out) const noexcept
+{
+    if (book >= books.size())
+        return 0;
+
+    const std::vector<Level>& levels = books[book].levels[side];
+    const size_t count = std::min(out.size(), levels.size());
+    std::reverse_copy(levels.end() - count, levels.end(), out.begin());
+    return count;
+}
+
+void DepthBook::markChanged(uint32_t book)
+{
+    if (!books[book].changed)
+    {
+        books[book].changed = true;
+        changedBooks.push_back(book);
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Order_Book.hpp"
+
+// Aggregated price level (L2) book per instrument, kept as one flat sorted array per side and fed with the
+// level changes of the L3 book. Each array is ordered from the worst price to the best one, so the levels
+// that change most often sit at the end: finding them is a short linear scan back from the top, and
+// inserting or erasing one moves only the few levels above it
+class DepthBook : public OrderBook::Listener
+{
+public:
+	struct Level
+	{
+		int64_t price;       // Decimal5 mantissa
+		int64_t size;        // Sum of the order sizes
+		uint32_t orderCount;
+	};
+
+	// depth is how many levels from the top count as a change worth reporting
+	explicit DepthBook(size_t depth = 10);
+
+	void onLevel(uint32_t book, OrderBook::Side side, int64_t price, int64_t size, uint32_t orderCount) override;
+	void onClear(uint32_t book) override;
+
+	// Copies up to out.size() levels of a side, best first, and returns how many were copied
+	size_t top(uint32_t book, OrderBook::Side side, std::span<Level> out) const noexcept;
+
+	// Calls function(book) for every book whose top depth levels changed since it was last taken, in the
+	// order they first changed. A book stays marked when function returns false
+	template<typename Function>
+	void takeChanged(Function&& function)
+	{
+		size_t kept = 0;
+		for (uint32_t book : changedBooks)
+		{
+			if (function(book))
+				books[book].changed = false;
+			else
+				changedBooks[kept++] = book;
+		}
+		changedBooks.resize(kept);
+	}
+
+private:
+	static constexpr size_t LINEAR_SEARCH_LEVELS = 8; // Levels scanned from the top before falling back to binary search
+
+	struct Sides
+	{
+		std::array<std::vector<Level>, 2> levels; // Worst to best
+		bool changed = false;
+	};
+
+	template<OrderBook::Side side>
+	static size_t findLevel(const std::vector<Level>& levels, int64_t price) noexcept;
+
+	void markChanged(uint32_t book);
+
+	std::vector<Sides> books; // Same positions as OrderBook::books()
+	std::vector<uint32_t> changedBooks;
+	size_t depth;
+};
@@ -0,0 +1,412 @@
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include "Event_Log.hpp"
+
+namespace
+{
+    constexpr size_t RECORD_ALIGNMENT = 8;
+    constexpr uint32_t ABSENT_GROUP = std::numeric_limits<uint32_t>::max();
+
+    // Appends the body of an out of line message after its record header
+    class BodyWriter
+    {
+    public:
+        explicit BodyWriter(std::vector<std::byte>& buffer) : buffer(buffer) {}
+
+        void raw(const void* data, size_t size)
+        {
+            const size_t used = buffer.size();
+            buffer.resize(used + size);
+            if (size != 0)
+                std::memcpy(buffer.data() + used, data, size);
+        }
+
+        template<typename T>
+        void block(const T& value) { raw(&value, sizeof(T)); }
+
+        template<typename T>
+        void group(const std::vector<T>& entries)
+        {
+            block(static_cast<uint32_t>(entries.size()));
+            raw(entries.data(), entries.size() * sizeof(T));
+        }
+
+        template<typename T>
+        void group(const std::unique_ptr<std::vector<T>>& entries)
+        {
+            if (entries)
+                group(*entries);
+            else
+                block(ABSENT_GROUP);
+        }
+
+        template<typename String>
+        void text(const String& string)
+        {
+            block(static_cast<uint32_t>(string.empty() ? 0 : string.size()));
+            raw(string.data(), string.empty() ? 0 : string.size());
+        }
+
+    private:
+        std::vector<std::byte>& buffer;
+    };
+
+    // Reads a body written by BodyWriter, var data is left pointing into it
+    class BodyReader
+    {
+    public:
+        explicit BodyReader(std::span<const std::byte> body) : body(body) {}
+
+        template<typename T>
+        T block()
+        {
+            T value;
+            std::memcpy(&value, take(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        template<typename T>
+        std::vector<T> group()
+        {
+            const uint32_t count = block<uint32_t>();
+            std::vector<T> entries(count == ABSENT_GROUP ? 0 : count);
+            if (!entries.empty()) // An empty vector's data() may be null
+                std::memcpy(entries.data(), take(entries.size() * sizeof(T)), entries.size() * sizeof(T));
+            return entries;
+        }
+
+        template<typename T>
+        std::unique_ptr<std::vector<T>> optionalGroup()
+        {
+            const size_t start = offset;
+            if (block<uint32_t>() == ABSENT_GROUP)
+                return nullptr;
+            offset = start;
+            return std::make_unique<std::vector<T>>(group<T>());
+        }
+
+        template<typename String>
+        String text()
+        {
+            const uint32_t length = block<uint32_t>();
+            String string{};
+            string.length = static_cast<uint16_t>(length);
+            string.varData = reinterpret_cast<const uint8_t*>(take(length));
+            return string;
+        }
+
+    private:
+        const std::byte* take(size_t size)
+        {
+            if (size > body.size() - offset) {
+                throw std::runtime_error("Event log record body is truncated.");
+            }
+            const std::byte* data = body.data() + offset;
+            offset += size;
+            return data;
+        }
+
+        std::span<const std::byte> body;
+        size_t offset = 0;
+    };
+
+    // Out of line messages, root block first and then their groups and var data in schema order
+    void writeBody(BodyWriter& out, const OrderBookSnapshot& snapshot)
+    {
+        out.block(static_cast<const OrderBookSnapshotBlock&>(snapshot));
+        out.block(snapshot.NoMDEntries);
+        out.group(snapshot.MDEntries);
+    }
+
+    void writeBody(BodyWriter& out, const BestPrices& prices)
+    {
+        out.block(prices.NoMDEntries);
+        out.group(prices.MDEntries);
+    }
+
+    void writeBody(BodyWriter& out, const SecurityMassStatus& massStatus)
+    {
+        out.block(massStatus.NoRelatedSym);
+        out.group(massStatus.Entries);
+    }
+
+    void writeBody(BodyWriter& out, const SecurityDefinition& definition)
+    {
+        out.block(static_cast<const SecurityDefinitionBlock&>(definition));
+        out.block(definition.NoMDFeedTypes);
+        out.group(definition.MDFeedTypesEntries);
+        out.block(definition.NoUnderlyings);
+        out.group(definition.UnderlyingsEntries);
+        out.block(definition.NoLegs);
+        out.group(definition.LegsEntries);
+        out.block(definition.NoInstrAttrib);
+        out.group(definition.InstrAttribEntries);
+        out.block(definition.NoEvents);
+        out.group(definition.EventsEntries);
+        out.text(definition.SecurityDesc);
+        out.text(definition.QuotationList);
+    }
+
+    void writeBody(BodyWriter& out, const Logout& logout)
+    {
+        out.block(logout);
+    }
+
+    template<typename T>
+    T readBody(BodyReader& in);
+
+    template<>
+    OrderBookSnapshot readBody<OrderBookSnapshot>(BodyReader& in)
+    {
+        OrderBookSnapshot snapshot{};
+        static_cast<OrderBookSnapshotBlock&>(snapshot) = in.block<OrderBookSnapshotBlock>();
+        snapshot.NoMDEntries = in.block<GroupSize>();
+        snapshot.MDEntries = in.optionalGroup<OrderBookSnapshotEntry>();
+        return snapshot;
+    }
+
+    template<>
+    BestPrices readBody<BestPrices>(BodyReader& in)
+    {
+        BestPrices prices{};
+        prices.NoMDEntries = in.block<GroupSize>();
+        prices.MDEntries = in.group<BestPricesEntry>();
+        return prices;
+    }
+
+    template<>
+    SecurityMassStatus readBody<SecurityMassStatus>(BodyReader& in)
+    {
+        SecurityMassStatus massStatus{};
+        massStatus.NoRelatedSym = in.block<GroupSize2>();
+        massStatus.Entries = in.group<SecurityMassStatusEntry>();
+        return massStatus;
+    }
+
+    template<>
+    SecurityDefinition readBody<SecurityDefinition>(BodyReader& in)
+    {
+        SecurityDefinition definition{};
+        static_cast<SecurityDefinitionBlock&>(definition) = in.block<SecurityDefinitionBlock>();
+        definition.NoMDFeedTypes = in.block<GroupSize>();
+        definition.MDFeedTypesEntries = in.optionalGroup<SecurityDefinition::MDFeedTypes>();
+        definition.NoUnderlyings = in.block<GroupSize>();
+        definition.UnderlyingsEntries = in.optionalGroup<SecurityDefinition::Underlyings>();
+        definition.NoLegs = in.block<GroupSize>();
+        definition.LegsEntries = in.optionalGroup<SecurityDefinition::Legs>();
+        definition.NoInstrAttrib = in.block<GroupSize>();
+        definition.InstrAttribEntries = in.optionalGroup<SecurityDefinition::InstrAttrib>();
+        definition.NoEvents = in.block<GroupSize>();
+        definition.EventsEntries = in.optionalGroup<SecurityDefinition::Events>();
+        definition.SecurityDesc = in.text<Utf8String>();
+        definition.QuotationList = in.text<VarString>();
+        return definition;
+    }
+
+    template<>
+    Logout readBody<Logout>(BodyReader& in)
+    {
+        return in.block<Logout>();
+    }
+
+    template<typename T>
+    void addMessage(SIMBAPacket& packet, std::span<const std::byte> body)
+    {
+        if constexpr (isInlineMessage<T>)
+        {
+            if (body.size() != sizeof(T)) {
+                throw std::runtime_error("Event log record has the wrong body size.");
+            }
+            T message;
+            std::memcpy(&message, body.data(), sizeof(T));
+            packet.messages.emplace_back(message);
+        }
+        else
+        {
+            BodyReader in(body);
+            packet.messages.emplace_back(readBody<T>(in));
+        }
+    }
+
+    // Adds the message of a record to the packet by its template, false for one the log cannot hold
+    bool addMessage(SIMBAPacket& packet, uint16_t templateId, std::span<const std::byte> body)
+    {
+        switch (templateId)
+        {
+        case MessageTraits<OrderUpdate>::templateId: addMessage<OrderUpdate>(packet, body); return true;
+        case MessageTraits<OrderExecution>::templateId: addMessage<OrderExecution>(packet, body); return true;
+        case MessageTraits<OrderBookSnapshot>::templateId: addMessage<OrderBookSnapshot>(packet, body); return true;
+        case MessageTraits<SecurityDefinition>::templateId: addMessage<SecurityDefinition>(packet, body); return true;
+        case MessageTraits<SecurityStatus>::templateId: addMessage<SecurityStatus>(packet, body); return true;
+        case MessageTraits<SecurityDefinitionUpdateReport>::templateId: addMessage<SecurityDefinitionUpdateReport>(packet, body); return true;
+        case MessageTraits<SequenceReset>::templateId: addMessage<SequenceReset>(packet, body); return true;
+        case MessageTraits<TradingSessionStatus>::templateId: addMessage<TradingSessionStatus>(packet, body); return true;
+        case MessageTraits<Heartbeat>::templateId: addMessage<Heartbeat>(packet, body); return true;
+        case MessageTraits<BestPrices>::templateId: addMessage<BestPrices>(packet, body); return true;
+        case MessageTraits<EmptyBook>::templateId: addMessage<EmptyBook>(packet, body); return true;
+        case MessageTraits<SecurityMassStatus>::templateId: addMessage<SecurityMassStatus>(packet, body); return true;
+        case MessageTraits<Logon>::templateId: addMessage<Logon>(packet, body); return true;
+        case MessageTraits<Logout>::templateId: addMessage<Logout>(packet, body); return true;
+        case MessageTraits<MarketDataRequest>::templateId: addMessage<MarketDataRequest>(packet, body); return true;
+        default: return false;
+        }
+    }
+}
+
+EventLogSink::EventLogSink(const std::string& outputFilePath, const CompressionOptions& compression)
+    : outputFile(outputFilePath, compression)
+{
+    buffer.reserve(FLUSH_SIZE + 64 * 1024);
+
+    EventLogHeader header{};
+    std::memcpy(header.magic, EventLogHeader::MAGIC, sizeof(header.magic));
+    header.version = EventLogHeader::VERSION;
+    BodyWriter(buffer).block(header);
+}
+
+EventLogSink::~EventLogSink()
+{
+    try
+    {
+        outputFile.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        outputFile.close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+}
+
+void EventLogSink::onPacket(const SIMBAPacket& packet)
+{
+    EventRecordHeader header{};
+    header.channel = packet.channel;
+    header.captureTime = packet.captureTime;
+    header.sendingTime = packet.marketDataHeader.SendingTime;
+    header.msgSeqNum = packet.marketDataHeader.MsgSeqNum;
+    header.msgFlags = packet.marketDataHeader.MsgFlags;
+    header.msgSize = packet.marketDataHeader.MsgSize;
+    header.messageHeader = packet.messageHeader;
+    if (packet.incrementalHeader)
+    {
+        header.transactTime = packet.incrementalHeader->TransactTime;
+        header.exchangeTradingSessionID = packet.incrementalHeader->ExchangeTradingSessionID;
+        header.flags = EventRecordHeader::INCREMENTAL;
+    }
+
+    BodyWriter out(buffer);
+    packet.messages.forEach([&](const auto& message)
+    {
+        using Message = std::remove_cvref_t<decltype(message)>;
+
+        const size_t start = buffer.size();
+        out.block(header);
+        if constexpr (isInlineMessage<Message>)
+            out.block(message);
+        else
+            writeBody(out, message);
+
+        // The header is completed once the body's size is known
+        header.templateId = MessageTraits<Message>::templateId;
+        header.bodySize = static_cast<uint32_t>(buffer.size() - start - sizeof(EventRecordHeader));
+        buffer.resize((buffer.size() + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT);
+        header.size = static_cast<uint32_t>(buffer.size() - start);
+        std::memcpy(buffer.data() + start, &header, sizeof(header));
+        ++header.index;
+    });
+
+    // A packet without decoded messages is kept as a record without a body, so it is replayed too
+    if (header.index == 0)
+    {
+        header.size = sizeof(header);
+        out.block(header);
+    }
+
+    if (buffer.size() >= FLUSH_SIZE)
+    {
+        outputFile.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        buffer.clear();
+    }
+}
+
+EventLogReader::EventLogReader(const std::string& filePath)
+    : mapper(filePath, std::numeric_limits<size_t>::max())
+{
+    // One mapping of the whole log, the chunk size is not limiting it
+    const char* data = nullptr;
+    size_t size = 0;
+    if (!mapper.fetchNextChunk(data, size) || size < sizeof(EventLogHeader)) {
+        throw std::runtime_error("Not an event log: " + filePath);
+    }
+    if (isCompressedFile(data, size)) {
+        throw std::runtime_error("Event log is compressed, it is replayed from the decompressed file: " + filePath);
+    }
+    mapping = std::make_unique<MemoryMappedChunk>(const_cast<char*>(data), size);
+
+    EventLogHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, EventLogHeader::MAGIC, sizeof(header.magic)) != 0 || header.version != EventLogHeader::VERSION) {
+        throw std::runtime_error("Not an event log: " + filePath);
+    }
+    records = std::span<const std::byte>(reinterpret_cast<const std::byte*>(data) + sizeof(header), size - sizeof(header));
+
+    for (size_t offset = 0; offset < records.size();)
+    {
+        EventRecordHeader record;
+        if (records.size() - offset < sizeof(record)) {
+            throw std::runtime_error("Event log is truncated: " + filePath);
+        }
+        std::memcpy(&record, records.data() + offset, sizeof(record));
+        if (record.size < sizeof(record) || record.size % RECORD_ALIGNMENT != 0 || record.size > records.size() - offset
+            || record.bodySize > record.size - sizeof(record)) {
+            throw std::runtime_error("Event log is truncated: " + filePath);
+        }
+        offset += record.size;
+    }
+}
+
+uint64_t EventLogReader::replay(PacketSink& sink, const TemplateFilter& templates) const
+{
+    SIMBAPacket packet; // Reused like the parser's, so message storage is allocated once
+    bool pending = false;
+    uint64_t packets = 0;
+
+    const auto emit = [&]()
+    {
+        // As FrameDecoder does, a packet with none of the selected templates is left out
+        if (pending && (templates.decodesAll() || !packet.messages.empty()))
+        {
+            sink.onPacket(packet);
+            ++packets;
+        }
+        pending = false;
+    };
+
+    for (const Event event : *this)
+    {
+        const EventRecordHeader& header = *event.header;
+        if (header.index == 0)
+        {
+            emit();
+            packet.messages.clear();
+            packet.channel = header.channel;
+            packet.captureTime = header.captureTime;
+            packet.marketDataHeader = MarketDataPacketHeader{ header.msgSeqNum, header.msgSize, header.msgFlags, header.sendingTime };
+            packet.messageHeader = header.messageHeader;
+            if (header.flags & EventRecordHeader::INCREMENTAL)
+                packet.incrementalHeader = IncrementalPacketHeader{ header.transactTime, header.exchangeTradingSessionID };
+            else
+                packet.incrementalHeader.reset();
+            pending = true;
+        }
+
+        if (header.templateId != EventRecordHeader::NO_MESSAGE && templates.accepts(header.templateId) && !addMessage(packet, header.templateId, event.body)) {
+            throw std::runtime_error("Event log has a record of unknown template " + std::to_string(header.templateId));
+        }
+    }
+    emit();
+    return packets;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Async_Writer.hpp"
+#include "IO_Mapper.hpp"
+#include "Packet_Sink.hpp"
+#include "SIMBA_Decoder.hpp"
+
+// Binary log of decoded messages, for running the book, trade and export modes again without pcap
+// framing or SIMBA decoding. A 16 byte file header is followed by one record per message: a 64 byte
+// EventRecordHeader with the message's packet metadata, then the message body padded to 8 bytes. The
+// body is the decoded struct for messages a SIMBAMessageList stores inline, so it can be used straight
+// from the mapping; repeating groups and var data are written after their message's root block as a
+// uint32_t count (UINT32_MAX for a group that was not decoded) and the entries or bytes
+struct EventLogHeader
+{
+	static constexpr char MAGIC[8] = { 'S', 'I', 'M', 'B', 'A', 'E', 'V', 'T' };
+	static constexpr uint32_t VERSION = 1;
+
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+};
+static_assert(sizeof(EventLogHeader) == 16, "EventLogHeader size is incorrect");
+
+struct EventRecordHeader
+{
+	static constexpr uint16_t INCREMENTAL = 1; // flags: the packet has an incremental header
+	static constexpr uint16_t NO_MESSAGE = 0;  // templateId of the one record of a packet without decoded messages
+
+	uint32_t size;            // Of the record, header and padded body, the distance to the next one
+	uint16_t templateId;      // MessageTraits<T>::templateId of the body, after any schema upgrade
+	uint16_t channel;         // UDP or TCP destination port the packet came in on
+	uint64_t captureTime;     // Nanoseconds since the Unix epoch, from the pcap record
+	uint64_t sendingTime;
+	uint64_t transactTime;    // Of the incremental header, 0 without one
+	uint32_t msgSeqNum;
+	uint32_t exchangeTradingSessionID;
+	uint32_t bodySize;        // Before padding
+	uint16_t msgFlags;
+	uint16_t msgSize;
+	MessageHeader messageHeader; // Of the packet, as SIMBAPacket keeps it
+	uint16_t index;           // Of the message in its packet, 0 starts a packet
+	uint16_t flags;
+	uint32_t reserved;
+};
+static_assert(sizeof(EventRecordHeader) == 64, "EventRecordHeader size is incorrect");
+
+// Writes every message of the packets it is given as a record of the log
+class EventLogSink : public PacketSink
+{
+public:
+	explicit EventLogSink(const std::string& outputFilePath, const CompressionOptions& compression = {});
+	~EventLogSink() override;
+
+	void onPacket(const SIMBAPacket& packet) override;
+
+private:
+	static constexpr size_t FLUSH_SIZE = 4 * 1024 * 1024;
+
+	AsyncFileWriter outputFile;
+	std::vector<std::byte> buffer;
+};
+
+// Maps an event log and walks its records in place
+class EventLogReader
+{
+public:
+	struct Event
+	{
+		const EventRecordHeader* header;
+		std::span<const std::byte> body;
+
+		// The message of an inline template, read from the mapping without a copy
+		template<typename T>
+		const T& message() const
+		{
+			if (header->templateId != MessageTraits<T>::templateId || body.size() != sizeof(T)) {
+				throw std::runtime_error("Event is read as the wrong message type.");
+			}
+			return *std::launder(reinterpret_cast<const T*>(body.data())); // Schema structs are packed
+		}
+	};
+
+	class Iterator
+	{
+	public:
+		Iterator(const std::byte* position) : position(position) {}
+
+		Event operator*() const
+		{
+			const EventRecordHeader* header = reinterpret_cast<const EventRecordHeader*>(position);
+			return Event{ header, std::span<const std::byte>(position + sizeof(EventRecordHeader), header->bodySize) };
+		}
+		Iterator& operator++()
+		{
+			position += reinterpret_cast<const EventRecordHeader*>(position)->size;
+			return *this;
+		}
+		bool operator==(const Iterator& other) const noexcept { return position == other.position; }
+
+	private:
+		const std::byte* position;
+	};
+
+	// Checks every record's size on opening, so iterating needs no checks
+	explicit EventLogReader(const std::string& filePath);
+
+	Iterator begin() const noexcept { return Iterator(records.data()); }
+	Iterator end() const noexcept { return Iterator(records.data() + records.size()); }
+
+	// Rebuilds the packets of the log and hands them to sink, with only the templates selected. Var
+	// data points into the mapping. Returns the number of packets
+	uint64_t replay(PacketSink& sink, const TemplateFilter& templates) const;
+
+private:
+	IOMapper mapper;
+	std::unique_ptr<MemoryMappedChunk> mapping;
+	std::span<const std::byte> records;
+};
@@ -0,0 +1,343 @@
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Field_Projection.hpp"
+#include "SIMBA_JSON.hpp"
+
+namespace
+{
+    using Formatter = FieldProjection::Formatter;
+
+    // A field copied out of the packed message and written as the full JSON output writes it
+    template<typename T>
+    void value(JSONWriter& out, const std::byte* field)
+    {
+        T copy;
+        std::memcpy(&copy, field, sizeof(T));
+        writeJSON(out, copy);
+    }
+
+    // Enums whose names the full output puts in quotes around writeJSON
+    template<typename T>
+    void quoted(JSONWriter& out, const std::byte* field)
+    {
+        out.append('"');
+        value<T>(out, field);
+        out.append('"');
+    }
+
+    template<size_t N>
+    void chars(JSONWriter& out, const std::byte* field)
+    {
+        out.append('"');
+        out.trimmed(reinterpret_cast<const char*>(field), N);
+        out.append('"');
+    }
+
+    // Zero is null, as for the optional times of TradingSessionStatus
+    void nullable(JSONWriter& out, const std::byte* field)
+    {
+        uint64_t copy;
+        std::memcpy(&copy, field, sizeof(copy));
+        if (copy != 0)
+            out.integer(copy);
+        else
+            out.append("null");
+    }
+
+    void character(JSONWriter& out, const std::byte* field)
+    {
+        out.append('"');
+        out.escaped(reinterpret_cast<const char*>(field), 1);
+        out.append('"');
+    }
+
+    template<typename T>
+    constexpr Formatter formatterFor()
+    {
+        if constexpr (std::is_array_v<T>)
+            return chars<std::extent_v<T>>;
+        else if constexpr (std::is_same_v<T, MDEntryType> || std::is_same_v<T, SecurityTradingStatus> || std::is_same_v<T, SecurityAltIDSource>
+            || std::is_same_v<T, MarketSegmentID> || std::is_same_v<T, TradingSessionID> || std::is_same_v<T, NegativePrices>)
+            return quoted<T>;
+        else
+            return value<T>;
+    }
+
+    // Repeating groups and var data, written whole from the message the root block belongs to
+    template<typename Message, typename Block>
+    const Message& message(const std::byte* block)
+    {
+        return static_cast<const Message&>(*reinterpret_cast<const Block*>(block));
+    }
+
+    void snapshotEntries(JSONWriter& out, const std::byte* block)
+    {
+        const OrderBookSnapshot& snapshot = message<OrderBookSnapshot, OrderBookSnapshotBlock>(block);
+        writeJSON(out, snapshot.MDEntries, snapshot.MDEntries ? snapshot.MDEntries->size() : 0);
+    }
+
+    void bestPricesEntries(JSONWriter& out, const std::byte* block)
+    {
+        writeJSON(out, reinterpret_cast<const BestPrices*>(block)->MDEntries);
+    }
+
+    void massStatusEntries(JSONWriter& out, const std::byte* block)
+    {
+        writeJSON(out, reinterpret_cast<const SecurityMassStatus*>(block)->Entries);
+    }
+
+    template<auto Entries, auto Size>
+    void definitionGroup(JSONWriter& out, const std::byte* block)
+    {
+        const SecurityDefinition& definition = message<SecurityDefinition, SecurityDefinitionBlock>(block);
+        writeJSON(out, definition.*Entries, (definition.*Size).numInGroup);
+    }
+
+    template<auto Text>
+    void definitionText(JSONWriter& out, const std::byte* block)
+    {
+        writeJSON(out, message<SecurityDefinition, SecurityDefinitionBlock>(block).*Text);
+    }
+
+    struct KnownField
+    {
+        std::string_view name;
+        size_t offset;
+        Formatter write;
+    };
+
+    struct KnownTemplate
+    {
+        std::string_view name;
+        uint16_t templateId;
+        std::span<const KnownField> fields;
+    };
+
+// Offsets are taken from the root block of OrderBookSnapshot and SecurityDefinition
+#define FIELD(Type, member, name) KnownField{ name, offsetof(Type, member), formatterFor<decltype(Type::member)>() }
+
+    constexpr KnownField SEQUENCE_RESET_FIELDS[] = {
+        FIELD(SequenceReset, NewSeqNo, "NewSeqNo") };
+
+    constexpr KnownField BEST_PRICES_FIELDS[] = {
+        { "NoMDEntries", 0, bestPricesEntries } };
+
+    constexpr KnownField EMPTY_BOOK_FIELDS[] = {
+        FIELD(EmptyBook, LastMsgSeqNumProcessed, "LastMsgSeqNumProcessed") };
+
+    constexpr KnownField SECURITY_STATUS_FIELDS[] = {
+        FIELD(SecurityStatus, SecurityID, "SecurityID"),
+        FIELD(SecurityStatus, Symbol, "Symbol"),
+        FIELD(SecurityStatus, securityTradingStatus, "SecurityTradingStatus"),
+        FIELD(SecurityStatus, HighLimitPx, "HighLimitPx"),
+        FIELD(SecurityStatus, LowLimitPx, "LowLimitPx"),
+        FIELD(SecurityStatus, InitialMarginOnBuy, "InitialMarginOnBuy"),
+        FIELD(SecurityStatus, InitialMarginOnSell, "InitialMarginOnSell"),
+        FIELD(SecurityStatus, InitialMarginSyntetic, "InitialMarginSyntetic") };
+
+    constexpr KnownField SECURITY_DEFINITION_UPDATE_REPORT_FIELDS[] = {
+        FIELD(SecurityDefinitionUpdateReport, SecurityID, "SecurityID"),
+        FIELD(SecurityDefinitionUpdateReport, Volatility, "Volatility"),
+        FIELD(SecurityDefinitionUpdateReport, TheorPrice, "TheorPrice"),
+        FIELD(SecurityDefinitionUpdateReport, TheorPriceLimit, "TheorPriceLimit") };
+
+    constexpr KnownField TRADING_SESSION_STATUS_FIELDS[] = {
+        FIELD(TradingSessionStatus, TradSesOpenTime, "TradSesOpenTime"),
+        FIELD(TradingSessionStatus, TradSesCloseTime, "TradSesCloseTime"),
+        { "TradSesIntermClearingStartTime", offsetof(TradingSessionStatus, TradSesIntermClearingStartTime), nullable },
+        { "TradSesIntermClearingEndTime", offsetof(TradingSessionStatus, TradSesIntermClearingEndTime), nullable },
+        FIELD(TradingSessionStatus, TradingSessionID, "TradingSessionID"),
+        { "ExchangeTradingSessionID", offsetof(TradingSessionStatus, ExchangeTradingSessionID), nullable },
+        FIELD(TradingSessionStatus, TradSesStatus, "TradSesStatus"),
+        { "MarketSegmentID", offsetof(TradingSessionStatus, MarketSegmentID), character },
+        FIELD(TradingSessionStatus, TradSesEvent, "TradSesEvent") };
+
+    constexpr KnownField ORDER_UPDATE_FIELDS[] = {
+        FIELD(OrderUpdate, MDEntryID, "MDEntryID"),
+        FIELD(OrderUpdate, MDEntryPx, "MDEntryPx"),
+        FIELD(OrderUpdate, MDEntrySize, "MDEntrySize"),
+        FIELD(OrderUpdate, MDFlags, "MDFlags"),
+        FIELD(OrderUpdate, MDFlags2, "MDFlags2"),
+        FIELD(OrderUpdate, SecurityID, "SecurityID"),
+        FIELD(OrderUpdate, RptSeq, "RptSeq"),
+        FIELD(OrderUpdate, mdUpdateAction, "MDUpdateAction"),
+        FIELD(OrderUpdate, mdEntryType, "MDEntryType") };
+
+    constexpr KnownField ORDER_EXECUTION_FIELDS[] = {
+        FIELD(OrderExecution, MDEntryID, "MDEntryID"),
+        FIELD(OrderExecution, MDEntryPx, "MDEntryPx"),
+        FIELD(OrderExecution, MDEntrySize, "MDEntrySize"),
+        FIELD(OrderExecution, LastPx, "LastPx"),
+        FIELD(OrderExecution, LastQty, "LastQty"),
+        FIELD(OrderExecution, TradeID, "TradeID"),
+        FIELD(OrderExecution, MDFlags, "MDFlags"),
+        FIELD(OrderExecution, MDFlags2, "MDFlags2"),
+        FIELD(OrderExecution, SecurityID, "SecurityID"),
+        FIELD(OrderExecution, RptSeq, "RptSeq"),
+        FIELD(OrderExecution, mdUpdateAction, "MDUpdateAction"),
+        FIELD(OrderExecution, mdEntryType, "MDEntryType") };
+
+    constexpr KnownField ORDER_BOOK_SNAPSHOT_FIELDS[] = {
+        FIELD(OrderBookSnapshotBlock, SecurityID, "SecurityID"),
+        FIELD(OrderBookSnapshotBlock, LastMsgSeqNumProcessed, "LastMsgSeqNumProcessed"),
+        FIELD(OrderBookSnapshotBlock, RptSeq, "RptSeq"),
+        FIELD(OrderBookSnapshotBlock, ExchangeTradingSessionID, "ExchangeTradingSessionID"),
+        { "NoMDEntries", 0, snapshotEntries } };
+
+    constexpr KnownField SECURITY_DEFINITION_FIELDS[] = {
+        FIELD(SecurityDefinitionBlock, TotNumReports, "TotNumReports"),
+        FIELD(SecurityDefinitionBlock, Symbol, "Symbol"),
+        FIELD(SecurityDefinitionBlock, SecurityID, "SecurityID"),
+        FIELD(SecurityDefinitionBlock, SecurityAltID, "SecurityAltID"),
+        FIELD(SecurityDefinitionBlock, securityAltIDSource, "SecurityAltIDSource"),
+        FIELD(SecurityDefinitionBlock, SecurityType, "SecurityType"),
+        FIELD(SecurityDefinitionBlock, CFICode, "CFICode"),
+        FIELD(SecurityDefinitionBlock, StrikePrice, "StrikePrice"),
+        FIELD(SecurityDefinitionBlock, ContractMultiplier, "ContractMultiplier"),
+        FIELD(SecurityDefinitionBlock, securityTradingStatus, "SecurityTradingStatus"),
+        FIELD(SecurityDefinitionBlock, Currency, "Currency"),
+        FIELD(SecurityDefinitionBlock, marketSegmentID, "MarketSegmentID"),
+        FIELD(SecurityDefinitionBlock, tradingSessionID, "TradingSessionID"),
+        FIELD(SecurityDefinitionBlock, ExchangeTradingSessionID, "ExchangeTradingSessionID"),
+        FIELD(SecurityDefinitionBlock, Volatility, "Volatility"),
+        FIELD(SecurityDefinitionBlock, HighLimitPx, "HighLimitPx"),
+        FIELD(SecurityDefinitionBlock, LowLimitPx, "LowLimitPx"),
+        FIELD(SecurityDefinitionBlock, MinPriceIncrement, "MinPriceIncrement"),
+        FIELD(SecurityDefinitionBlock, MinPriceIncrementAmount, "MinPriceIncrementAmount"),
+        FIELD(SecurityDefinitionBlock, InitialMarginOnBuy, "InitialMarginOnBuy"),
+        FIELD(SecurityDefinitionBlock, InitialMarginOnSell, "InitialMarginOnSell"),
+        FIELD(SecurityDefinitionBlock, InitialMarginSyntetic, "InitialMarginSyntetic"),
+        FIELD(SecurityDefinitionBlock, TheorPrice, "TheorPrice"),
+        FIELD(SecurityDefinitionBlock, TheorPriceLimit, "TheorPriceLimit"),
+        FIELD(SecurityDefinitionBlock, UnderlyingQty, "UnderlyingQty"),
+        FIELD(SecurityDefinitionBlock, UnderlyingCurrency, "UnderlyingCurrency"),
+        FIELD(SecurityDefinitionBlock, MaturityDate, "MaturityDate"),
+        FIELD(SecurityDefinitionBlock, MaturityTime, "MaturityTime"),
+        FIELD(SecurityDefinitionBlock, Flags, "Flags"),
+        FIELD(SecurityDefinitionBlock, MinPriceIncrementAmountCurr, "MinPriceIncrementAmountCurr"),
+        FIELD(SecurityDefinitionBlock, SettlPriceOpen, "SettlPriceOpen"),
+        FIELD(SecurityDefinitionBlock, ValuationMethod, "ValuationMethod"),
+        FIELD(SecurityDefinitionBlock, RiskFreeRate, "RiskFreeRate"),
+        FIELD(SecurityDefinitionBlock, FixedSpotDiscount, "FixedSpotDiscount"),
+        FIELD(SecurityDefinitionBlock, ProjectedSpotDiscount, "ProjectedSpotDiscount"),
+        FIELD(SecurityDefinitionBlock, SettlCurrency, "SettlCurrency"),
+        FIELD(SecurityDefinitionBlock, negativePrices, "NegativePrices"),
+        FIELD(SecurityDefinitionBlock, DerivativeContractMultiplier, "DerivativeContractMultiplier"),
+        FIELD(SecurityDefinitionBlock, InterestRateRiskUp, "InterestRateRiskUp"),
+        FIELD(SecurityDefinitionBlock, InterestRateRiskDown, "InterestRateRiskDown"),
+        FIELD(SecurityDefinitionBlock, RiskFreeRate2, "RiskFreeRate2"),
+        FIELD(SecurityDefinitionBlock, InterestRate2RiskUp, "InterestRate2RiskUp"),
+        FIELD(SecurityDefinitionBlock, InterestRate2RiskDown, "InterestRate2RiskDown"),
+        FIELD(SecurityDefinitionBlock, SettlPrice, "SettlPrice"),
+        { "NoMDFeedTypes", 0, definitionGroup<&SecurityDefinition::MDFeedTypesEntries, &SecurityDefinition::NoMDFeedTypes> },
+        { "NoUnderlyings", 0, definitionGroup<&SecurityDefinition::UnderlyingsEntries, &SecurityDefinition::NoUnderlyings> },
+        { "NoLegs", 0, definitionGroup<&SecurityDefinition::LegsEntries, &SecurityDefinition::NoLegs> },
+        { "NoInstrAttrib", 0, definitionGroup<&SecurityDefinition::InstrAttribEntries, &SecurityDefinition::NoInstrAttrib> },
+        { "NoEvents", 0, definitionGroup<&SecurityDefinition::EventsEntries, &SecurityDefinition::NoEvents> },
+        { "SecurityDesc", 0, definitionText<&SecurityDefinition::SecurityDesc> },
+        { "QuotationList", 0, definitionText<&SecurityDefinition::QuotationList> } };
+
+    constexpr KnownField SECURITY_MASS_STATUS_FIELDS[] = {
+        { "NoRelatedSym", 0, massStatusEntries } };
+
+    constexpr KnownField LOGOUT_FIELDS[] = {
+        FIELD(Logout, Text, "Text") };
+
+    constexpr KnownField MARKET_DATA_REQUEST_FIELDS[] = {
+        FIELD(MarketDataRequest, ApplBegSeqNum, "ApplBegSeqNum"),
+        FIELD(MarketDataRequest, ApplEndSeqNum, "ApplEndSeqNum") };
+
+#undef FIELD
+
+    template<typename Message>
+    constexpr KnownTemplate known(std::span<const KnownField> fields)
+    {
+        return KnownTemplate{ MessageTraits<Message>::name, MessageTraits<Message>::templateId, fields };
+    }
+
+    // Heartbeat and Logon have no fields to select
+    constexpr KnownTemplate KNOWN_TEMPLATES[] = {
+        known<SequenceReset>(SEQUENCE_RESET_FIELDS),
+        known<BestPrices>(BEST_PRICES_FIELDS),
+        known<EmptyBook>(EMPTY_BOOK_FIELDS),
+        known<SecurityStatus>(SECURITY_STATUS_FIELDS),
+        known<SecurityDefinitionUpdateReport>(SECURITY_DEFINITION_UPDATE_REPORT_FIELDS),
+        known<TradingSessionStatus>(TRADING_SESSION_STATUS_FIELDS),
+        known<OrderUpdate>(ORDER_UPDATE_FIELDS),
+        known<OrderExecution>(ORDER_EXECUTION_FIELDS),
+        known<OrderBookSnapshot>(ORDER_BOOK_SNAPSHOT_FIELDS),
+        known<SecurityDefinition>(SECURITY_DEFINITION_FIELDS),
+        known<SecurityMassStatus>(SECURITY_MASS_STATUS_FIELDS),
+        known<Logout>(LOGOUT_FIELDS),
+        known<MarketDataRequest>(MARKET_DATA_REQUEST_FIELDS) };
+}
+
+FieldProjection FieldProjection::parse(const std::string& fieldList)
+{
+    FieldProjection projection;
+
+    std::string_view remaining(fieldList);
+    while (!remaining.empty())
+    {
+        const size_t comma = remaining.find(',');
+        const std::string_view token = remaining.substr(0, comma);
+
+        const size_t dot = token.find('.');
+        if (dot == std::string_view::npos)
+            throw std::runtime_error("Invalid field, expected Template.Field: " + std::string(token));
+        projection.add(token.substr(0, dot), token.substr(dot + 1));
+
+        if (comma == std::string_view::npos)
+            break;
+        remaining.remove_prefix(comma + 1);
+    }
+
+    return projection;
+}
+
+void FieldProjection::add(std::string_view templateName, std::string_view fieldName)
+{
+    for (const KnownTemplate& known : KNOWN_TEMPLATES)
+    {
+        if (known.name != templateName)
+            continue;
+
+        for (const KnownField& field : known.fields)
+        {
+            if (field.name != fieldName)
+                continue;
+
+            if (plans.size() <= known.templateId)
+                plans.resize(known.templateId + 1);
+            Plan& plan = plans[known.templateId];
+            if (plan.prefix.empty())
+                plan.prefix = "{\"Name\":\"" + std::string(known.name) + "\"";
+
+            std::string key = ",\"" + std::string(field.name) + "\":";
+            for (const Field& selected : plan.fields)
+            {
+                if (selected.key == key)
+                    return; // Selected twice, written once
+            }
+            plan.fields.push_back(Field{ std::move(key), field.offset, field.write });
+            return;
+        }
+        throw std::runtime_error("Unknown field of " + std::string(templateName) + ": " + std::string(fieldName));
+    }
+    throw std::runtime_error("Unknown template: " + std::string(templateName));
+}
+
+TemplateFilter FieldProjection::templates() const
+{
+    TemplateFilter filter;
+    for (size_t templateId = 0; templateId < plans.size(); ++templateId)
+    {
+        if (!plans[templateId].fields.empty())
+            filter.addMessage(static_cast<uint16_t>(templateId)); // With the older schema versions' IDs of the template
+    }
+    return filter;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "JSON_Writer.hpp"
+#include "SIMBA_Decoder.hpp"
+#include "SIMBA_Messages.hpp"
+
+// Selection of the fields written for each template, such as "OrderUpdate.SecurityID,OrderUpdate.MDEntryPx".
+// It is compiled once into a plan per template, the key text, offset and formatter of every selected field
+// in the order given, so writing a message is a loop over its plan with no lookup by name. Templates
+// without a plan are written whole
+class FieldProjection
+{
+public:
+	// Writes the field at offset from the message's root block
+	using Formatter = void (*)(JSONWriter& out, const std::byte* field);
+
+	struct Field
+	{
+		std::string key; // ,"Name": ready to append
+		size_t offset;   // From the root block, 0 for a repeating group, whose formatter takes the block
+		Formatter write;
+	};
+
+	FieldProjection() = default; // An empty projection writes every field
+
+	// Builds a projection from a comma separated list of Template.Field names
+	static FieldProjection parse(const std::string& fieldList);
+
+	// Adds a field by the names JSON output uses for its template and key
+	void add(std::string_view templateName, std::string_view fieldName);
+
+	bool empty() const noexcept { return plans.empty(); }
+
+	// The templates with a plan, the only ones worth decoding unless others are asked for
+	TemplateFilter templates() const;
+
+	// Writes the selected fields of the message as one object, false if its template has no plan
+	template<typename Message>
+	bool write(JSONWriter& out, const Message& message) const
+	{
+		constexpr uint16_t templateId = MessageTraits<Message>::templateId;
+		if (templateId >= plans.size() || plans[templateId].fields.empty())
+			return false;
+
+		const Plan& plan = plans[templateId];
+		const std::byte* block = rootBlock(message);
+		out.append(plan.prefix);
+		for (const Field& field : plan.fields)
+		{
+			out.append(field.key);
+			field.write(out, block + field.offset);
+		}
+		out.append('}');
+		return true;
+	}
+
+private:
+	struct Plan
+	{
+		std::string prefix; // {"Name":"<Template>"
+		std::vector<Field> fields;
+	};
+
+	// Offsets of the templates with a copied root block are from that block
+	template<typename Message>
+	static const std::byte* rootBlock(const Message& message) noexcept { return reinterpret_cast<const std::byte*>(&message); }
+	static const std::byte* rootBlock(const OrderBookSnapshot& message) noexcept
+	{
+		return reinterpret_cast<const std::byte*>(static_cast<const OrderBookSnapshotBlock*>(&message));
+	}
+	static const std::byte* rootBlock(const SecurityDefinition& message) noexcept
+	{
+		return reinterpret_cast<const std::byte*>(static_cast<const SecurityDefinitionBlock*>(&message));
+	}
+
+	std::vector<Plan> plans; // By template ID
+};
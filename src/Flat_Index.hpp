@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Finalizer from splitmix64, spreads sequential IDs across the whole table
+inline uint64_t mixHash(uint64_t value) noexcept
+{
+	value ^= value >> 30;
+	value *= 0xbf58476d1ce4e5b9ULL;
+	value ^= value >> 27;
+	value *= 0x94d049bb133111ebULL;
+	value ^= value >> 31;
+	return value;
+}
+
+// Open addressing map from a small trivially copyable key to a uint32_t index into some pool.
+// Linear probing over a power of two table kept at most half full, erase shifts the following
+// entries back so lookups never have to step over tombstones. Only grows when the load limit is hit
+template<typename Key, typename Hash>
+class FlatIndex
+{
+public:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	explicit FlatIndex(size_t expectedSize = 1024)
+	{
+		size_t capacity = 16;
+		while (capacity < expectedSize * 2)
+			capacity <<= 1;
+		slots.assign(capacity, Slot{ Key{}, NONE });
+		mask = capacity - 1;
+	}
+
+	uint32_t find(const Key& key) const noexcept
+	{
+		for (size_t slot = Hash{}(key) & mask;; slot = (slot + 1) & mask)
+		{
+			const Slot& entry = slots[slot];
+			if (entry.value == NONE)
+				return NONE;
+			if (entry.key == key)
+				return entry.value;
+		}
+	}
+
+	// The key must not already be present
+	void insert(const Key& key, uint32_t value)
+	{
+		if ((used + 1) * 2 > slots.size()) [[unlikely]]
+			grow();
+
+		size_t slot = Hash{}(key) & mask;
+		while (slots[slot].value != NONE)
+			slot = (slot + 1) & mask;
+
+		slots[slot] = Slot{ key, value };
+		++used;
+	}
+
+	void erase(const Key& key) noexcept
+	{
+		size_t slot = Hash{}(key) & mask;
+		while (true)
+		{
+			if (slots[slot].value == NONE)
+				return;
+			if (slots[slot].key == key)
+				break;
+			slot = (slot + 1) & mask;
+		}
+
+		// Backward shift: pull every following entry of the probe run into the hole if its home slot allows it
+		size_t hole = slot;
+		for (size_t next = (hole + 1) & mask; slots[next].value != NONE; next = (next + 1) & mask)
+		{
+			const size_t home = Hash{}(slots[next].key) & mask;
+			if (((next - home) & mask) >= ((next - hole) & mask))
+			{
+				slots[hole] = slots[next];
+				hole = next;
+			}
+		}
+		slots[hole].value = NONE;
+		--used;
+	}
+
+	void clear() noexcept
+	{
+		for (Slot& slot : slots)
+			slot.value = NONE;
+		used = 0;
+	}
+
+	size_t size() const noexcept { return used; }
+
+	template<typename Function>
+	void forEach(Function&& function) const
+	{
+		for (const Slot& slot : slots)
+			if (slot.value != NONE)
+				function(slot.key, slot.value);
+	}
+
+private:
+	struct Slot
+	{
+		Key key;
+		uint32_t value;
+	};
+
+	void grow()
+	{
+		std::vector<Slot> previous(slots.size() * 2, Slot{ Key{}, NONE });
+		previous.swap(slots);
+		mask = slots.size() - 1;
+		used = 0;
+
+		for (const Slot& slot : previous)
+			if (slot.value != NONE)
+				insert(slot.key, slot.value);
+	}
+
+	std::vector<Slot> slots;
+	size_t mask = 0;
+	size_t used = 0;
+};
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include "Frame_Decoder.hpp"
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #pragma comment(lib, "Ws2_32.lib")
+#else
+    #include <netinet/in.h>
+#endif
+
+void FrameDecoder::onFrame(uint32_t linkType, std::span<const char> frame, uint64_t captureTime)
+{
+    if (decode(linkType, frame, captureTime, simbaPacket))
+        sink->onPacket(simbaPacket);
+}
+
+bool FrameDecoder::decode(uint32_t linkType, std::span<const char> frame, uint64_t captureTime, SIMBAPacket& packet)
+{
+    std::span<const char> payload;
+    uint16_t port = 0;
+    switch (linkType) {
+    case 1: // Ethernet
+        if (!ethernetPayload(frame, payload, port))
+            return false;
+        break;
+    case 105: // IEEE 802.11 Wireless LAN
+        return false;
+    case 101: // Raw IP
+        return false;
+    default:  // Unsupported data link type
+        return false;
+    }
+
+    SIMBADecoder decoder(payload, &templates);
+    decoder.decode(packet);
+    packet.captureTime = captureTime;
+    packet.channel = port;
+    if (packet.marketDataHeader.incremental() && packet.marketDataHeader.MsgSeqNum > lastIncrementalSeqNum)
+        lastIncrementalSeqNum = packet.marketDataHeader.MsgSeqNum;
+
+    // Nothing selected in this packet, don't emit its headers either
+    return templates.decodesAll() || !packet.messages.empty();
+}
+
+bool FrameDecoder::ethernetPayload(std::span<const char> frame, std::span<const char>& payload, uint16_t& port)
+{
+    if (frame.size() < sizeof(EthernetHeader)) {
+        throw std::runtime_error("Packet too short for Ethernet header");
+    }
+
+    // Parse Ethernet header
+    const EthernetHeader* ethHeader = reinterpret_cast<const EthernetHeader*>(frame.data());
+    if (ntohs(ethHeader->etherType) != 0x0800) {
+        return false; // Not IPv4
+    }
+
+    // Move to the IPv4 header
+    const size_t ethernetHeaderLength = sizeof(EthernetHeader);
+    if (frame.size() < ethernetHeaderLength + sizeof(IPv4Header)) {
+        throw std::runtime_error("Packet too short for IPv4 header");
+    }
+
+    const IPv4Header* ipHeader = reinterpret_cast<const IPv4Header*>(frame.data() + ethernetHeaderLength);
+    const size_t ipHeaderLength = (ipHeader->versionAndHeaderLength & 0x0F) * 4; // Options included
+    if (ipHeaderLength < sizeof(IPv4Header)) {
+        throw std::runtime_error("Invalid IPv4 header length");
+    }
+    const size_t transportOffset = ethernetHeaderLength + ipHeaderLength;
+
+    if (ipHeader->protocol == 1)  // ICMP
+    {
+        std::cout << "ICMP (Internet Control Message Protocol) not implemented\n";
+    }
+    else if (ipHeader->protocol == 2)  // IGMP
+    {
+        std::cout << "IGMP (Internet Group Management Protocol) not implemented\n";
+    }
+    else if (ipHeader->protocol == 6) [[likely]]  // TCP
+    {
+        if (frame.size() < transportOffset + sizeof(TCPHeader)) {
+            throw std::runtime_error("Packet too short for TCP header");
+        }
+        auto tcpHeader = reinterpret_cast<const TCPHeader*>(frame.data() + transportOffset);
+        size_t tcpHeaderLength = (tcpHeader->dataOffset >> 4) * 4;
+        if (frame.size() < transportOffset + tcpHeaderLength) {
+            throw std::runtime_error("Packet too short for TCP options");
+        }
+
+        // Pass the payload on to the SIMBA protocol
+        payload = frame.subspan(transportOffset + tcpHeaderLength);
+        port = ntohs(tcpHeader->destPort);
+        return true;
+    }
+    else if (ipHeader->protocol == 8)  // EGP
+    {
+        std::cout << "EGP (Exterior Gateway Protocol) not implemented\n";
+    }
+    else if (ipHeader->protocol == 17) [[likely]]  // UDP
+    {
+        const size_t udpHeaderLength = sizeof(UDPHeader);
+        if (frame.size() < transportOffset + udpHeaderLength) {
+            throw std::runtime_error("Packet too short for UDP header");
+        }
+        auto udpHeader = reinterpret_cast<const UDPHeader*>(frame.data() + transportOffset);
+
+        // The datagram's own length leaves out any Ethernet padding, a frame cut short by the snaplen
+        // still has what was captured of it decoded
+        const size_t udpLength = std::min<size_t>(ntohs(udpHeader->length), frame.size() - transportOffset);
+        if (udpLength < udpHeaderLength) {
+            throw std::runtime_error("Invalid UDP length");
+        }
+
+        // Pass the payload on to the SIMBA protocol
+        payload = frame.subspan(transportOffset + udpHeaderLength, udpLength - udpHeaderLength);
+        port = ntohs(udpHeader->destinationPort);
+        return true;
+    }
+    else if (ipHeader->protocol == 41)  // IPv6
+    {
+        std::cout << "IPv6 (IPv6 encapsulated in IPv4) not implemented\n";
+    }
+    else if (ipHeader->protocol == 50)  // ESP
+    {
+        std::cout << "ESP (Encapsulating Security Payload) not implemented\n";
+    }
+    else if (ipHeader->protocol == 51)  // AH
+    {
+        std::cout << "AH (Authentication Header) not implemented\n";
+    }
+    else if (ipHeader->protocol == 58)  // ICMPv6
+    {
+        std::cout << "ICMPv6 (ICMP for IPv6) not implemented\n";
+    }
+    else if (ipHeader->protocol == 88)  // EIGRP
+    {
+        std::cout << "EIGRP (Enhanced Interior Gateway Routing Protocol) not implemented\n";
+    }
+    else if (ipHeader->protocol == 89)  // OSPF
+    {
+        std::cout << "OSPF (Open Shortest Path First) not implemented\n";
+    }
+    else if (ipHeader->protocol == 132)  // SCTP
+    {
+        std::cout << "SCTP (Stream Control Transmission Protocol) not implemented\n";
+    }
+    else  // Default case
+    {
+        std::cout << "Unknown Protocol\n";
+    }
+    return false;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "PCAP_Schema.hpp"
+#include "Packet_Sink.hpp"
+#include "SIMBA_Decoder.hpp"
+
+// Unwraps the link, IPv4 and UDP or TCP layers of a captured frame and decodes the SIMBA packet
+// inside, handing it to the sink. One decoder per thread, it owns the packet object the sink is given
+class FrameDecoder
+{
+public:
+	FrameDecoder(const TemplateFilter& templates, PacketSink& sink) : templates(templates), sink(&sink) {}
+	explicit FrameDecoder(const TemplateFilter& templates) : templates(templates) {} // Only decodes
+
+	// One pcap record, linkType being the network field of the capture's global header and captureTime
+	// the record's timestamp in nanoseconds
+	void onFrame(uint32_t linkType, std::span<const char> frame, uint64_t captureTime);
+
+	// Decodes a record into packet, false if there is nothing to hand on: no SIMBA payload, or none
+	// of the selected templates in it
+	bool decode(uint32_t linkType, std::span<const char> frame, uint64_t captureTime, SIMBAPacket& packet);
+
+	// Last packet decoded
+	const SIMBAPacket& packet() const noexcept { return simbaPacket; }
+
+	// Highest MsgSeqNum seen on the incremental feed
+	uint32_t lastMsgSeqNum() const noexcept { return lastIncrementalSeqNum; }
+	void setLastMsgSeqNum(uint32_t seqNum) noexcept { lastIncrementalSeqNum = seqNum; }
+
+private:
+	static bool ethernetPayload(std::span<const char> frame, std::span<const char>& payload, uint16_t& port);
+
+	const TemplateFilter& templates;
+	PacketSink* sink = nullptr;
+	SIMBAPacket simbaPacket; // Reused for every packet so message storage is allocated once
+	uint32_t lastIncrementalSeqNum = 0;
+};
@@ -5,7 +5,21 @@
 
 IOMapper::IOMapper(const std::string& filePath, size_t chunkSize)
     : filePath(filePath), chunkSize(chunkSize), currentOffset(0) {
-    fileSize = getFileSize();
+    fileSize = readFileSize();
+}
+
+IOMapper::~IOMapper() {
+#ifdef _WIN32
+    if (fileMapping) CloseHandle(fileMapping);
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+#else
+    if (fd >= 0) close(fd);
+#endif
+}
+
+size_t IOMapper::seek(size_t offset) {
+    currentOffset = offset & ~(MAP_ALIGNMENT - 1);
+    return offset - currentOffset;
 }
 
 bool IOMapper::fetchNextChunk(const char*& chunkData, size_t& chunkSizeOut) {
@@ -53,7 +67,7 @@ void* IOMapper::mapFile(size_t offset, size_t size) {
 #endif
 }
 
-size_t IOMapper::getFileSize() {
+size_t IOMapper::readFileSize() {
 #ifdef _WIN32
     LARGE_INTEGER size;
     HANDLE handle = CreateFile(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
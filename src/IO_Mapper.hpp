@@ -43,13 +43,25 @@ private:
 class IOMapper {
 public:
 	IOMapper(const std::string& filePath, size_t chunkSize = 128 * 1024 * 1024);
+	~IOMapper();
+
+	IOMapper(const IOMapper&) = delete;
+	IOMapper& operator=(const IOMapper&) = delete;
 
 	// Fetch the next chunk
 	bool fetchNextChunk(const char*& chunkData, size_t& chunkSize);
+
+	// Continue with the chunk holding offset. Mappings start on a multiple of the allocation granularity,
+	// the returned number of bytes at the start of the next chunk come before offset
+	size_t seek(size_t offset);
+
+	size_t getFileSize() const { return fileSize; }
 	
 	size_t getChunkSize() const { return chunkSize; }
 
 private:
+	static constexpr size_t MAP_ALIGNMENT = 64 * 1024; // Windows allocation granularity, a multiple of the page size elsewhere
+
 	std::string filePath;
 	size_t chunkSize;
 	size_t fileSize;
@@ -63,5 +75,5 @@ private:
 #endif
 
 	void* mapFile(size_t offset, size_t size);
-	size_t getFileSize();
+	size_t readFileSize();
 };
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Instrument_Directory.hpp"
+
+uint32_t InstrumentDirectory::insert(int32_t securityId)
+{
+    const uint32_t key = static_cast<uint32_t>(securityId);
+    const size_t page = key >> PAGE_BITS;
+    if (page >= pages.size())
+        pages.resize(page + 1);
+    if (!pages[page])
+    {
+        pages[page] = std::make_unique<uint32_t[]>(PAGE_MASK + 1);
+        std::fill_n(pages[page].get(), PAGE_MASK + 1, NONE);
+    }
+
+    const uint32_t index = static_cast<uint32_t>(securityIds.size());
+    pages[page][key & PAGE_MASK] = index;
+
+    securityIds.push_back(securityId);
+    definedFlags.push_back(0);
+    symbols.push_back({});
+    minPriceIncrements.push_back(Decimal5NULL::NULL_VALUE);
+    contractMultipliers.push_back(0);
+    maturityDates.push_back(0);
+    volatilities.push_back(Decimal5NULL::NULL_VALUE);
+    theorPrices.push_back(Decimal5NULL::NULL_VALUE);
+    return index;
+}
+
+void InstrumentDirectory::onDefinition(const SecurityDefinitionBlock& definition)
+{
+    const uint32_t index = add(definition.SecurityID);
+
+    definedFlags[index] = 1;
+    std::memcpy(symbols[index].data(), definition.Symbol, sizeof(definition.Symbol));
+    minPriceIncrements[index] = definition.MinPriceIncrement.mantissa;
+    contractMultipliers[index] = definition.ContractMultiplier;
+    maturityDates[index] = definition.MaturityDate;
+    volatilities[index] = definition.Volatility.mantissa;
+    theorPrices[index] = definition.TheorPrice.mantissa;
+}
+
+void InstrumentDirectory::onUpdate(const SecurityDefinitionUpdateReport& report)
+{
+    const uint32_t index = add(report.SecurityID);
+
+    volatilities[index] = report.Volatility.mantissa;
+    theorPrices[index] = report.TheorPrice.mantissa;
+}
+
+void InstrumentDirectory::save(CheckpointWriter& writer) const
+{
+    writer.writeVector(securityIds);
+    writer.writeVector(definedFlags);
+    writer.writeVector(symbols);
+    writer.writeVector(minPriceIncrements);
+    writer.writeVector(contractMultipliers);
+    writer.writeVector(maturityDates);
+    writer.writeVector(volatilities);
+    writer.writeVector(theorPrices);
+}
+
+void InstrumentDirectory::restore(CheckpointReader& reader)
+{
+    std::vector<int32_t> savedIds;
+    reader.readVector(savedIds);
+    for (int32_t securityId : savedIds)
+        add(securityId); // Rebuilds the pages, the indexes come out as they were
+
+    reader.readVector(definedFlags);
+    reader.readVector(symbols);
+    reader.readVector(minPriceIncrements);
+    reader.readVector(contractMultipliers);
+    reader.readVector(maturityDates);
+    reader.readVector(volatilities);
+    reader.readVector(theorPrices);
+
+    const size_t count = securityIds.size();
+    if (definedFlags.size() != count || symbols.size() != count || minPriceIncrements.size() != count || contractMultipliers.size() != count ||
+        maturityDates.size() != count || volatilities.size() != count || theorPrices.size() != count)
+    {
+        throw std::runtime_error("Checkpoint file has an inconsistent instrument directory.");
+    }
+}
+
+std::string_view InstrumentDirectory::symbol(uint32_t index) const noexcept
+{
+    const std::array<char, 25>& symbol = symbols[index];
+    return std::string_view(symbol.data(), std::find(symbol.begin(), symbol.end(), '\0') - symbol.begin());
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "Checkpoint.hpp"
+#include "SIMBA_Schema.hpp"
+
+// Every instrument seen in the session under a dense index, in order of first appearance, with its
+// reference data from SecurityDefinition and SecurityDefinitionUpdateReport stored column-wise. Per
+// instrument state elsewhere (books, recovery, quotes) is a plain vector indexed the same way.
+// SecurityID to index is a paged direct table: two array loads, no hashing or probing, and pages are
+// only allocated for the ID ranges the feed actually uses
+class InstrumentDirectory
+{
+public:
+	static constexpr uint32_t NONE = UINT32_MAX;
+
+	uint32_t find(int32_t securityId) const noexcept
+	{
+		const uint32_t key = static_cast<uint32_t>(securityId);
+		const size_t page = key >> PAGE_BITS;
+		if (page >= pages.size() || !pages[page]) [[unlikely]]
+			return NONE;
+		return pages[page][key & PAGE_MASK];
+	}
+
+	// Index of the instrument, added without reference data if it has not been seen before
+	uint32_t add(int32_t securityId)
+	{
+		const uint32_t index = find(securityId);
+		return index != NONE ? index : insert(securityId);
+	}
+
+	void onDefinition(const SecurityDefinitionBlock& definition);
+	void onUpdate(const SecurityDefinitionUpdateReport& report);
+
+	void save(CheckpointWriter& writer) const;
+	void restore(CheckpointReader& reader); // Into an empty directory
+
+	size_t size() const noexcept { return securityIds.size(); }
+
+	int32_t securityId(uint32_t index) const noexcept { return securityIds[index]; }
+	bool defined(uint32_t index) const noexcept { return definedFlags[index] != 0; }
+	std::string_view symbol(uint32_t index) const noexcept;
+	int64_t minPriceIncrement(uint32_t index) const noexcept { return minPriceIncrements[index]; } // Decimal5 mantissa
+	int32_t contractMultiplier(uint32_t index) const noexcept { return contractMultipliers[index]; }
+	uint32_t maturityDate(uint32_t index) const noexcept { return maturityDates[index]; }           // YYYYMMDD
+	int64_t volatility(uint32_t index) const noexcept { return volatilities[index]; }               // Decimal5 mantissa
+	int64_t theorPrice(uint32_t index) const noexcept { return theorPrices[index]; }                // Decimal5 mantissa
+
+private:
+	static constexpr uint32_t PAGE_BITS = 12;
+	static constexpr uint32_t PAGE_MASK = (1u << PAGE_BITS) - 1;
+
+	uint32_t insert(int32_t securityId);
+
+	std::vector<std::unique_ptr<uint32_t[]>> pages; // SecurityID >> PAGE_BITS, entries are NONE until used
+
+	std::vector<int32_t> securityIds;
+	std::vector<uint8_t> definedFlags;
+	std::vector<std::array<char, 25>> symbols;
+	std::vector<int64_t> minPriceIncrements;
+	std::vector<int32_t> contractMultipliers;
+	std::vector<uint32_t> maturityDates;
+	std::vector<int64_t> volatilities;
+	std::vector<int64_t> theorPrices;
+};
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "JSON_Sink.hpp"
+#include "SIMBA_JSON.hpp"
+
+JSONSink::JSONSink(const std::string& outputFilePath, OutputMode format, bool enclose, FieldProjection fields,
+    const CompressionOptions& compression)
+    : outputFile(outputFilePath, compression), ndjson(format == OutputMode::NDJSON), enclose(enclose && !ndjson), fields(std::move(fields))
+{
+    if (this->enclose)
+        jsonBuffer.append('['); // Start JSON array
+}
+
+void JSONSink::onPacket(const SIMBAPacket& packet)
+{
+    if (ndjson)
+    {
+        writeNDJSON(jsonBuffer, packet, fields);
+    }
+    else
+    {
+        writeJSON(jsonBuffer, packet, fields);
+        jsonBuffer.append(",\n");
+    }
+
+    if (jsonBuffer.size() >= FLUSH_SIZE)
+    {
+        outputFile.write(jsonBuffer.data(), jsonBuffer.size());
+        jsonBuffer.clear();
+    }
+}
+
+JSONSink::~JSONSink()
+{
+    try
+    {
+        if (enclose)
+            jsonBuffer.append(']'); // Make sure the JSON array is closed properly
+        outputFile.write(jsonBuffer.data(), jsonBuffer.size()); // Make sure there's nothing left in the outputBuffer
+        outputFile.close(); // Waits for the writer thread
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+}
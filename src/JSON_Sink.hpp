@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include "Async_Writer.hpp"
+#include "JSON_Writer.hpp"
+#include "Packet_Sink.hpp"
+#include "Parser_Options.hpp"
+
+// Writes every packet as an element of one JSON array, the original output of the parser. Without
+// enclose only the elements are written, a part of the array another writer puts the brackets around.
+// In NDJSON mode every message is a line of its own instead and nothing encloses them
+class JSONSink : public PacketSink
+{
+public:
+	explicit JSONSink(const std::string& outputFilePath, OutputMode format = OutputMode::JSON, bool enclose = true,
+		FieldProjection fields = {}, const CompressionOptions& compression = {});
+	~JSONSink() override;
+
+	void onPacket(const SIMBAPacket& packet) override;
+
+private:
+	static constexpr size_t FLUSH_SIZE = 4 * 1024 * 1024; // Bytes of text buffered between handing it to the writer thread
+
+	AsyncFileWriter outputFile;
+	JSONWriter jsonBuffer{ FLUSH_SIZE + 64 * 1024 }; // For performance so we don't have to write every single packet to disk one by one
+	bool ndjson;
+	bool enclose;
+	FieldProjection fields;
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+// Appends JSON text to one contiguous buffer. Numbers go through std::to_chars, without the locale and
+// stream state an ostream consults for every value, and clear() keeps the capacity, so a writer reused
+// for every batch stops allocating once it has held the largest one
+class JSONWriter
+{
+public:
+	explicit JSONWriter(size_t capacity = 64 * 1024) : buffer(std::make_unique<char[]>(capacity)), capacity(capacity) {}
+
+	JSONWriter(const JSONWriter&) = delete;
+	JSONWriter& operator=(const JSONWriter&) = delete;
+	JSONWriter(JSONWriter&&) noexcept = default;
+	JSONWriter& operator=(JSONWriter&&) noexcept = default;
+
+	const char* data() const noexcept { return buffer.get(); }
+	size_t size() const noexcept { return used; }
+	std::string_view view() const noexcept { return std::string_view(buffer.get(), used); }
+	void clear() noexcept { used = 0; }
+
+	// Literal text, keys included. A string literal's length is a compile time constant
+	void append(std::string_view text)
+	{
+		std::memcpy(reserve(text.size()), text.data(), text.size());
+		used += text.size();
+	}
+
+	void append(char character)
+	{
+		*reserve(1) = character;
+		++used;
+	}
+
+	template<std::integral T>
+	void integer(T value)
+	{
+		constexpr size_t MAX_DIGITS = 24; // Sign and 20 digits of a 64 bit value
+		char* at = reserve(MAX_DIGITS);
+		used = std::to_chars(at, at + MAX_DIGITS, value).ptr - buffer.get();
+	}
+
+	// As an ostream writes a double by default, %g with 6 significant digits
+	void floating(double value)
+	{
+		constexpr size_t MAX_CHARS = 32;
+		char* at = reserve(MAX_CHARS);
+		used = std::to_chars(at, at + MAX_CHARS, value, std::chars_format::general, 6).ptr - buffer.get();
+	}
+
+	// A fixed size char field up to its first NUL, the whole field if it has none, escaped
+	void trimmed(const char* field, size_t size)
+	{
+		const void* end = std::memchr(field, '\0', size);
+		escaped(field, end ? static_cast<const char*>(end) - field : size);
+	}
+
+	// Text as the inside of a JSON string. Quotes, backslashes and control characters are escaped, and
+	// so are bytes past ASCII unless the text is UTF-8, which a JSON string holds as it is
+	void escaped(const char* text, size_t size, bool utf8 = false)
+	{
+		size_t plain = 0; // Copied in runs between the characters that need an escape
+		for (size_t i = 0; i < size; ++i)
+		{
+			const unsigned char c = static_cast<unsigned char>(text[i]);
+			if (c >= 0x20 && c != '"' && c != '\\' && (c < 0x7F || utf8)) [[likely]]
+				continue;
+
+			append(std::string_view(text + plain, i - plain));
+			plain = i + 1;
+			escape(c);
+		}
+		append(std::string_view(text + plain, size - plain));
+	}
+
+private:
+	void escape(unsigned char c)
+	{
+		static constexpr char HEX[] = "0123456789ABCDEF";
+		switch (c)
+		{
+		case '"': append("\\\""); break;
+		case '\\': append("\\\\"); break;
+		case '\b': append("\\b"); break;
+		case '\f': append("\\f"); break;
+		case '\n': append("\\n"); break;
+		case '\r': append("\\r"); break;
+		case '\t': append("\\t"); break;
+		default:
+		{
+			char* at = reserve(6);
+			std::memcpy(at, "\\u00", 4);
+			at[4] = HEX[c >> 4];
+			at[5] = HEX[c & 0x0F];
+			used += 6;
+		}
+		}
+	}
+
+	char* reserve(size_t bytes)
+	{
+		if (capacity - used < bytes) [[unlikely]]
+			grow(bytes);
+		return buffer.get() + used;
+	}
+
+	void grow(size_t bytes)
+	{
+		size_t newCapacity = capacity * 2;
+		while (newCapacity - used < bytes)
+			newCapacity *= 2;
+		std::unique_ptr<char[]> newBuffer = std::make_unique_for_overwrite<char[]>(newCapacity);
+		std::memcpy(newBuffer.get(), buffer.get(), used);
+		buffer = std::move(newBuffer);
+		capacity = newCapacity;
+	}
+
+	std::unique_ptr<char[]> buffer;
+	size_t used = 0;
+	size_t capacity;
+};
@@ -0,0 +1,408 @@
+#include <stdexcept>
+
+#include "Order_Book.hpp"
+
+namespace
+{
+    struct SavedBook
+    {
+        int32_t securityId;
+        uint32_t rptSeq;
+        uint32_t gaps;
+    };
+
+    struct SavedOrder
+    {
+        int64_t id;
+        int64_t price;
+        int64_t size;
+        uint32_t book;
+        uint32_t side;
+    };
+}
+
+OrderBook::OrderBook(InstrumentDirectory& instruments, size_t expectedOrders)
+    : instruments(instruments), orderIndex(expectedOrders), levelIndex(expectedOrders / 4)
+{
+    orders.reserve(expectedOrders);
+    levels.reserve(expectedOrders / 4);
+}
+
+void OrderBook::apply(uint32_t book, const OrderUpdate& update)
+{
+    if (!acceptSequence(bookList[book], update.RptSeq))
+        return;
+
+    if (update.mdEntryType == MDEntryType::EmptyBook) [[unlikely]]
+    {
+        clearBook(book);
+        return;
+    }
+
+    const Side side = update.mdEntryType == MDEntryType::Offer ? Offer : Bid;
+    switch (update.mdUpdateAction)
+    {
+    case MDUpdateAction::New:
+        addOrder(book, side, update.MDEntryID, update.MDEntryPx.mantissa, update.MDEntrySize);
+        break;
+    case MDUpdateAction::Change:
+        changeOrder(book, side, update.MDEntryID, update.MDEntryPx.mantissa, update.MDEntrySize);
+        break;
+    case MDUpdateAction::Delete:
+        deleteOrder(book, update.MDEntryID);
+        break;
+    }
+}
+
+void OrderBook::apply(uint32_t book, const OrderExecution& execution)
+{
+    if (!acceptSequence(bookList[book], execution.RptSeq))
+        return;
+
+    // MDEntrySize is what is left of the resting order after the trade. The price may be null on
+    // executions, in which case the order keeps the price it was added with
+    const Side side = execution.mdEntryType == MDEntryType::Offer ? Offer : Bid;
+    switch (execution.mdUpdateAction)
+    {
+    case MDUpdateAction::New:
+    case MDUpdateAction::Change:
+    {
+        int64_t price = execution.MDEntryPx.mantissa;
+        if (price == Decimal5NULL::NULL_VALUE)
+        {
+            const uint32_t order = orderIndex.find({ execution.MDEntryID, book });
+            price = order == FlatIndex<OrderKey, OrderKeyHash>::NONE ? execution.LastPx.mantissa : orders[order].price;
+        }
+        changeOrder(book, side, execution.MDEntryID, price, execution.MDEntrySize);
+        break;
+    }
+    case MDUpdateAction::Delete:
+        deleteOrder(book, execution.MDEntryID);
+        break;
+    }
+}
+
+void OrderBook::clear(int32_t securityId)
+{
+    const uint32_t book = instruments.find(securityId);
+    if (book < bookList.size())
+        clearBook(book);
+}
+
+void OrderBook::reset(uint32_t book, uint32_t rptSeq)
+{
+    clearBook(book);
+    bookList[book].rptSeq = rptSeq;
+}
+
+void OrderBook::addSnapshotOrder(uint32_t book, const OrderBookSnapshotEntry& entry)
+{
+    if (entry.mdEntryType != MDEntryType::Bid && entry.mdEntryType != MDEntryType::Offer)
+        return; // An EmptyBook entry carries no order
+
+    addOrder(book, entry.mdEntryType == MDEntryType::Offer ? Offer : Bid, entry.MDEntryID, entry.MDEntryPx.mantissa, entry.MDEntrySize);
+}
+
+void OrderBook::save(CheckpointWriter& writer) const
+{
+    std::vector<SavedBook> savedBooks;
+    std::vector<SavedOrder> savedOrders;
+    savedBooks.reserve(bookList.size());
+    savedOrders.reserve(orderIndex.size());
+
+    for (uint32_t book = 0; book < bookList.size(); ++book)
+    {
+        const Book& state = bookList[book];
+        savedBooks.push_back(SavedBook{ state.securityId, state.rptSeq, state.gaps });
+
+        for (Side side : { Bid, Offer })
+        {
+            // Worst level first, so every level is the best one so far when it is restored and is placed
+            // without walking the side
+            uint32_t level = state.best[side];
+            while (level != NIL && levels[level].worse != NIL)
+                level = levels[level].worse;
+
+            for (; level != NIL; level = levels[level].better)
+            {
+                for (uint32_t order = levels[level].head; order != NIL; order = orders[order].next)
+                    savedOrders.push_back(SavedOrder{ orders[order].id, orders[order].price, orders[order].size, book, side });
+            }
+        }
+    }
+
+    writer.writeVector(savedBooks);
+    writer.writeVector(savedOrders);
+    writer.write(stats);
+}
+
+void OrderBook::restore(CheckpointReader& reader)
+{
+    std::vector<SavedBook> savedBooks;
+    reader.readVector(savedBooks);
+    if (!bookList.empty() || savedBooks.size() > instruments.size())
+        throw std::runtime_error("Checkpoint file does not match the instrument directory.");
+
+    if (!savedBooks.empty())
+        addBooks(static_cast<uint32_t>(savedBooks.size() - 1));
+    for (uint32_t book = 0; book < savedBooks.size(); ++book)
+    {
+        if (bookList[book].securityId != savedBooks[book].securityId)
+            throw std::runtime_error("Checkpoint file does not match the instrument directory.");
+        bookList[book].rptSeq = savedBooks[book].rptSeq;
+        bookList[book].gaps = savedBooks[book].gaps;
+    }
+
+    std::vector<SavedOrder> savedOrders;
+    reader.readVector(savedOrders);
+    for (const SavedOrder& order : savedOrders)
+    {
+        if (order.book >= bookList.size() || order.side > Offer)
+            throw std::runtime_error("Checkpoint file has an order of an unknown book.");
+        addOrder(order.book, static_cast<Side>(order.side), order.id, order.price, order.size);
+    }
+
+    stats = reader.read<Statistics>();
+}
+
+void OrderBook::addBooks(uint32_t lastBook)
+{
+    // The directory may have learned instruments from definitions before they had a book
+    while (bookList.size() <= lastBook)
+    {
+        Book book;
+        book.securityId = instruments.securityId(static_cast<uint32_t>(bookList.size()));
+        bookList.push_back(book);
+    }
+}
+
+// Updates arrive once per feed (A and B) and RptSeq grows by one per instrument, anything at or below
+// the last applied value has been seen already
+bool OrderBook::acceptSequence(Book& book, uint32_t rptSeq) noexcept
+{
+    if (book.rptSeq != 0)
+    {
+        if (rptSeq <= book.rptSeq)
+        {
+            ++stats.duplicates;
+            return false;
+        }
+        if (rptSeq != book.rptSeq + 1)
+        {
+            ++book.gaps;
+            ++stats.gaps;
+        }
+    }
+
+    book.rptSeq = rptSeq;
+    ++stats.updates;
+    return true;
+}
+
+void OrderBook::addOrder(uint32_t book, Side side, int64_t id, int64_t price, int64_t size)
+{
+    if (orderIndex.find({ id, book }) != FlatIndex<OrderKey, OrderKeyHash>::NONE) [[unlikely]]
+    {
+        changeOrder(book, side, id, price, size);
+        return;
+    }
+
+    const uint32_t order = allocateOrder();
+    const uint32_t level = findOrCreateLevel(book, side, price);
+
+    PriceLevel& priceLevel = levels[level];
+    orders[order] = Order{ id, price, size, level, priceLevel.tail, NIL, book, side };
+    if (priceLevel.tail != NIL)
+        orders[priceLevel.tail].next = order;
+    else
+        priceLevel.head = order;
+    priceLevel.tail = order;
+    priceLevel.size += size;
+    ++priceLevel.orderCount;
+    notify(book, side, priceLevel);
+
+    ++bookList[book].orderCount;
+    bookList[book].hash += orderHash(id, price, size, side);
+    orderIndex.insert({ id, book }, order);
+}
+
+void OrderBook::changeOrder(uint32_t book, Side side, int64_t id, int64_t price, int64_t size)
+{
+    const uint32_t order = orderIndex.find({ id, book });
+    if (order == FlatIndex<OrderKey, OrderKeyHash>::NONE) [[unlikely]]
+    {
+        // Started mid session or lost the New, take the order as it is now
+        ++stats.unknownOrders;
+        if (size > 0)
+            addOrder(book, side, id, price, size);
+        return;
+    }
+
+    Order& current = orders[order];
+    if (size <= 0)
+    {
+        deleteOrder(book, id);
+    }
+    else if (current.price != price || current.side != side)
+    {
+        // Moving to another level loses time priority
+        deleteOrder(book, id);
+        addOrder(book, side, id, price, size);
+    }
+    else
+    {
+        levels[current.level].size += size - current.size;
+        bookList[book].hash += orderHash(id, price, size, side) - orderHash(id, price, current.size, side);
+        current.size = size;
+        notify(book, side, levels[current.level]);
+    }
+}
+
+void OrderBook::deleteOrder(uint32_t book, int64_t id)
+{
+    const uint32_t order = orderIndex.find({ id, book });
+    if (order == FlatIndex<OrderKey, OrderKeyHash>::NONE) [[unlikely]]
+    {
+        ++stats.unknownOrders;
+        return;
+    }
+
+    const Order& current = orders[order];
+    bookList[book].hash -= orderHash(current.id, current.price, current.size, current.side);
+    orderIndex.erase({ id, book });
+    unlinkOrder(order);
+
+    orders[order].next = freeOrders;
+    freeOrders = order;
+    --bookList[book].orderCount;
+}
+
+void OrderBook::clearBook(uint32_t book)
+{
+    Book& state = bookList[book];
+    for (Side side : { Bid, Offer })
+    {
+        for (uint32_t level = state.best[side]; level != NIL;)
+        {
+            for (uint32_t order = levels[level].head; order != NIL;)
+            {
+                const uint32_t next = orders[order].next;
+                orderIndex.erase({ orders[order].id, book });
+                orders[order].next = freeOrders;
+                freeOrders = order;
+                order = next;
+            }
+
+            const uint32_t worse = levels[level].worse;
+            levelIndex.erase({ levels[level].price, book, side });
+            levels[level].worse = freeLevels;
+            freeLevels = level;
+            level = worse;
+        }
+
+        state.best[side] = NIL;
+        state.levelCount[side] = 0;
+    }
+    state.orderCount = 0;
+    state.hash = 0;
+
+    if (listener)
+        listener->onClear(book);
+}
+
+void OrderBook::unlinkOrder(uint32_t order)
+{
+    const Order& current = orders[order];
+    PriceLevel& level = levels[current.level];
+
+    if (current.prev != NIL)
+        orders[current.prev].next = current.next;
+    else
+        level.head = current.next;
+    if (current.next != NIL)
+        orders[current.next].prev = current.prev;
+    else
+        level.tail = current.prev;
+
+    level.size -= current.size;
+    --level.orderCount;
+    notify(current.book, current.side, level);
+    if (level.orderCount == 0)
+        removeLevel(current.book, current.side, current.level);
+}
+
+uint32_t OrderBook::findOrCreateLevel(uint32_t book, Side side, int64_t price)
+{
+    const uint32_t existing = levelIndex.find({ price, book, side });
+    if (existing != FlatIndex<LevelKey, LevelKeyHash>::NONE)
+        return existing;
+
+    const uint32_t level = allocateLevel();
+    Book& state = bookList[book];
+
+    // Walk from the best level to the first one this price is better than
+    uint32_t better = NIL;
+    uint32_t worse = state.best[side];
+    while (worse != NIL && (side == Bid ? levels[worse].price > price : levels[worse].price < price))
+    {
+        better = worse;
+        worse = levels[worse].worse;
+    }
+
+    levels[level] = PriceLevel{ price, 0, 0, NIL, NIL, better, worse };
+    if (better != NIL)
+        levels[better].worse = level;
+    else
+        state.best[side] = level;
+    if (worse != NIL)
+        levels[worse].better = level;
+
+    ++state.levelCount[side];
+    levelIndex.insert({ price, book, side }, level);
+    return level;
+}
+
+void OrderBook::removeLevel(uint32_t book, Side side, uint32_t level)
+{
+    Book& state = bookList[book];
+    const PriceLevel& current = levels[level];
+
+    if (current.better != NIL)
+        levels[current.better].worse = current.worse;
+    else
+        state.best[side] = current.worse;
+    if (current.worse != NIL)
+        levels[current.worse].better = current.better;
+
+    --state.levelCount[side];
+    levelIndex.erase({ current.price, book, side });
+
+    levels[level].worse = freeLevels;
+    freeLevels = level;
+}
+
+uint32_t OrderBook::allocateOrder()
+{
+    if (freeOrders != NIL)
+    {
+        const uint32_t order = freeOrders;
+        freeOrders = orders[order].next;
+        return order;
+    }
+
+    orders.emplace_back();
+    return static_cast<uint32_t>(orders.size() - 1);
+}
+
+uint32_t OrderBook::allocateLevel()
+{
+    if (freeLevels != NIL)
+    {
+        const uint32_t level = freeLevels;
+        freeLevels = levels[level].worse;
+        return level;
+    }
+
+    levels.emplace_back();
+    return static_cast<uint32_t>(levels.size() - 1);
+}
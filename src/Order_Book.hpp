@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Checkpoint.hpp"
+#include "Flat_Index.hpp"
+#include "Instrument_Directory.hpp"
+#include "SIMBA_Schema.hpp"
+
+// Order by order (L3) book of every instrument on the incremental feed, built from OrderUpdate and
+// OrderExecution. Orders and price levels live in pools addressed by uint32_t index and are linked
+// intrusively, so add, change and delete are a hash lookup plus a few index writes with no allocation
+// once the pools are warm. Levels of a side form a list sorted from the best price outwards; a new level
+// is placed by walking from the best one, which is O(1) for the usual activity near the top of the book
+class OrderBook
+{
+public:
+	static constexpr uint32_t NIL = UINT32_MAX;
+
+	enum Side : uint8_t
+	{
+		Bid = 0,
+		Offer = 1
+	};
+
+	struct Order
+	{
+		int64_t id;     // MDEntryID
+		int64_t price;  // Decimal5 mantissa
+		int64_t size;
+		uint32_t level; // Owning PriceLevel
+		uint32_t prev;  // Time priority within the level
+		uint32_t next;  // Also the free list link
+		uint32_t book;
+		Side side;
+	};
+
+	struct PriceLevel
+	{
+		int64_t price;       // Decimal5 mantissa
+		int64_t size;        // Sum of the order sizes
+		uint32_t orderCount;
+		uint32_t head;       // Oldest order
+		uint32_t tail;       // Newest order
+		uint32_t better;     // Neighbouring levels of the same side, NIL at the ends
+		uint32_t worse;      // Also the free list link
+	};
+
+	struct Book
+	{
+		int32_t securityId;
+		uint32_t rptSeq = 0;            // Last applied RptSeq
+		uint32_t best[2] = { NIL, NIL }; // Best level of each side
+		uint32_t levelCount[2] = { 0, 0 };
+		uint32_t orderCount = 0;
+		uint32_t gaps = 0;              // RptSeq jumps seen on this instrument
+		uint64_t hash = 0;              // Sum of orderHash over the orders, kept up to date by every change
+	};
+
+	struct Statistics
+	{
+		uint64_t updates = 0;       // Messages applied to a book
+		uint64_t duplicates = 0;    // Messages dropped because their RptSeq was already applied
+		uint64_t gaps = 0;          // RptSeq jumps over all instruments
+		uint64_t unknownOrders = 0; // Change or delete of an order that was never added
+	};
+
+	// Told about every price level whose aggregate changed, with its values after the change. An
+	// orderCount of 0 means the level is gone
+	class Listener
+	{
+	public:
+		virtual ~Listener() = default;
+		virtual void onLevel(uint32_t book, Side side, int64_t price, int64_t size, uint32_t orderCount) = 0;
+		virtual void onClear(uint32_t book) = 0;
+	};
+
+	explicit OrderBook(InstrumentDirectory& instruments, size_t expectedOrders = 1 << 20);
+
+	void setListener(Listener* levelListener) noexcept { listener = levelListener; }
+
+	// book is the instrument's index in the directory, see bookFor
+	void apply(uint32_t book, const OrderUpdate& update);
+	void apply(uint32_t book, const OrderExecution& execution);
+
+	// Drops every order of the instrument, as an EmptyBook entry does
+	void clear(int32_t securityId);
+
+	// Position of the instrument's book in books(), its index in the directory. Created empty on first use
+	uint32_t bookFor(int32_t securityId)
+	{
+		const uint32_t book = instruments.add(securityId);
+		if (book >= bookList.size()) [[unlikely]]
+			addBooks(book);
+		return book;
+	}
+
+	// Empties the book and continues from rptSeq, the first step of loading a snapshot
+	void reset(uint32_t book, uint32_t rptSeq);
+	void addSnapshotOrder(uint32_t book, const OrderBookSnapshotEntry& entry);
+
+	// Order contribution to Book::hash. Summing makes the hash independent of order and level sequence
+	// and lets a change take one order out and put it back in O(1), so a book is compared with a
+	// snapshot of it without walking either
+	static uint64_t orderHash(int64_t id, int64_t price, int64_t size, Side side) noexcept
+	{
+		return mixHash(static_cast<uint64_t>(id) ^ mixHash(static_cast<uint64_t>(price) ^ mixHash((static_cast<uint64_t>(size) << 1) | side)));
+	}
+
+	// Sequence state of every book and its orders in price and time priority. restore is for a book that
+	// has not seen any update yet, after the directory was restored; the listener hears every level added
+	void save(CheckpointWriter& writer) const;
+	void restore(CheckpointReader& reader);
+
+	const std::vector<Book>& books() const noexcept { return bookList; }
+	const Statistics& statistics() const noexcept { return stats; }
+
+	const PriceLevel* bestLevel(uint32_t book, Side side) const noexcept
+	{
+		const uint32_t level = bookList[book].best[side];
+		return level == NIL ? nullptr : &levels[level];
+	}
+
+	// Calls function with every level of one side from the best price outwards
+	template<typename Function>
+	void forEachLevel(uint32_t book, Side side, Function&& function) const
+	{
+		for (uint32_t level = bookList[book].best[side]; level != NIL; level = levels[level].worse)
+			function(levels[level]);
+	}
+
+	// Calls function with every order of a level in time priority
+	template<typename Function>
+	void forEachOrder(const PriceLevel& level, Function&& function) const
+	{
+		for (uint32_t order = level.head; order != NIL; order = orders[order].next)
+			function(orders[order]);
+	}
+
+private:
+	struct OrderKey
+	{
+		int64_t id;
+		uint32_t book;
+
+		bool operator==(const OrderKey&) const = default;
+	};
+
+	struct OrderKeyHash
+	{
+		size_t operator()(const OrderKey& key) const noexcept
+		{
+			return mixHash(static_cast<uint64_t>(key.id) ^ (static_cast<uint64_t>(key.book) << 48));
+		}
+	};
+
+	struct LevelKey
+	{
+		int64_t price;
+		uint32_t book;
+		uint32_t side;
+
+		bool operator==(const LevelKey&) const = default;
+	};
+
+	struct LevelKeyHash
+	{
+		size_t operator()(const LevelKey& key) const noexcept
+		{
+			return mixHash(static_cast<uint64_t>(key.price) ^ (static_cast<uint64_t>(key.book) << 40) ^ (static_cast<uint64_t>(key.side) << 63));
+		}
+	};
+
+	void addBooks(uint32_t lastBook);
+	bool acceptSequence(Book& book, uint32_t rptSeq) noexcept;
+
+	void addOrder(uint32_t book, Side side, int64_t id, int64_t price, int64_t size);
+	void changeOrder(uint32_t book, Side side, int64_t id, int64_t price, int64_t size);
+	void deleteOrder(uint32_t book, int64_t id);
+	void clearBook(uint32_t book);
+
+	void unlinkOrder(uint32_t order);
+	uint32_t findOrCreateLevel(uint32_t book, Side side, int64_t price);
+	void removeLevel(uint32_t book, Side side, uint32_t level);
+
+	uint32_t allocateOrder();
+	uint32_t allocateLevel();
+
+	void notify(uint32_t book, Side side, const PriceLevel& level) const
+	{
+		if (listener)
+			listener->onLevel(book, side, level.price, level.size, level.orderCount);
+	}
+
+	InstrumentDirectory& instruments;
+	std::vector<Book> bookList; // Same positions as the directory
+
+	std::vector<Order> orders;
+	std::vector<PriceLevel> levels;
+	uint32_t freeOrders = NIL;
+	uint32_t freeLevels = NIL;
+
+	FlatIndex<OrderKey, OrderKeyHash> orderIndex;
+	FlatIndex<LevelKey, LevelKeyHash> levelIndex;
+
+	Listener* listener = nullptr;
+	Statistics stats;
+};
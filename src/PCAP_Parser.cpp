@@ -5,30 +5,94 @@
 #include <cstring>
 
 #include "PCAP_Parser.hpp"
-#include "SIMBA_Decoder.hpp"
-#include "SIMBA_JSON.hpp"
-
-#ifdef _WIN32
-    #include <winsock2.h>
-    #pragma comment(lib, "Ws2_32.lib")
-#else
-    #include <netinet/in.h>
-#endif
+#include "Checkpoint.hpp"
+#include "JSON_Sink.hpp"
+#include "Book_Sink.hpp"
+#include "Sharded_Book_Sink.hpp"
+#include "Trade_Sink.hpp"
+#include "Column_Sink.hpp"
+#include "Arrow_Sink.hpp"
+#include "Event_Log.hpp"
 
 #define EXTRA_BUFFER_SPACE 1.2
 
-PCAPParser::PCAPParser(const std::string& inputFilePath, const std::string& outputFilePath)
-    : inputMapper(inputFilePath) {
+PCAPParser::PCAPParser(const std::string& inputFilePath, const std::string& outputFilePath, const ParserOptions& options)
+    : inputMapper(inputFilePath), options(options) {
     
     chunkDataBuffer = new char[static_cast<size_t>(inputMapper.getChunkSize() * EXTRA_BUFFER_SPACE)];
     inputMapper.fetchNextChunk(chunkOffset, chunkUnprocessedSize); // Start reading input
 
-    outputFile.open(outputFilePath, std::ios::out);
-    if (!outputFile.is_open()) {
-        throw std::runtime_error("Unable to open output file.");
+    sink = createSink(outputFilePath, this->options);
+    frames = std::make_unique<FrameDecoder>(this->options.templates, *sink);
+
+    fingerprint = captureFingerprint(std::span<const char>(chunkOffset, chunkUnprocessedSize));
+    if (!options.restorePath.empty())
+        restoreCheckpoint(options.restorePath);
+}
+
+void PCAPParser::restoreCheckpoint(const std::string& checkpointPath)
+{
+    CheckpointReader reader(checkpointPath);
+    const CheckpointHeader header = reader.read<CheckpointHeader>();
+    if (std::memcmp(header.magic, CheckpointHeader::MAGIC, sizeof(header.magic)) != 0 || header.version != CheckpointHeader::VERSION) {
+        throw std::runtime_error("Not a checkpoint file: " + checkpointPath);
+    }
+
+    sink->restore(reader);
+    if (!reader.atEnd()) {
+        throw std::runtime_error("Checkpoint file has trailing data.");
+    }
+    frames->setLastMsgSeqNum(header.lastMsgSeqNum);
+
+    // The same capture continues where the checkpoint was taken, any other one (the next session's) is
+    // read from its start on top of the restored state
+    if (header.captureFingerprint == fingerprint && header.captureOffset <= inputMapper.getFileSize())
+    {
+        resumeOffset = header.captureOffset;
+        packetCount = header.packets;
+        std::cout << "Restored checkpoint, resuming after packet " << packetCount << " at byte " << resumeOffset << "\n";
+    }
+    else
+    {
+        std::cout << "Restored checkpoint of another capture, reading this one from the start" << "\n";
+    }
+}
+
+void PCAPParser::writeCheckpoint()
+{
+    const uint64_t sendingTime = frames->packet().marketDataHeader.SendingTime;
+    const std::string checkpointPath = options.checkpointPath + "." + std::to_string(sendingTime);
+
+    CheckpointHeader header{};
+    std::memcpy(header.magic, CheckpointHeader::MAGIC, sizeof(header.magic));
+    header.version = CheckpointHeader::VERSION;
+    header.lastMsgSeqNum = frames->lastMsgSeqNum();
+    header.captureOffset = captureOffset;
+    header.captureFingerprint = fingerprint;
+    header.packets = packetCount;
+    header.sendingTime = sendingTime;
+
+    CheckpointWriter writer(checkpointPath);
+    writer.write(header);
+    sink->save(writer);
+    writer.commit();
+    std::cout << "Checkpoint written to " << checkpointPath << "\n";
+}
+
+void PCAPParser::seekInput(uint64_t offset)
+{
+    captureOffset = offset;
+    if (offset >= inputMapper.getFileSize())
+    {
+        chunkUnprocessedSize = 0; // Nothing was left after the checkpoint
+        return;
     }
 
-    jsonBuffer << "["; // Start JSON array
+    const size_t skip = inputMapper.seek(offset);
+    chunkUnprocessedSize = 0;
+    readMoreInput();
+    chunkOffset += skip;
+    chunkUnprocessedSize -= skip;
 }
 
 void PCAPParser::parseGlobalHeader()
@@ -47,182 +111,106 @@ void PCAPParser::parseGlobalHeader()
     // Advance the chunkData pointer for subsequent reads
     chunkOffset += sizeof(PCAPGlobalHeader);
     chunkUnprocessedSize -= sizeof(PCAPGlobalHeader);
+    captureOffset += sizeof(PCAPGlobalHeader);
 }
 
 void PCAPParser::parse()
 {
     parseGlobalHeader();
+    if (resumeOffset != 0)
+        seekInput(resumeOffset);
 
     // Read and parse packets until the end of the file
     auto begin = std::chrono::high_resolution_clock::now();
     auto start = begin;
 
-    // for (size_t i = 0; i < 100000; i++)
-    size_t i = 1;
-    while (chunkUnprocessedSize > 0)
+    const uint64_t checkpointInterval = options.checkpointPath.empty() ? 0 : options.checkpointInterval;
+    // A chunk can end exactly on a record boundary, the loop only stops once the mapper has nothing left
+    while ((chunkUnprocessedSize > 0 || readMoreInput()) && parsePCAPPacket())
     {
-        parsePCAPPacket();
-        if (i % 50000 == 0)
+        ++packetCount;
+        if (packetCount % 50000 == 0)
         {
-            std::cout << i << " packets processed | "
+            std::cout << packetCount << " packets processed | "
                 << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start) << " | "
                 << std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - begin) << " elapsed" << "\n";
             start = std::chrono::high_resolution_clock::now();
-            
-            outputFile << jsonBuffer.str();
-            jsonBuffer.str("");
-            jsonBuffer.clear();
         }
-        i++;
+
+        if (checkpointInterval != 0)
+        {
+            const uint64_t sendingTime = frames->packet().marketDataHeader.SendingTime;
+            if (nextCheckpointTime != 0 && sendingTime >= nextCheckpointTime)
+                writeCheckpoint();
+            if (nextCheckpointTime == 0 || sendingTime >= nextCheckpointTime)
+                nextCheckpointTime = (sendingTime / checkpointInterval + 1) * checkpointInterval;
+        }
     }
+
+    if (!options.checkpointPath.empty())
+        writeCheckpoint();
 }
 
-void PCAPParser::parsePCAPPacket()
+std::unique_ptr<PacketSink> PCAPParser::createSink(const std::string& outputFilePath, ParserOptions& options)
 {
-    PCAPPacketHeader packetHeader = parseGenericHeader<PCAPPacketHeader>();
-
-    if (chunkUnprocessedSize < packetHeader.incl_len)
-        readMoreInput();
-
-    std::vector<char> packetData = readPacketData(packetHeader);
-
-    // Process the packet data (example)
-
-    switch (globalHeader.network) {
-    case 1: // Ethernet
-        processPCAPPayload(packetData);
-        break;
-    case 105: // IEEE 802.11 Wireless LAN
-        break;
-    case 101: // Raw IP
-        break;
-    default:  // Unsupported data link type
-        break;
+    switch (options.mode)
+    {
+    case OutputMode::JSON:
+    case OutputMode::NDJSON:
+        return std::make_unique<JSONSink>(outputFilePath, options.mode, true, options.fields, options.compression);
+    case OutputMode::L3Book:
+    case OutputMode::L2Depth:
+    case OutputMode::BBO:
+        if (options.templates.decodesAll())
+            options.templates = BookBuilder::requiredTemplates(options.mode);
+        if (options.threads > 1)
+            return std::make_unique<ShardedBookSink>(outputFilePath, options);
+        return std::make_unique<BookSink>(outputFilePath, options);
+    case OutputMode::Trades:
+    case OutputMode::Bars:
+        if (options.templates.decodesAll())
+            options.templates = TradeSink::requiredTemplates();
+        return std::make_unique<TradeSink>(outputFilePath, options);
+    case OutputMode::Columns:
+        if (options.templates.decodesAll())
+            options.templates = ColumnSink::requiredTemplates();
+        return std::make_unique<ColumnSink>(outputFilePath);
+    case OutputMode::Arrow:
+        if (options.templates.decodesAll())
+            options.templates = ArrowSink::requiredTemplates();
+        return std::make_unique<ArrowSink>(outputFilePath);
+    case OutputMode::EventLog:
+        return std::make_unique<EventLogSink>(outputFilePath, options.compression);
     }
-}
-
-// Cross-platform utility function to convert IPv4 address to string
-std::string ipv4ToString(uint32_t ipAddress) {
-    // Convert from network byte order to host byte order
-    ipAddress = ntohl(ipAddress);
 
-    std::ostringstream oss;
-    oss << ((ipAddress >> 24) & 0xFF) << "."
-        << ((ipAddress >> 16) & 0xFF) << "."
-        << ((ipAddress >> 8) & 0xFF) << "."
-        << (ipAddress & 0xFF);
-
-    return oss.str();
+    throw std::runtime_error("Unknown output mode.");
 }
 
-void PCAPParser::processPCAPPayload(const std::vector<char>& packetData)
+bool PCAPParser::parsePCAPPacket()
 {
-    if (packetData.size() < sizeof(EthernetHeader)) {
-        throw std::runtime_error("Packet too short for Ethernet header");
-    }
-
-    // Parse Ethernet header
-    const EthernetHeader* ethHeader = reinterpret_cast<const EthernetHeader*>(packetData.data());
-    if (ntohs(ethHeader->etherType) != 0x0800) {
-        return; // Not IPv4
+    if (chunkUnprocessedSize < sizeof(PCAPPacketHeader) && !readMoreInput())
+    {
+        std::cerr << "Capture ends in the middle of a packet header" << "\n";
+        return false;
     }
+    PCAPPacketHeader packetHeader = parseGenericHeader<PCAPPacketHeader>();
 
-    // Move to the IPv4 header
-    const size_t ethernetHeaderLength = sizeof(EthernetHeader);
-    if (packetData.size() < ethernetHeaderLength + sizeof(IPv4Header)) {
-        throw std::runtime_error("Packet too short for IPv4 header");
+    if (chunkUnprocessedSize < packetHeader.incl_len && (!readMoreInput() || chunkUnprocessedSize < packetHeader.incl_len))
+    {
+        std::cerr << "Capture ends in the middle of a packet" << "\n";
+        return false;
     }
 
-    const IPv4Header* ipHeader = reinterpret_cast<const IPv4Header*>(packetData.data() + ethernetHeaderLength);
-    const auto ipHeaderLength = sizeof(IPv4Header);
+    // The frame is decoded where it lies in the chunk
+    const std::span<const char> frame(chunkOffset, packetHeader.incl_len);
+    chunkOffset += packetHeader.incl_len;
+    chunkUnprocessedSize -= packetHeader.incl_len;
+    captureOffset += sizeof(PCAPPacketHeader) + packetHeader.incl_len;
 
-    // Convert source and destination addresses to strings
-    std::string srcStr = ipv4ToString(ipHeader->sourceAddress);
-    std::string destStr = ipv4ToString(ipHeader->destinationAddress);
-
-    if (ipHeader->protocol == 1)  // ICMP
-    {
-        std::cout << "ICMP (Internet Control Message Protocol) not implemented\n";
-    }
-    else if (ipHeader->protocol == 2)  // IGMP
-    {
-        std::cout << "IGMP (Internet Group Management Protocol) not implemented\n";
-    }
-    else if (ipHeader->protocol == 6) [[likely]]  // TCP
-    {
-        auto tcpHeader = reinterpret_cast<const TCPHeader*>(packetData.data() + ipHeaderLength);
-        size_t tcpHeaderLength = (tcpHeader->dataOffset >> 4) * 4;
-
-        std::span<const char> payload(
-            packetData.data() + ipHeaderLength + tcpHeaderLength,
-            packetData.size() - (ipHeaderLength + tcpHeaderLength)
-        );
-
-        // Pass the payload on to the SIMBA protocol
-        SIMBADecoder decoder(payload);
-        auto debug = decoder.decode();
-        jsonBuffer << debug;
-    }
-    else if (ipHeader->protocol == 8)  // EGP
-    {
-        std::cout << "EGP (Exterior Gateway Protocol) not implemented\n";
-    }
-    else if (ipHeader->protocol == 17) [[likely]]  // UDP
-    {
-        auto udpHeader = reinterpret_cast<const UDPHeader*>(packetData.data() + ethernetHeaderLength + ipHeaderLength);
-        size_t udpHeaderLength = 8;
-
-        auto destPort = ntohs(udpHeader->destinationPort);
-        auto srcPort = ntohs(udpHeader->sourcePort);
-        auto length = ntohs(udpHeader->length);
-        auto checksum = ntohs(udpHeader->checksum);
-
-        std::span<const char> payload(
-            packetData.data() + ethernetHeaderLength + ipHeaderLength + udpHeaderLength,
-            ntohs(udpHeader->length) - udpHeaderLength
-        );
-
-        // Pass the payload on to the SIMBA protocol
-        SIMBADecoder decoder(payload);
-        auto debug = decoder.decode();
-        jsonBuffer << debug;
-    }
-    else if (ipHeader->protocol == 41)  // IPv6
-    {
-        std::cout << "IPv6 (IPv6 encapsulated in IPv4) not implemented\n";
-    }
-    else if (ipHeader->protocol == 50)  // ESP
-    {
-        std::cout << "ESP (Encapsulating Security Payload) not implemented\n";
-    }
-    else if (ipHeader->protocol == 51)  // AH
-    {
-        std::cout << "AH (Authentication Header) not implemented\n";
-    }
-    else if (ipHeader->protocol == 58)  // ICMPv6
-    {
-        std::cout << "ICMPv6 (ICMP for IPv6) not implemented\n";
-    }
-    else if (ipHeader->protocol == 88)  // EIGRP
-    {
-        std::cout << "EIGRP (Enhanced Interior Gateway Routing Protocol) not implemented\n";
-    }
-    else if (ipHeader->protocol == 89)  // OSPF
-    {
-        std::cout << "OSPF (Open Shortest Path First) not implemented\n";
-    }
-    else if (ipHeader->protocol == 132)  // SCTP
-    {
-        std::cout << "SCTP (Stream Control Transmission Protocol) not implemented\n";
-    }
-    else  // Default case
-    {
-        std::cout << "Unknown Protocol\n";
-    }
-    jsonBuffer << ",\n";
+    frames->onFrame(globalHeader.network, frame, captureTime(globalHeader, packetHeader));
+    return true;
 }
 
-
 IPv4Header PCAPParser::parseIPv4Header()
 {
     // Use a fixed-size buffer on the stack for maximum speed
@@ -279,26 +267,7 @@ T PCAPParser::parseGenericHeader()
         return packetHeader;
 }
 
-std::vector<char> PCAPParser::readPacketData(const PCAPPacketHeader& packetHeader) {
-    uint32_t capturedLength = packetHeader.incl_len;
-
-    // Ensure there is enough data in the chunk
-    if (chunkUnprocessedSize < capturedLength) {
-        throw std::runtime_error("Not enough data in chunk to read PCAP packet data.");
-    }
-
-    // Read the packet data directly from chunkData
-    const char* rawBuffer = chunkOffset; // Pointer to the start of the packet data
-    std::vector<char> packetData(rawBuffer, rawBuffer + capturedLength);
-
-    // Advance the chunkData pointer and reduce chunkUnprocessedSize
-    chunkOffset += capturedLength;
-    chunkUnprocessedSize -= capturedLength;
-
-    return packetData;
-}
-
-void PCAPParser::readMoreInput()
+bool PCAPParser::readMoreInput()
 {
     size_t remainingSize = chunkUnprocessedSize;
 
@@ -312,7 +281,7 @@ void PCAPParser::readMoreInput()
     const char* newChunkData = nullptr;
     size_t newChunkSize = 0;
     if (!inputMapper.fetchNextChunk(newChunkData, newChunkSize)) {
-        throw std::runtime_error("No more data available");
+        return false; // End of the capture, what is left stays unprocessed
     }
     auto debug = inputMapper.getChunkSize();
     // Ensure new data fits within the preallocated buffer
@@ -331,14 +300,12 @@ void PCAPParser::readMoreInput()
     // set chunkOffset to 0
     // fetch next chunk of input which will be written from chunkOffset + chunkUnprocessedSize all the way to the new length
     // the new chunkUnprocessedSize will be current chunkUnprocessedSize + the new incoming size
+    return true;
 }
 
 PCAPParser::~PCAPParser()
 {
-    if (outputFile.is_open())
-    {
-        outputFile << jsonBuffer.str(); // Make sure there's nothing left in the outputBuffer JSON array is closed properly
-        outputFile << "]";  // Make sure the JSON array is closed properly
-        outputFile.close(); // File closing in destructor for RAII
-    }
+    frames.reset();
+    sink.reset(); // Sinks write their remaining output when destroyed
+    delete[] chunkDataBuffer;
 }
\ No newline at end of file
@@ -1,25 +1,31 @@
 #pragma once
 
+#include <memory>
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <vector>
 
 #include "PCAP_Schema.hpp"
 #include "IO_Mapper.hpp"
+#include "Frame_Decoder.hpp"
+#include "Packet_Sink.hpp"
+#include "Parser_Options.hpp"
 
 class PCAPParser
 {
 public:
-	PCAPParser(const std::string& inputFilePath, const std::string& outputFilePath);
+	PCAPParser(const std::string& inputFilePath, const std::string& outputFilePath, const ParserOptions& options = {});
 	~PCAPParser();
 
 	void parse();
 
-	std::vector<char> readPacketData(const PCAPPacketHeader& packetHeader);
+	// The sink of the output mode, narrowing options.templates to what it needs unless they were given
+	static std::unique_ptr<PacketSink> createSink(const std::string& outputFilePath, ParserOptions& options);
 
-	void parsePCAPPacket();
-	void processPCAPPayload(const std::vector<char>& packetData);
+	// Writes the sink's state and the position in the capture to a file next to checkpointPath
+	void writeCheckpoint();
+
+	// Decodes the next pcap record, false once the capture has no complete one left
+	bool parsePCAPPacket();
 
 private:
 	
@@ -28,12 +34,22 @@ private:
 	const char* chunkOffset = nullptr;
 	size_t chunkUnprocessedSize = 0;
 
-	std::ofstream outputFile;
-	std::ostringstream jsonBuffer; // For performance so we don't have to write every single packet to disk one by one
+	std::unique_ptr<PacketSink> sink;
 
 	PCAPGlobalHeader globalHeader{};
+	uint64_t captureOffset = 0;      // Bytes of the capture consumed so far
+	uint64_t fingerprint = 0;        // captureFingerprint of the input
+	uint64_t resumeOffset = 0;       // Where a restored checkpoint continues, 0 to read from the start
+	uint64_t packetCount = 0;        // pcap records processed
+	uint64_t nextCheckpointTime = 0;
+
+	ParserOptions options;
+	std::unique_ptr<FrameDecoder> frames;
+
+	bool readMoreInput();
+	void seekInput(uint64_t offset);
 
-	void readMoreInput();
+	void restoreCheckpoint(const std::string& checkpointPath);
 
 	void parseGlobalHeader();
 
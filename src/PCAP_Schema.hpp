@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
 // Struct for the pcap global header
@@ -25,6 +26,15 @@ struct PCAPPacketHeader
 };
 static_assert(sizeof(PCAPPacketHeader) == 16, "PCAPPacketHeader size mismatch!");
 
+static constexpr uint32_t PCAP_NANOSECOND_MAGIC = 0xa1b23c4d; // Captures whose ts_usec holds nanoseconds
+
+// Nanoseconds since the Unix epoch the record was captured at
+inline uint64_t captureTime(const PCAPGlobalHeader& globalHeader, const PCAPPacketHeader& header)
+{
+    const uint64_t subsecond = globalHeader.magic_number == PCAP_NANOSECOND_MAGIC ? header.ts_usec : header.ts_usec * 1000ULL;
+    return header.ts_sec * 1'000'000'000ULL + subsecond;
+}
+
 // Struct for the Ethernet header
 struct EthernetHeader
 {
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "Checkpoint.hpp"
+#include "SIMBA_Messages.hpp"
+
+// Consumer of decoded SIMBA packets in capture order. The parser owns one sink per run, selected by
+// the output mode; a sink writes whatever it produced when it is destroyed
+class PacketSink
+{
+public:
+	virtual ~PacketSink() = default;
+
+	// The packet object is reused by the parser, anything kept past this call has to be copied
+	virtual void onPacket(const SIMBAPacket& packet) = 0;
+
+	// State carried over a checkpoint, written after its CheckpointHeader. Only the book sinks have any
+	virtual void save(CheckpointWriter&)
+	{
+		throw std::runtime_error("Checkpoints are only supported in the l3, l2 and bbo modes.");
+	}
+	virtual void restore(CheckpointReader&)
+	{
+		throw std::runtime_error("Checkpoints are only supported in the l3, l2 and bbo modes.");
+	}
+};
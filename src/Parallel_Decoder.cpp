@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+#include "Parallel_Decoder.hpp"
+#include "Arrow_Sink.hpp"
+#include "Async_Writer.hpp"
+#include "Frame_Decoder.hpp"
+#include "JSON_Sink.hpp"
+#include "Work_Stealing_Scheduler.hpp"
+
+namespace
+{
+    constexpr uint32_t DEFAULT_SNAPLEN = 262144; // What a snaplen of 0 stands for
+}
+
+ParallelDecoder::ParallelDecoder(const std::string& inputFilePath, const std::string& outputFilePath, const ParserOptions& options)
+    : outputFilePath(outputFilePath), options(options), inputMapper(inputFilePath, std::numeric_limits<size_t>::max())
+{
+    if (!options.checkpointPath.empty() || !options.restorePath.empty()) {
+        throw std::runtime_error("Checkpoints are only supported in the l3, l2 and bbo modes.");
+    }
+    if (this->options.mode == OutputMode::Arrow && this->options.templates.decodesAll())
+        this->options.templates = ArrowSink::requiredTemplates();
+
+    // One mapping of the whole capture shared by the workers, the chunk size is not limiting it
+    const char* data = nullptr;
+    size_t size = 0;
+    if (!inputMapper.fetchNextChunk(data, size) || size < sizeof(PCAPGlobalHeader)) {
+        throw std::runtime_error("Not enough data to read the pcap global header.");
+    }
+    mapping = std::make_unique<MemoryMappedChunk>(const_cast<char*>(data), size);
+    capture = std::span<const char>(data, size);
+
+    std::memcpy(&globalHeader, capture.data(), sizeof(PCAPGlobalHeader));
+    if (globalHeader.magic_number == PCAP_NANOSECOND_MAGIC)
+        subsecondUnits = 1'000'000'000;
+    if (globalHeader.snaplen == 0)
+        globalHeader.snaplen = DEFAULT_SNAPLEN;
+    if (plausibleRecord(sizeof(PCAPGlobalHeader), 0))
+        firstRecordTime = recordTime(sizeof(PCAPGlobalHeader));
+}
+
+ParallelDecoder::~ParallelDecoder()
+{
+    std::error_code ignored;
+    for (const Range& range : ranges)
+        std::filesystem::remove_all(range.partPath, ignored); // Left behind if parsing failed
+}
+
+uint64_t ParallelDecoder::recordTime(uint64_t offset) const noexcept
+{
+    PCAPPacketHeader header;
+    std::memcpy(&header, capture.data() + offset, sizeof(header));
+    return static_cast<uint64_t>(header.ts_sec) * subsecondUnits + header.ts_usec;
+}
+
+bool ParallelDecoder::plausibleRecord(uint64_t offset, uint64_t previousTime) const noexcept
+{
+    if (capture.size() - offset < sizeof(PCAPPacketHeader))
+        return false;
+
+    PCAPPacketHeader header;
+    std::memcpy(&header, capture.data() + offset, sizeof(header));
+    return header.ts_usec < subsecondUnits
+        && header.incl_len != 0
+        && header.incl_len <= globalHeader.snaplen
+        && header.incl_len <= header.orig_len
+        && header.incl_len <= capture.size() - offset - sizeof(PCAPPacketHeader)
+        && recordTime(offset) >= previousTime; // Records are written in capture order
+}
+
+uint64_t ParallelDecoder::findBoundary(uint64_t from, uint64_t to) const noexcept
+{
+    for (uint64_t candidate = from; candidate < to; ++candidate)
+    {
+        uint64_t offset = candidate;
+        uint64_t previousTime = firstRecordTime;
+        size_t chained = 0;
+        while (chained < CHAIN_LENGTH && offset != capture.size() && plausibleRecord(offset, previousTime))
+        {
+            PCAPPacketHeader header;
+            std::memcpy(&header, capture.data() + offset, sizeof(header));
+            previousTime = recordTime(offset);
+            offset += sizeof(PCAPPacketHeader) + header.incl_len;
+            ++chained;
+        }
+
+        // A chain ending exactly at the end of the capture is as good as a full one
+        if (chained == CHAIN_LENGTH || (chained != 0 && offset == capture.size()))
+            return candidate;
+    }
+    return to;
+}
+
+void ParallelDecoder::decodeRange(Range& range, uint64_t from) const
+{
+    range.start = from;
+    range.packets = 0;
+    range.truncated = false;
+
+    // A part is a file of JSON text or a directory of Arrow record batches
+    std::unique_ptr<PacketSink> part;
+    if (options.mode == OutputMode::Arrow)
+        part = std::make_unique<ArrowSink>(range.partPath, false);
+    else
+        part = std::make_unique<JSONSink>(range.partPath, options.mode, false, options.fields);
+    FrameDecoder frames(options.templates, *part);
+
+    uint64_t offset = from;
+    while (offset < range.end && offset < capture.size())
+    {
+        if (capture.size() - offset < sizeof(PCAPPacketHeader))
+        {
+            range.truncated = true;
+            break;
+        }
+
+        PCAPPacketHeader header;
+        std::memcpy(&header, capture.data() + offset, sizeof(header));
+        if (header.incl_len > capture.size() - offset - sizeof(PCAPPacketHeader))
+        {
+            range.truncated = true;
+            break;
+        }
+
+        frames.onFrame(globalHeader.network, capture.subspan(offset + sizeof(PCAPPacketHeader), header.incl_len), captureTime(globalHeader, header));
+        offset += sizeof(PCAPPacketHeader) + header.incl_len;
+        ++range.packets;
+    }
+    range.stop = offset;
+}
+
+void ParallelDecoder::parse()
+{
+    const uint64_t first = sizeof(PCAPGlobalHeader);
+    const size_t rangeCount = options.threads * RANGES_PER_THREAD;
+    const uint64_t rangeSize = (capture.size() - first + rangeCount - 1) / rangeCount;
+
+    ranges.resize(rangeCount);
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        Range& range = ranges[i];
+        range.begin = std::min<uint64_t>(first + i * rangeSize, capture.size());
+        range.end = std::min<uint64_t>(range.begin + rangeSize, capture.size());
+        range.partPath = outputFilePath + ".part" + std::to_string(i);
+    }
+
+    // The first range starts right after the global header, the others look for their first record
+    WorkStealingScheduler scheduler(options.threads);
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        scheduler.submit([this, i](size_t)
+        {
+            Range& range = ranges[i];
+            try
+            {
+                decodeRange(range, i == 0 ? range.begin : findBoundary(range.begin, range.end));
+            }
+            catch (...)
+            {
+                range.error = std::current_exception(); // Likely a false boundary, decided once the ranges are joined
+            }
+        });
+    }
+    scheduler.wait();
+
+    // Walk the ranges in file order, each one has to start where the previous one stopped
+    uint64_t position = first;
+    uint64_t packets = 0;
+    size_t redone = 0;
+    for (Range& range : ranges)
+    {
+        if (range.start == position && range.error)
+            std::rethrow_exception(range.error);
+        if (range.start != position)
+        {
+            decodeRange(range, position);
+            ++redone;
+        }
+        position = range.stop;
+        packets += range.packets;
+        if (range.truncated)
+            std::cerr << "Capture ends in the middle of a packet" << "\n";
+    }
+
+    if (options.mode == OutputMode::Arrow)
+        joinArrowParts();
+    else
+        joinTextParts();
+
+    std::cout << packets << " packets decoded in " << ranges.size() << " ranges on " << options.threads << " threads";
+    if (redone != 0)
+        std::cout << ", " << redone << " decoded again after a false record boundary";
+    std::cout << "\n";
+}
+
+void ParallelDecoder::joinTextParts()
+{
+    AsyncFileStream outputFile(outputFilePath, options.compression); // The parts are plain, the whole file is compressed once
+
+    const bool array = options.mode == OutputMode::JSON; // NDJSON lines need nothing around them
+    if (array)
+        outputFile << "[";
+    for (Range& range : ranges)
+    {
+        std::ifstream part(range.partPath, std::ios::in | std::ios::binary);
+        if (part.peek() != std::ifstream::traits_type::eof())
+            outputFile << part.rdbuf();
+        part.close();
+        std::remove(range.partPath.c_str());
+    }
+    if (array)
+        outputFile << "]";
+    outputFile.close();
+}
+
+void ParallelDecoder::joinArrowParts()
+{
+    ArrowSink output(outputFilePath);
+    for (Range& range : ranges)
+    {
+        output.appendPart(range.partPath);
+        std::filesystem::remove_all(range.partPath);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "IO_Mapper.hpp"
+#include "PCAP_Schema.hpp"
+#include "Parser_Options.hpp"
+
+// Decodes a capture to JSON or Arrow on several threads. The file is split into equal byte ranges, more than
+// there are threads so the work stealing scheduler can even out ranges that take longer, and each task
+// looks for the first pcap record boundary in its range, then writes the records starting in it to a
+// part file (a directory of record batches for Arrow). The parts are joined in file order into exactly
+// what a single thread writes, except that Arrow record batches also end where the ranges do.
+// A worker that took the wrong offset for a boundary shows up as the previous range not ending where
+// it started, and its range is decoded again from where the previous one really ended
+class ParallelDecoder
+{
+public:
+	ParallelDecoder(const std::string& inputFilePath, const std::string& outputFilePath, const ParserOptions& options);
+	~ParallelDecoder();
+
+	void parse();
+
+private:
+	static constexpr size_t CHAIN_LENGTH = 8;      // Records after a candidate boundary that have to validate too
+	static constexpr size_t RANGES_PER_THREAD = 8;
+
+	struct Range
+	{
+		uint64_t begin = 0;
+		uint64_t end = 0;
+		uint64_t start = 0;    // First record decoded
+		uint64_t stop = 0;     // First record not decoded, at or past end unless the capture is cut short
+		uint64_t packets = 0;
+		bool truncated = false; // The last record runs past the end of the capture
+		std::string partPath;
+		std::exception_ptr error;
+	};
+
+	// Whether a record header can be at offset, with the one before it at previousTime
+	bool plausibleRecord(uint64_t offset, uint64_t previousTime) const noexcept;
+	uint64_t recordTime(uint64_t offset) const noexcept;
+
+	// First offset in [from, to) a chain of plausible records starts at, to if there is none
+	uint64_t findBoundary(uint64_t from, uint64_t to) const noexcept;
+
+	// Writes the records starting in [from, range.end) to the range's part file
+	void decodeRange(Range& range, uint64_t from) const;
+
+	// Join the parts in file order into the output and remove them: JSON text into one file, the record
+	// batches of each Arrow table after the schema of a single stream
+	void joinTextParts();
+	void joinArrowParts();
+
+	std::string outputFilePath;
+	ParserOptions options;
+
+	IOMapper inputMapper;
+	std::unique_ptr<MemoryMappedChunk> mapping;
+	std::span<const char> capture;
+
+	PCAPGlobalHeader globalHeader{};
+	uint32_t subsecondUnits = 1'000'000; // ts_usec holds nanoseconds in captures with the nanosecond magic
+	uint64_t firstRecordTime = 0;
+
+	std::vector<Range> ranges;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Compressor.hpp"
+#include "Field_Projection.hpp"
+#include "SIMBA_Decoder.hpp"
+
+enum class OutputMode
+{
+	JSON,    // Every decoded packet as a JSON array element
+	NDJSON,  // Every decoded message as a line of its own, a JSON object with its packet's metadata
+	L3Book,  // Order by order book built from the incremental feed, written at the end
+	L2Depth, // Top levels of the aggregated book whenever they change or once per interval
+	BBO,     // Best bid and offer whenever they change
+	Trades,  // Every trade with its aggressor side
+	Bars,    // OHLCV bars per instrument by time or volume
+	Columns, // A directory of column files per template, with min/max statistics per chunk
+	Arrow,   // A directory of Arrow IPC streams per template
+	EventLog // Every decoded message as a binary record, for replaying without the capture
+};
+
+struct ParserOptions
+{
+	TemplateFilter templates; // Templates to decode, everything else is skipped without being materialized
+	OutputMode mode = OutputMode::JSON;
+	FieldProjection fields;   // Fields written per template in the JSON and NDJSON modes, every field if empty
+	size_t depth = 10;             // Levels per side written in L2Depth mode
+	uint64_t interval = 0;         // Nanoseconds of SendingTime between L2Depth snapshots (0 writes on every change) or per bar
+	int64_t barVolume = 0;         // Contracts per bar, instead of bars by time
+	bool verifyBooks = false;      // Compare live books with the snapshots of them on the snapshot feed
+	std::string checkpointPath;    // Prefix of the checkpoint files, none are written if empty
+	uint64_t checkpointInterval = 0; // Nanoseconds of SendingTime between checkpoints, 0 writes one at the end only
+	std::string restorePath;       // Checkpoint to start from
+	size_t threads = 1;            // Threads building the books split by SecurityID, or decoding ranges of the capture in the JSON and Arrow modes
+	bool pipeline = false;         // JSON or NDJSON output through the threaded pipeline, decode and serialize on threads workers if more than one
+	std::vector<int> stageCores;   // Core each pipeline stage and then each worker is pinned to, -1 leaves one unpinned
+	CompressionOptions compression; // Of the output file, in the modes writing a single file
+};
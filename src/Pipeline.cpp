@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include "Pipeline.hpp"
+#include "SIMBA_JSON.hpp"
+#include "Thread_Affinity.hpp"
+
+namespace
+{
+    constexpr const char* STAGE_NAMES[] = { "input", "framing", "decode", "serialize", "write" };
+
+    uint64_t now() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+Pipeline::Pipeline(const std::string& inputFilePath, const std::string& outputFilePath, const ParserOptions& options)
+    : options(options), freeBatches(std::max(BATCHES, BATCHES_PER_WORKER * options.threads))
+{
+    if (!options.checkpointPath.empty() || !options.restorePath.empty()) {
+        throw std::runtime_error("Checkpoints are only supported in the l3, l2 and bbo modes.");
+    }
+
+    inputFile.open(inputFilePath, std::ios::in | std::ios::binary);
+    if (!inputFile.is_open()) {
+        throw std::runtime_error("Failed to open file.");
+    }
+    if (!inputFile.read(reinterpret_cast<char*>(&globalHeader), sizeof(globalHeader))) {
+        throw std::runtime_error("Not enough data to read the pcap global header.");
+    }
+
+    outputFile = std::make_unique<AsyncFileWriter>(outputFilePath, options.compression);
+
+    // The pools start out with the stages that fill them, nothing else is allocated once running
+    for (size_t i = 0; i < BLOCKS; ++i)
+    {
+        blocks.push_back(std::make_unique<Block>());
+        freeBlocks.tryPush(blocks.back().get());
+    }
+    const size_t batchCount = std::max(BATCHES, BATCHES_PER_WORKER * options.threads);
+    for (size_t i = 0; i < batchCount; ++i)
+    {
+        batches.push_back(std::make_unique<Batch>());
+        batches.back()->records.reserve(BATCH_RECORDS);
+        freeBatches.tryPush(batches.back().get());
+    }
+
+    if (options.threads > 1)
+    {
+        // Cores past the five stages' are the workers'
+        std::vector<int> workerCores;
+        if (options.stageCores.size() > STAGES)
+            workerCores.assign(options.stageCores.begin() + STAGES, options.stageCores.end());
+
+        scheduler = std::make_unique<WorkStealingScheduler>(options.threads, workerCores);
+        reorder = std::make_unique<ReorderBuffer<Batch*>>(batchCount); // No more batches than that can be in flight
+        for (size_t i = 0; i < options.threads; ++i)
+            workerStates.push_back(std::make_unique<BatchState>(this->options.templates));
+    }
+}
+
+template<typename T>
+T Pipeline::pop(SPSCRing<T>& ring, uint64_t& waited)
+{
+    T value;
+    if (ring.tryPop(value)) [[likely]]
+        return value;
+
+    const uint64_t start = now();
+    Backoff backoff;
+    while (!ring.tryPop(value))
+    {
+        if (failed.load(std::memory_order_relaxed))
+            throw Aborted{};
+        backoff.pause();
+    }
+    waited += now() - start;
+    return value;
+}
+
+template<typename T>
+void Pipeline::push(SPSCRing<T>& ring, T value, uint64_t& waited)
+{
+    if (ring.tryPush(value)) [[likely]]
+        return;
+
+    const uint64_t start = now();
+    Backoff backoff;
+    while (!ring.tryPush(value))
+    {
+        if (failed.load(std::memory_order_relaxed))
+            throw Aborted{};
+        backoff.pause();
+    }
+    waited += now() - start;
+}
+
+void Pipeline::parse()
+{
+    const uint64_t start = now();
+    std::vector<std::thread> threads;
+    for (int stage = 0; stage < STAGES; ++stage)
+    {
+        if (scheduler && (stage == Decode || stage == Serialize))
+            continue; // Tasks on the workers
+        threads.emplace_back(&Pipeline::run, this, static_cast<Stage>(stage));
+        if (static_cast<size_t>(stage) < options.stageCores.size() && options.stageCores[stage] >= 0
+            && !pinThread(threads.back(), static_cast<unsigned>(options.stageCores[stage])))
+        {
+            std::cerr << "Unable to pin the " << STAGE_NAMES[stage] << " stage to core " << options.stageCores[stage] << "\n";
+        }
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    if (scheduler)
+        scheduler->wait(); // Tasks still running after a failure use the batches
+    wallTime = now() - start;
+
+    if (error)
+        std::rethrow_exception(error);
+    if (truncated)
+        std::cerr << "Capture ends in the middle of a packet" << "\n";
+
+    outputFile->close();
+
+    std::cout << packets << " packets written" << "\n";
+    printUtilization();
+}
+
+void Pipeline::run(Stage stage)
+{
+    const uint64_t start = now();
+    try
+    {
+        switch (stage)
+        {
+        case Input: input(); break;
+        case Framing: framing(); break;
+        case Decode: decode(); break;
+        case Serialize: serialize(); break;
+        case Write: write(); break;
+        default: break;
+        }
+    }
+    catch (const Aborted&)
+    {
+    }
+    catch (...)
+    {
+        fail(std::current_exception());
+    }
+    times[stage].total = now() - start;
+}
+
+void Pipeline::fail(std::exception_ptr exception)
+{
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (!error)
+        error = exception;
+    failed.store(true, std::memory_order_relaxed);
+}
+
+void Pipeline::input()
+{
+    StageTime& time = times[Input];
+    for (;;)
+    {
+        Block* next = pop(freeBlocks, time.downstream);
+        inputFile.read(next->bytes.data(), next->bytes.size());
+        next->size = static_cast<size_t>(inputFile.gcount());
+        if (inputFile.bad()) {
+            throw std::runtime_error("Failed to read file.");
+        }
+
+        push(filledBlocks, next, time.downstream);
+        if (next->size == 0)
+            return;
+    }
+}
+
+size_t Pipeline::take(char* destination, size_t size)
+{
+    StageTime& time = times[Framing];
+    size_t copied = 0;
+    while (copied < size)
+    {
+        if (block == nullptr || blockPosition == block->size)
+        {
+            if (block != nullptr)
+            {
+                if (block->size == 0)
+                    return copied; // End of the capture, the empty block is not handed back
+                push(freeBlocks, block, time.downstream);
+            }
+            block = pop(filledBlocks, time.upstream);
+            blockPosition = 0;
+            continue;
+        }
+
+        const size_t length = std::min(size - copied, block->size - blockPosition);
+        std::memcpy(destination + copied, block->bytes.data() + blockPosition, length);
+        blockPosition += length;
+        copied += length;
+    }
+    return copied;
+}
+
+void Pipeline::framing()
+{
+    StageTime& time = times[Framing];
+    Batch* batch = nullptr;
+    const auto acquire = [&]()
+    {
+        batch = pop(freeBatches, time.downstream);
+        batch->used = 0;
+        batch->records.clear();
+        batch->last = false;
+    };
+
+    acquire();
+    for (;;)
+    {
+        PCAPPacketHeader header;
+        const size_t headerBytes = take(reinterpret_cast<char*>(&header), sizeof(header));
+        if (headerBytes != sizeof(header))
+        {
+            truncated = headerBytes != 0;
+            break;
+        }
+
+        if (batch->used + header.incl_len > batch->bytes.size())
+            batch->bytes.resize(std::max(batch->bytes.size() * 2, batch->used + header.incl_len));
+        if (take(batch->bytes.data() + batch->used, header.incl_len) != header.incl_len)
+        {
+            truncated = true;
+            break;
+        }
+        batch->records.push_back(Record{ batch->used, header.incl_len, captureTime(globalHeader, header) });
+        batch->used += header.incl_len;
+
+        if (batch->records.size() == BATCH_RECORDS)
+        {
+            hand(batch, time.downstream);
+            acquire();
+        }
+    }
+
+    batch->last = true;
+    hand(batch, time.downstream);
+}
+
+void Pipeline::hand(Batch* batch, uint64_t& waited)
+{
+    if (!scheduler)
+    {
+        push(framed, batch, waited);
+        return;
+    }
+
+    batch->sequence = nextSequence++;
+    scheduler->submit([this, batch](size_t worker)
+    {
+        try
+        {
+            decodeBatch(*batch, *workerStates[worker]);
+            serializeBatch(*batch);
+        }
+        catch (...)
+        {
+            fail(std::current_exception());
+        }
+        reorder->complete(batch->sequence, batch);
+    });
+}
+
+Pipeline::Batch* Pipeline::nextSerialized(uint64_t& waited)
+{
+    if (!scheduler)
+        return pop(serialized, waited);
+
+    Batch* batch = nullptr;
+    if (!reorder->tryTake(batch))
+    {
+        const uint64_t start = now();
+        Backoff backoff;
+        while (!reorder->tryTake(batch))
+        {
+            if (failed.load(std::memory_order_relaxed))
+                throw Aborted{};
+            backoff.pause();
+        }
+        waited += now() - start;
+    }
+
+    if (failed.load(std::memory_order_relaxed))
+        throw Aborted{}; // The batch may be the one that failed
+    return batch;
+}
+
+void Pipeline::decodeBatch(Batch& batch, BatchState& state)
+{
+    batch.packetCount = 0;
+    for (const Record& record : batch.records)
+    {
+        const std::span<const char> frame(batch.bytes.data() + record.offset, record.length);
+        if (state.frames.decode(globalHeader.network, frame, record.captureTime, batch.packets[batch.packetCount]))
+            ++batch.packetCount;
+    }
+}
+
+void Pipeline::serializeBatch(Batch& batch)
+{
+    batch.text.clear();
+    for (size_t i = 0; i < batch.packetCount; ++i)
+    {
+        if (options.mode == OutputMode::NDJSON)
+        {
+            writeNDJSON(batch.text, batch.packets[i], options.fields);
+        }
+        else
+        {
+            writeJSON(batch.text, batch.packets[i], options.fields);
+            batch.text.append(",\n");
+        }
+    }
+}
+
+void Pipeline::decode()
+{
+    StageTime& time = times[Decode];
+    BatchState state(options.templates);
+    for (;;)
+    {
+        Batch* batch = pop(framed, time.upstream);
+        decodeBatch(*batch, state);
+
+        const bool last = batch->last;
+        push(decoded, batch, time.downstream);
+        if (last)
+            return;
+    }
+}
+
+void Pipeline::serialize()
+{
+    StageTime& time = times[Serialize];
+    for (;;)
+    {
+        Batch* batch = pop(decoded, time.upstream);
+        serializeBatch(*batch);
+
+        const bool last = batch->last;
+        push(serialized, batch, time.downstream);
+        if (last)
+            return;
+    }
+}
+
+void Pipeline::write()
+{
+    StageTime& time = times[Write];
+    const bool array = options.mode == OutputMode::JSON; // Same array the JSON sink writes
+    if (array)
+        outputFile->write("[", 1);
+    for (;;)
+    {
+        Batch* batch = nextSerialized(time.upstream);
+        outputFile->write(batch->text.data(), batch->text.size());
+        packets += batch->packetCount;
+
+        const bool last = batch->last;
+        push(freeBatches, batch, time.downstream);
+        if (last)
+            break;
+    }
+    if (array)
+        outputFile->write("]", 1);
+}
+
+void Pipeline::printUtilization() const
+{
+    std::cout << "Stage utilization (busy / waiting for work / waiting on later stages):" << "\n";
+    for (int stage = 0; stage < STAGES; ++stage)
+    {
+        if (scheduler && (stage == Decode || stage == Serialize))
+            continue;
+        const StageTime& time = times[stage];
+        const double total = static_cast<double>(std::max<uint64_t>(time.total, 1));
+        const uint64_t waiting = std::min(time.upstream + time.downstream, time.total);
+        std::cout << "  " << std::left << std::setw(10) << STAGE_NAMES[stage] << std::right << std::fixed << std::setprecision(1)
+            << std::setw(5) << 100.0 * (time.total - waiting) / total << "% / "
+            << std::setw(5) << 100.0 * time.upstream / total << "% / "
+            << std::setw(5) << 100.0 * time.downstream / total << "%" << "\n";
+    }
+
+    if (scheduler)
+    {
+        // Decode and serialize together, as a share of what the workers could have done while the stages ran
+        uint64_t busy = 0;
+        uint64_t tasks = 0;
+        uint64_t stolen = 0;
+        for (const WorkStealingScheduler::WorkerStatistics& worker : scheduler->statistics())
+        {
+            busy += worker.busy;
+            tasks += worker.tasks;
+            stolen += worker.stolen;
+        }
+        const double capacity = static_cast<double>(std::max<uint64_t>(wallTime, 1)) * scheduler->workers();
+        std::cout << "  " << std::left << std::setw(10) << "workers" << std::right << std::setw(5) << 100.0 * busy / capacity
+            << "% busy on " << scheduler->workers() << " threads, " << stolen << " of " << tasks << " batches stolen" << "\n";
+    }
+    std::cout << std::defaultfloat;
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Async_Writer.hpp"
+#include "Frame_Decoder.hpp"
+#include "JSON_Writer.hpp"
+#include "PCAP_Schema.hpp"
+#include "Parser_Options.hpp"
+#include "SIMBA_Messages.hpp"
+#include "Reorder_Buffer.hpp"
+#include "SPSC_Ring.hpp"
+#include "Work_Stealing_Scheduler.hpp"
+
+// Writes the JSON or NDJSON output on five threads connected by bounded SPSC rings: input reads the capture in
+// blocks, framing cuts the blocks into pcap records and batches them, decode turns the records into
+// SIMBA packets, serialize formats them as JSON and write puts the text in the output file. Blocks and
+// batches come from fixed pools and go back to the stage that fills them, so a slow stage holds up the
+// ones before it instead of letting memory grow. Every stage accounts the time it works and the time
+// it waits for work or for room further down, reported at the end to show which one limits throughput.
+// With more than one thread, decode and serialize run as one task per batch on a work stealing
+// scheduler instead, and the write stage takes the batches back in order from a reorder buffer
+class Pipeline
+{
+public:
+	enum Stage { Input, Framing, Decode, Serialize, Write, STAGES };
+
+	Pipeline(const std::string& inputFilePath, const std::string& outputFilePath, const ParserOptions& options);
+
+	void parse();
+
+private:
+	static constexpr size_t BLOCK_SIZE = 4 * 1024 * 1024; // Bytes read from the capture at a time
+	static constexpr size_t BLOCKS = 4;
+	static constexpr size_t BATCH_RECORDS = 256;          // pcap records per batch
+	static constexpr size_t BATCHES = 16;                 // At least, with workers BATCHES_PER_WORKER each
+	static constexpr size_t BATCHES_PER_WORKER = 4;
+	static constexpr size_t RING_SLOTS = 4;               // Between stages, fewer than BATCHES so a full ring stalls the stage feeding it
+
+	struct Block
+	{
+		std::vector<char> bytes = std::vector<char>(BLOCK_SIZE);
+		size_t size = 0; // 0 once the capture is exhausted
+	};
+
+	struct Record
+	{
+		size_t offset; // In the batch's bytes
+		uint32_t length;
+		uint64_t captureTime;
+	};
+
+	// Reused for the life of the pipeline, only the first records, packetCount and text size are valid
+	struct Batch
+	{
+		std::vector<char> bytes; // Records copied out of the blocks, a record can span two of them
+		size_t used = 0;
+		std::vector<Record> records;
+		std::vector<SIMBAPacket> packets{ BATCH_RECORDS };
+		size_t packetCount = 0;
+		JSONWriter text;         // Keeps its capacity from one use of the batch to the next
+		bool last = false;
+		uint64_t sequence = 0; // Order in the reorder buffer
+	};
+
+	// What decoding a batch needs, one per decode stage thread or per worker
+	struct BatchState
+	{
+		explicit BatchState(const TemplateFilter& templates) : frames(templates) {}
+
+		FrameDecoder frames;
+	};
+
+	struct StageTime
+	{
+		uint64_t total = 0;      // Nanoseconds from the stage's start to its end
+		uint64_t upstream = 0;   // Waiting for work from the stage before
+		uint64_t downstream = 0; // Waiting for room or a free buffer from the stages after
+	};
+
+	struct Aborted {}; // Unwinds the other stages once one has failed
+
+	template<typename T>
+	T pop(SPSCRing<T>& ring, uint64_t& waited);
+	template<typename T>
+	void push(SPSCRing<T>& ring, T value, uint64_t& waited);
+
+	void run(Stage stage);
+	void input();
+	void framing();
+	void decode();
+	void serialize();
+	void write();
+
+	void decodeBatch(Batch& batch, BatchState& state);
+	void serializeBatch(Batch& batch);
+
+	// Passes a framed batch on to the decode stage or the scheduler
+	void hand(Batch* batch, uint64_t& waited);
+	// Next batch in capture order for the write stage
+	Batch* nextSerialized(uint64_t& waited);
+
+	void fail(std::exception_ptr exception);
+
+	// Copies the next bytes of the capture for the framing stage, fewer than asked for at its end
+	size_t take(char* destination, size_t size);
+
+	void printUtilization() const;
+
+	ParserOptions options;
+	std::ifstream inputFile;
+	std::unique_ptr<AsyncFileWriter> outputFile;
+	PCAPGlobalHeader globalHeader{};
+
+	std::vector<std::unique_ptr<Block>> blocks;
+	std::vector<std::unique_ptr<Batch>> batches;
+	SPSCRing<Block*> freeBlocks{ BLOCKS };     // Framing to input
+	SPSCRing<Block*> filledBlocks{ BLOCKS };   // Input to framing
+	SPSCRing<Batch*> freeBatches;              // Write to framing
+	SPSCRing<Batch*> framed{ RING_SLOTS };     // Framing to decode
+	SPSCRing<Batch*> decoded{ RING_SLOTS };    // Decode to serialize
+	SPSCRing<Batch*> serialized{ RING_SLOTS }; // Serialize to write
+
+	// Decode and serialize tasks with more than one thread
+	std::unique_ptr<WorkStealingScheduler> scheduler;
+	std::unique_ptr<ReorderBuffer<Batch*>> reorder;
+	std::vector<std::unique_ptr<BatchState>> workerStates;
+	uint64_t wallTime = 0; // Nanoseconds the stage threads ran, for the workers' utilization
+
+	// Framing stage's position in the blocks
+	Block* block = nullptr;
+	size_t blockPosition = 0;
+	uint64_t nextSequence = 0;
+
+	uint64_t packets = 0;
+	bool truncated = false;
+
+	std::array<StageTime, STAGES> times{};
+	std::atomic<bool> failed{ false };
+	std::mutex errorMutex;
+	std::exception_ptr error;
+};
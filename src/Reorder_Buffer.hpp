@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Puts results completed out of order back in sequence. The producer numbers the work in order and has
+// at most capacity numbers in flight, any thread completes them, and one consumer takes them in order.
+// Each sequence number owns a slot of its own, so completing never waits on anything
+template<typename T>
+class ReorderBuffer
+{
+public:
+	explicit ReorderBuffer(size_t capacity) : slots(std::make_unique<Slot[]>(capacity)), capacity(capacity) {}
+
+	ReorderBuffer(const ReorderBuffer&) = delete;
+	ReorderBuffer& operator=(const ReorderBuffer&) = delete;
+
+	void complete(uint64_t sequence, T value)
+	{
+		Slot& slot = slots[sequence % capacity];
+		slot.value = std::move(value);
+		slot.ready.store(true, std::memory_order_release);
+	}
+
+	// Consumer side, the next result in sequence if it is complete
+	bool tryTake(T& value)
+	{
+		Slot& slot = slots[next % capacity];
+		if (!slot.ready.load(std::memory_order_acquire))
+			return false;
+
+		value = std::move(slot.value);
+		slot.ready.store(false, std::memory_order_relaxed);
+		++next;
+		return true;
+	}
+
+private:
+	struct alignas(64) Slot
+	{
+		std::atomic<bool> ready{ false };
+		T value{};
+	};
+
+	std::unique_ptr<Slot[]> slots;
+	size_t capacity;
+	uint64_t next = 0; // Consumer only
+};
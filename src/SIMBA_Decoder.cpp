@@ -1,21 +1,68 @@
 #include "SIMBA_Decoder.hpp"
 
+#include <algorithm>
+#include <charconv>
 #include <cstring>
 #include <memory>
+#include <stdexcept>
+#include <string_view>
 
 #include <type_traits>
 
-SIMBADecoder::SIMBADecoder(std::span<const char> packetData)
-    : packetData(packetData)
+TemplateFilter TemplateFilter::parse(const std::string& templateList)
+{
+    TemplateFilter filter;
+
+    std::string_view remaining(templateList);
+    while (!remaining.empty())
+    {
+        const size_t comma = remaining.find(',');
+        const std::string_view token = remaining.substr(0, comma);
+
+        uint16_t templateId = 0;
+        auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), templateId);
+        if (error != std::errc() || end != token.data() + token.size() || templateId >= MAX_TEMPLATE_ID)
+            throw std::runtime_error("Invalid template ID: " + std::string(token));
+
+        filter.addMessage(templateId); // 15 also selects OrderUpdate as version 3 sends it
+
+        if (comma == std::string_view::npos)
+            break;
+        remaining.remove_prefix(comma + 1);
+    }
+
+    return filter;
+}
+
+void TemplateFilter::add(uint16_t templateId)
+{
+    if (templateId >= MAX_TEMPLATE_ID)
+        throw std::runtime_error("Template ID out of range: " + std::to_string(templateId));
+
+    templates.set(templateId);
+    acceptAll = false;
+}
+
+SIMBADecoder::SIMBADecoder(std::span<const char> packetData, const TemplateFilter* filter)
+    : packetData(packetData), filter(filter)
 {
 }
 
-// Main decode function that processes the entire packet data
 SIMBAPacket SIMBADecoder::decode()
+{
+    SIMBAPacket returnPacket;
+    decode(returnPacket);
+    return returnPacket;
+}
+
+// Main decode function that processes the entire packet data
+void SIMBADecoder::decode(SIMBAPacket& returnPacket)
 {
     size_t offset = 0;
 
-    SIMBAPacket returnPacket;
+    returnPacket.incrementalHeader.reset();
+    returnPacket.messageHeader = MessageHeader{};
+    returnPacket.messages.clear();
 
     // Parse Market Data Packet Header
     MarketDataPacketHeader marketDataPacketHeader = parseType<MarketDataPacketHeader>(offset);
@@ -32,41 +79,17 @@ SIMBAPacket SIMBADecoder::decode()
     {
         MessageHeader header = parseType<MessageHeader>(offset);
 
-        switch (header.templateId)
+        if (filter && !filter->accepts(header.templateId))
         {
-            case 15: // OrderUpdate
-                returnPacket.messages.emplace_back(parseType<OrderUpdate>(offset));
-                break;
-            case 16: // OrderExecution
-                returnPacket.messages.emplace_back(parseType<OrderExecution>(offset));
-                break;
-            case 17: // OrderBookSnapshot
-                returnPacket.messages.emplace_back(parseOrderBookSnapshot(offset));
-                break;
-            case 18: // SecurityDefinition
-                returnPacket.messages.emplace_back(parseSecurityDefinition(offset));
-                break;
-            case 10: // SecurityDefinitionUpdateReport
-                returnPacket.messages.emplace_back(parseType<SecurityDefinitionUpdateReport>(offset));
-                break;
-            case 9: // SecurityStatus
-                returnPacket.messages.emplace_back(parseType<SecurityStatus>(offset));
-                break;
-            case 2:// SequenceReset
-                returnPacket.messages.emplace_back(parseType<SequenceReset>(offset));
-                break; //TradingSessionStatus
-            case 11:
-                returnPacket.messages.emplace_back(parseType<TradingSessionStatus>(offset));
-                break;
-            default:
-                // Skip unknown messages by advancing the offset by the block
-                // length
-                offset += header.blockLength;
-                break;
+            skipMessage(offset, header);
+            continue;
         }
+
+        const DecodeFunction decodeMessage = dispatchTable()[versionSlot(header.version)][templateSlot(header.templateId)];
+        (this->*decodeMessage)(offset, header, returnPacket);
+
         returnPacket.messageHeader = header;
     }
-    return returnPacket; //Blank
 }
 
 template<typename T>
@@ -82,247 +105,492 @@ T SIMBADecoder::parseType(size_t& offset) const noexcept
     return order;
 }
 
+// Reads a root block or group entry of blockLength bytes. Older schema versions send shorter blocks and the fields
+// they don't have stay zeroed, newer versions append fields we don't know about and those are stepped over
 template<typename T>
-std::vector<T> SIMBADecoder::parseVectorType(size_t& offset, const GroupSize& numElements) const noexcept
+T SIMBADecoder::parseBlock(size_t& offset, uint16_t blockLength) const noexcept
+{
+    static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+    T block{};
+    const size_t length = std::min<size_t>(sizeof(T), blockLength);
+    if (offset + length <= packetData.size()) [[likely]]
+        std::memcpy(&block, packetData.data() + offset, length);
+
+    offset += blockLength;
+    return block;
+}
+
+// Checks the whole group once and copies it in a single memcpy when the entries are laid out exactly like T.
+// Only a group running past the end of the packet goes entry by entry
+template<typename T, typename Wire, typename Group>
+std::vector<T> SIMBADecoder::parseVectorType(size_t& offset, const Group& numElements) const noexcept
+{
+    const size_t count = numElements.numInGroup;
+    const size_t groupLength = count * numElements.blockLength;
+
+    if (offset + groupLength > packetData.size()) [[unlikely]]
+        return parseVectorTypeTruncated<T, Wire, Group>(offset, numElements);
+
+    const char* entry = packetData.data() + offset;
+    offset += groupLength;
+
+    std::vector<T> entries;
+    if constexpr (std::is_same_v<T, Wire>)
+    {
+        if (numElements.blockLength == sizeof(T)) [[likely]]
+        {
+            entries.resize(count);
+            if (count != 0) // An empty vector's data() may be null
+                std::memcpy(entries.data(), entry, groupLength);
+            return entries;
+        }
+    }
+
+    entries.reserve(count);
+    const size_t length = std::min<size_t>(sizeof(Wire), numElements.blockLength);
+    for (size_t i = 0; i < count; ++i, entry += numElements.blockLength)
+    {
+        Wire wireEntry{};
+        std::memcpy(&wireEntry, entry, length);
+        if constexpr (std::is_same_v<T, Wire>)
+            entries.push_back(wireEntry);
+        else
+            entries.push_back(upgrade(wireEntry));
+    }
+
+    // If it's empty we should still put in the json as empty instead of not having it at all. Down to preference
+    return entries;
+}
+
+template<typename T, typename Wire, typename Group>
+std::vector<T> SIMBADecoder::parseVectorTypeTruncated(size_t& offset, const Group& numElements) const noexcept
 {
     std::vector<T> entries;
     entries.reserve(numElements.numInGroup);
 
     for (size_t i = 0; i < numElements.numInGroup; ++i)
-        entries.emplace_back(parseType<T>(offset));
+    {
+        if constexpr (std::is_same_v<T, Wire>)
+            entries.emplace_back(parseBlock<T>(offset, numElements.blockLength));
+        else
+            entries.emplace_back(upgrade(parseBlock<Wire>(offset, numElements.blockLength)));
+    }
 
-    // If it's empty we should still put in the json as empty instead of not having it at all. Down to preference
     return entries;
 }
 
-OrderBookSnapshot SIMBADecoder::parseOrderBookSnapshot(size_t& offset) const noexcept
+template<typename T>
+T SIMBADecoder::parseVarData(size_t& offset) const noexcept
 {
-    OrderBookSnapshot snapshot{};
+    T field{};
+    field.length = parseType<uint16_t>(offset);
+
+    if (offset + field.length <= packetData.size()) [[likely]]
+        field.varData = reinterpret_cast<const uint8_t*>(packetData.data() + offset);
+    else
+        field.length = 0;
 
-    if (offset + OrderBookSnapshot::BASE_SIZE <= packetData.size())
-        std::memcpy(&snapshot, packetData.data() + offset, OrderBookSnapshot::BASE_SIZE);
+    offset += field.length;
+    return field;
+}
 
-    offset += OrderBookSnapshot::BASE_SIZE;
+template<typename Entry>
+OrderBookSnapshot SIMBADecoder::parseOrderBookSnapshot(size_t& offset, uint16_t blockLength) const noexcept
+{
+    OrderBookSnapshot snapshot{};
+    static_cast<OrderBookSnapshotBlock&>(snapshot) = parseBlock<OrderBookSnapshotBlock>(offset, blockLength);
 
     snapshot.NoMDEntries = parseType<GroupSize>(offset);
 
-    snapshot.MDEntries = std::make_unique<std::vector<OrderBookSnapshotEntry>>(std::move(parseVectorType<OrderBookSnapshotEntry>(offset, snapshot.NoMDEntries)));
+    snapshot.MDEntries = std::make_unique<std::vector<OrderBookSnapshotEntry>>(std::move(parseVectorType<OrderBookSnapshotEntry, Entry>(offset, snapshot.NoMDEntries)));
 
     return snapshot;
 }
 
-SecurityDefinition SIMBADecoder::parseSecurityDefinition(size_t& offset) const noexcept
+SecurityDefinition SIMBADecoder::parseSecurityDefinition(size_t& offset, uint16_t blockLength) const noexcept
 {
     SecurityDefinition def{};
 
-    if (offset + sizeof(def.TotNumReports) <= packetData.size()) {
-        def.TotNumReports = parseType<uint32_t>(offset);
+    // The root block is one contiguous run of fixed fields: a single bounds check and memcpy unless the packet is cut short
+    const size_t length = std::min<size_t>(sizeof(SecurityDefinitionBlock), blockLength);
+    if (offset + length <= packetData.size()) [[likely]]
+    {
+        SecurityDefinitionBlock block;
+        std::memcpy(&block, packetData.data() + offset, length);
+        if (length < sizeof(SecurityDefinitionBlock))
+            std::memset(reinterpret_cast<char*>(&block) + length, 0, sizeof(SecurityDefinitionBlock) - length);
+        static_cast<SecurityDefinitionBlock&>(def) = block;
+    }
+    else
+    {
+        static_cast<SecurityDefinitionBlock&>(def) = parseSecurityDefinitionTruncated(offset);
+    }
+
+    offset += blockLength; // Groups start after the root block, whatever its length in this schema version
+
+    def.NoMDFeedTypes = parseType<GroupSize>(offset);
+    def.MDFeedTypesEntries = std::make_unique<std::vector<SecurityDefinition::MDFeedTypes>>(parseVectorType<SecurityDefinition::MDFeedTypes>(offset, def.NoMDFeedTypes));
+
+    def.NoUnderlyings = parseType<GroupSize>(offset);
+    def.UnderlyingsEntries = std::make_unique<std::vector<SecurityDefinition::Underlyings>>(parseVectorType<SecurityDefinition::Underlyings>(offset, def.NoUnderlyings));
+
+    def.NoLegs = parseType<GroupSize>(offset);
+    def.LegsEntries = std::make_unique<std::vector<SecurityDefinition::Legs>>(parseVectorType<SecurityDefinition::Legs>(offset, def.NoLegs));
+
+    def.NoInstrAttrib = parseType<GroupSize>(offset);
+    def.InstrAttribEntries = std::make_unique<std::vector<SecurityDefinition::InstrAttrib>>(parseVectorType<SecurityDefinition::InstrAttrib>(offset, def.NoInstrAttrib));
+
+    def.NoEvents = parseType<GroupSize>(offset);
+    def.EventsEntries = std::make_unique<std::vector<SecurityDefinition::Events>>(parseVectorType<SecurityDefinition::Events>(offset, def.NoEvents));
+
+    def.SecurityDesc = parseVarData<Utf8String>(offset);
+    def.QuotationList = parseVarData<VarString>(offset);
+
+    return def;
+}
+
+// Slow path for a root block cut short by the end of the packet: every field that is still complete is kept
+SecurityDefinitionBlock SIMBADecoder::parseSecurityDefinitionTruncated(size_t offset) const noexcept
+{
+    SecurityDefinitionBlock block{};
+
+    if (offset + sizeof(block.TotNumReports) <= packetData.size()) {
+        block.TotNumReports = parseType<uint32_t>(offset);
     }
 
-    if (offset + sizeof(def.Symbol) <= packetData.size()) {
-        std::memcpy(def.Symbol, packetData.data() + offset, sizeof(def.Symbol));
-        offset += sizeof(def.Symbol);
+    if (offset + sizeof(block.Symbol) <= packetData.size()) {
+        std::memcpy(block.Symbol, packetData.data() + offset, sizeof(block.Symbol));
+        offset += sizeof(block.Symbol);
     }
 
-    if (offset + sizeof(def.SecurityID) <= packetData.size()) {
-        def.SecurityID = parseType<int32_t>(offset);
+    if (offset + sizeof(block.SecurityID) <= packetData.size()) {
+        block.SecurityID = parseType<int32_t>(offset);
     }
 
     // SecurityIDSource is static, no parsing needed
 
-    if (offset + sizeof(def.SecurityAltID) <= packetData.size()) {
-        std::memcpy(def.SecurityAltID, packetData.data() + offset, sizeof(def.SecurityAltID));
-        offset += sizeof(def.SecurityAltID);
+    if (offset + sizeof(block.SecurityAltID) <= packetData.size()) {
+        std::memcpy(block.SecurityAltID, packetData.data() + offset, sizeof(block.SecurityAltID));
+        offset += sizeof(block.SecurityAltID);
     }
 
-    if (offset + sizeof(def.securityAltIDSource) <= packetData.size()) {
-        def.securityAltIDSource = parseType<SecurityAltIDSource>(offset);
+    if (offset + sizeof(block.securityAltIDSource) <= packetData.size()) {
+        block.securityAltIDSource = parseType<SecurityAltIDSource>(offset);
     }
 
-    if (offset + sizeof(def.SecurityType) <= packetData.size()) {
-        std::memcpy(def.SecurityType, packetData.data() + offset, sizeof(def.SecurityType));
-        offset += sizeof(def.SecurityType);
+    if (offset + sizeof(block.SecurityType) <= packetData.size()) {
+        std::memcpy(block.SecurityType, packetData.data() + offset, sizeof(block.SecurityType));
+        offset += sizeof(block.SecurityType);
     }
 
-    if (offset + sizeof(def.CFICode) <= packetData.size()) {
-        std::memcpy(def.CFICode, packetData.data() + offset, sizeof(def.CFICode));
-        offset += sizeof(def.CFICode);
+    if (offset + sizeof(block.CFICode) <= packetData.size()) {
+        std::memcpy(block.CFICode, packetData.data() + offset, sizeof(block.CFICode));
+        offset += sizeof(block.CFICode);
     }
 
-    if (offset + sizeof(def.StrikePrice) <= packetData.size()) {
-        def.StrikePrice = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.StrikePrice) <= packetData.size()) {
+        block.StrikePrice = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.ContractMultiplier) <= packetData.size()) {
-        def.ContractMultiplier = parseType<int32_t>(offset);
+    if (offset + sizeof(block.ContractMultiplier) <= packetData.size()) {
+        block.ContractMultiplier = parseType<int32_t>(offset);
     }
 
-    if (offset + sizeof(def.securityTradingStatus) <= packetData.size()) {
-        def.securityTradingStatus = parseType<SecurityTradingStatus>(offset);
+    if (offset + sizeof(block.securityTradingStatus) <= packetData.size()) {
+        block.securityTradingStatus = parseType<SecurityTradingStatus>(offset);
     }
 
-    if (offset + sizeof(def.Currency) <= packetData.size()) {
-        std::memcpy(def.Currency, packetData.data() + offset, sizeof(def.Currency));
-        offset += sizeof(def.Currency);
+    if (offset + sizeof(block.Currency) <= packetData.size()) {
+        std::memcpy(block.Currency, packetData.data() + offset, sizeof(block.Currency));
+        offset += sizeof(block.Currency);
     }
 
     // MarketID is static, no parsing needed
 
-    if (offset + sizeof(def.marketSegmentID) <= packetData.size()) {
-        def.marketSegmentID = parseType<MarketSegmentID>(offset);
+    if (offset + sizeof(block.marketSegmentID) <= packetData.size()) {
+        block.marketSegmentID = parseType<MarketSegmentID>(offset);
     }
 
-    if (offset + sizeof(def.tradingSessionID) <= packetData.size()) {
-        def.tradingSessionID = parseType<TradingSessionID>(offset);
+    if (offset + sizeof(block.tradingSessionID) <= packetData.size()) {
+        block.tradingSessionID = parseType<TradingSessionID>(offset);
     }
 
-    if (offset + sizeof(def.ExchangeTradingSessionID) <= packetData.size()) {
-        def.ExchangeTradingSessionID = parseType<int32_t>(offset);
+    if (offset + sizeof(block.ExchangeTradingSessionID) <= packetData.size()) {
+        block.ExchangeTradingSessionID = parseType<int32_t>(offset);
     }
 
-    if (offset + sizeof(def.Volatility) <= packetData.size()) {
-        def.Volatility = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.Volatility) <= packetData.size()) {
+        block.Volatility = parseType<Decimal5NULL>(offset);
     }
-    if (offset + sizeof(def.HighLimitPx) <= packetData.size()) {
-        def.HighLimitPx = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.HighLimitPx) <= packetData.size()) {
+        block.HighLimitPx = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.LowLimitPx) <= packetData.size()) {
-        def.LowLimitPx = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.LowLimitPx) <= packetData.size()) {
+        block.LowLimitPx = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.MinPriceIncrement) <= packetData.size()) {
-        def.MinPriceIncrement = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.MinPriceIncrement) <= packetData.size()) {
+        block.MinPriceIncrement = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.MinPriceIncrementAmount) <= packetData.size()) {
-        def.MinPriceIncrementAmount = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.MinPriceIncrementAmount) <= packetData.size()) {
+        block.MinPriceIncrementAmount = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.InitialMarginOnBuy) <= packetData.size()) {
-        def.InitialMarginOnBuy = parseType<Decimal2NULL>(offset);
+    if (offset + sizeof(block.InitialMarginOnBuy) <= packetData.size()) {
+        block.InitialMarginOnBuy = parseType<Decimal2NULL>(offset);
     }
 
-    if (offset + sizeof(def.InitialMarginOnSell) <= packetData.size()) {
-        def.InitialMarginOnSell = parseType<Decimal2NULL>(offset);
+    if (offset + sizeof(block.InitialMarginOnSell) <= packetData.size()) {
+        block.InitialMarginOnSell = parseType<Decimal2NULL>(offset);
     }
 
-    if (offset + sizeof(def.InitialMarginSyntetic) <= packetData.size()) {
-        def.InitialMarginSyntetic = parseType<Decimal2NULL>(offset);
+    if (offset + sizeof(block.InitialMarginSyntetic) <= packetData.size()) {
+        block.InitialMarginSyntetic = parseType<Decimal2NULL>(offset);
     }
 
-    if (offset + sizeof(def.TheorPrice) <= packetData.size()) {
-        def.TheorPrice = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.TheorPrice) <= packetData.size()) {
+        block.TheorPrice = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.TheorPriceLimit) <= packetData.size()) {
-        def.TheorPriceLimit = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.TheorPriceLimit) <= packetData.size()) {
+        block.TheorPriceLimit = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.UnderlyingQty) <= packetData.size()) {
-        def.UnderlyingQty = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.UnderlyingQty) <= packetData.size()) {
+        block.UnderlyingQty = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.UnderlyingCurrency) <= packetData.size()) {
-        std::memcpy(def.UnderlyingCurrency, packetData.data() + offset, sizeof(def.UnderlyingCurrency));
-        offset += sizeof(def.UnderlyingCurrency);
+    if (offset + sizeof(block.UnderlyingCurrency) <= packetData.size()) {
+        std::memcpy(block.UnderlyingCurrency, packetData.data() + offset, sizeof(block.UnderlyingCurrency));
+        offset += sizeof(block.UnderlyingCurrency);
     }
 
-    if (offset + sizeof(def.MaturityDate) <= packetData.size()) {
-        def.MaturityDate = parseType<uint32_t>(offset);
+    if (offset + sizeof(block.MaturityDate) <= packetData.size()) {
+        block.MaturityDate = parseType<uint32_t>(offset);
     }
 
-    if (offset + sizeof(def.MaturityTime) <= packetData.size()) {
-        def.MaturityTime = parseType<uint32_t>(offset);
+    if (offset + sizeof(block.MaturityTime) <= packetData.size()) {
+        block.MaturityTime = parseType<uint32_t>(offset);
     }
 
-    if (offset + sizeof(def.Flags) <= packetData.size()) {
-        def.Flags = parseType<FlagsSet>(offset);
+    if (offset + sizeof(block.Flags) <= packetData.size()) {
+        block.Flags = parseType<FlagsSet>(offset);
     }
 
-    if (offset + sizeof(def.MinPriceIncrementAmountCurr) <= packetData.size()) {
-        def.MinPriceIncrementAmountCurr = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.MinPriceIncrementAmountCurr) <= packetData.size()) {
+        block.MinPriceIncrementAmountCurr = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.SettlPriceOpen) <= packetData.size()) {
-        def.SettlPriceOpen = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.SettlPriceOpen) <= packetData.size()) {
+        block.SettlPriceOpen = parseType<Decimal5NULL>(offset);
     }
 
-    if (offset + sizeof(def.ValuationMethod) <= packetData.size()) {
-        std::memcpy(def.ValuationMethod, packetData.data() + offset, sizeof(def.ValuationMethod));
-        offset += sizeof(def.ValuationMethod);
+    if (offset + sizeof(block.ValuationMethod) <= packetData.size()) {
+        std::memcpy(block.ValuationMethod, packetData.data() + offset, sizeof(block.ValuationMethod));
+        offset += sizeof(block.ValuationMethod);
     }
 
-    if (offset + sizeof(def.RiskFreeRate) <= packetData.size()) {
-        def.RiskFreeRate = parseType<DoubleNULL>(offset);
+    if (offset + sizeof(block.RiskFreeRate) <= packetData.size()) {
+        block.RiskFreeRate = parseType<DoubleNULL>(offset);
     }
 
-    if (offset + sizeof(def.FixedSpotDiscount) <= packetData.size()) {
-        def.FixedSpotDiscount = parseType<DoubleNULL>(offset);
+    if (offset + sizeof(block.FixedSpotDiscount) <= packetData.size()) {
+        block.FixedSpotDiscount = parseType<DoubleNULL>(offset);
     }
 
-    if (offset + sizeof(def.ProjectedSpotDiscount) <= packetData.size()) {
-        def.ProjectedSpotDiscount = parseType<DoubleNULL>(offset);
+    if (offset + sizeof(block.ProjectedSpotDiscount) <= packetData.size()) {
+        block.ProjectedSpotDiscount = parseType<DoubleNULL>(offset);
     }
 
-    if (offset + sizeof(def.SettlCurrency) <= packetData.size()) {
-        std::memcpy(def.SettlCurrency, packetData.data() + offset, sizeof(def.SettlCurrency));
-        offset += sizeof(def.SettlCurrency);
+    if (offset + sizeof(block.SettlCurrency) <= packetData.size()) {
+        std::memcpy(block.SettlCurrency, packetData.data() + offset, sizeof(block.SettlCurrency));
+        offset += sizeof(block.SettlCurrency);
     }
 
-    if (offset + sizeof(def.negativePrices) <= packetData.size()) {
-        def.negativePrices = parseType<NegativePrices>(offset);
+    if (offset + sizeof(block.negativePrices) <= packetData.size()) {
+        block.negativePrices = parseType<NegativePrices>(offset);
     }
 
-    if (offset + sizeof(def.DerivativeContractMultiplier) <= packetData.size()) {
-        def.DerivativeContractMultiplier = parseType<int32_t>(offset);
+    if (offset + sizeof(block.DerivativeContractMultiplier) <= packetData.size()) {
+        block.DerivativeContractMultiplier = parseType<int32_t>(offset);
     }
 
-    if (offset + sizeof(def.InterestRateRiskUp) <= packetData.size()) {
-        def.InterestRateRiskUp = parseType<DoubleNULL>(offset);
+    if (offset + sizeof(block.InterestRateRiskUp) <= packetData.size()) {
+        block.InterestRateRiskUp = parseType<DoubleNULL>(offset);
     }
 
-    if (offset + sizeof(def.InterestRateRiskDown) <= packetData.size()) {
-        def.InterestRateRiskDown = parseType<DoubleNULL>(offset);
+    if (offset + sizeof(block.InterestRateRiskDown) <= packetData.size()) {
+        block.InterestRateRiskDown = parseType<DoubleNULL>(offset);
     }
 
-    if (offset + sizeof(def.RiskFreeRate2) <= packetData.size()) {
-        def.RiskFreeRate2 = parseType<DoubleNULL>(offset);
+    if (offset + sizeof(block.RiskFreeRate2) <= packetData.size()) {
+        block.RiskFreeRate2 = parseType<DoubleNULL>(offset);
     }
 
-    if (offset + sizeof(def.InterestRate2RiskUp) <= packetData.size()) {
-        def.InterestRate2RiskUp = parseType<DoubleNULL>(offset);
+    if (offset + sizeof(block.InterestRate2RiskUp) <= packetData.size()) {
+        block.InterestRate2RiskUp = parseType<DoubleNULL>(offset);
     }
 
-    if (offset + sizeof(def.InterestRate2RiskDown) <= packetData.size()) {
-        def.InterestRate2RiskDown = parseType<DoubleNULL>(offset);
+    if (offset + sizeof(block.InterestRate2RiskDown) <= packetData.size()) {
+        block.InterestRate2RiskDown = parseType<DoubleNULL>(offset);
     }
 
-    if (offset + sizeof(def.SettlPrice) <= packetData.size()) {
-        def.SettlPrice = parseType<Decimal5NULL>(offset);
+    if (offset + sizeof(block.SettlPrice) <= packetData.size()) {
+        block.SettlPrice = parseType<Decimal5NULL>(offset);
     }
 
-    def.NoMDFeedTypes = parseType<GroupSize>(offset);
-    def.MDFeedTypesEntries = std::make_unique<std::vector<SecurityDefinition::MDFeedTypes>>(std::move(parseVectorType<SecurityDefinition::MDFeedTypes>(offset, def.NoMDFeedTypes)));
+    return block;
+}
 
-    def.NoUnderlyings = parseType<GroupSize>(offset);
-    def.UnderlyingsEntries = std::make_unique<std::vector<SecurityDefinition::Underlyings>>(std::move(parseVectorType<SecurityDefinition::Underlyings>(offset, def.NoUnderlyings)));
+// Steps over a message without materializing it: the root block by blockLength, each repeating group
+// by its own header and then the length prefixed var data fields
+void SIMBADecoder::skipMessage(size_t& offset, const MessageHeader& header) const noexcept
+{
+    offset += header.blockLength;
 
-    def.NoLegs = parseType<GroupSize>(offset);
-    def.LegsEntries = std::make_unique<std::vector<SecurityDefinition::Legs>>(std::move(parseVectorType<SecurityDefinition::Legs>(offset, def.NoMDFeedTypes)));
+    const TemplateLayout layout = templateLayout(header.templateId);
+    for (uint8_t group = 0; group < layout.numGroups; ++group)
+    {
+        if (layout.groupSize2)
+        {
+            GroupSize2 groupSize = parseType<GroupSize2>(offset);
+            offset += static_cast<size_t>(groupSize.blockLength) * groupSize.numInGroup;
+        }
+        else
+        {
+            GroupSize groupSize = parseType<GroupSize>(offset);
+            offset += static_cast<size_t>(groupSize.blockLength) * groupSize.numInGroup;
+        }
+    }
 
-    def.NoInstrAttrib = parseType<GroupSize>(offset);
-    def.InstrAttribEntries = std::make_unique<std::vector<SecurityDefinition::InstrAttrib>>(std::move(parseVectorType<SecurityDefinition::InstrAttrib>(offset, def.NoMDFeedTypes)));
+    for (uint8_t field = 0; field < layout.numVarData; ++field)
+        offset += parseType<uint16_t>(offset);
+}
 
-    def.NoEvents = parseType<GroupSize>(offset);
-    def.EventsEntries = std::make_unique<std::vector<SecurityDefinition::Events>>(std::move(parseVectorType<SecurityDefinition::Events>(offset, def.NoMDFeedTypes)));
+constexpr size_t SIMBADecoder::templateSlot(uint16_t templateId) noexcept
+{
+    if (templateId < 48)
+        return templateId;
+    if (templateId >= 1000 && templateId < 1000 + (TEMPLATE_SLOTS - 48))
+        return templateId - 1000 + 48;
+    return 0; // Template 0 is never assigned, its slot skips the message
+}
+
+constexpr size_t SIMBADecoder::versionSlot(uint16_t version) noexcept
+{
+    return version < MAX_SCHEMA_VERSION ? version : MAX_SCHEMA_VERSION;
+}
 
-    auto SecurityDescLength = parseType<uint16_t>(offset);
-    def.SecurityDesc = parseType<Utf8String>(offset);
-    auto QuotationListLength = parseType<uint16_t>(offset);
-    def.QuotationList = parseType<VarString>(offset);
+template<typename T, typename Wire>
+void SIMBADecoder::decodeFixed(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const
+{
+    if constexpr (std::is_same_v<T, Wire>)
+        packet.messages.emplace_back(parseBlock<T>(offset, header.blockLength));
+    else
+        packet.messages.emplace_back(upgrade(parseBlock<Wire>(offset, header.blockLength)));
+}
 
-    return def;
+template<typename Entry>
+void SIMBADecoder::decodeOrderBookSnapshot(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const
+{
+    packet.messages.emplace_back(parseOrderBookSnapshot<Entry>(offset, header.blockLength));
+}
+
+void SIMBADecoder::decodeSecurityDefinition(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const
+{
+    packet.messages.emplace_back(parseSecurityDefinition(offset, header.blockLength));
+}
+
+void SIMBADecoder::decodeBestPrices(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const
+{
+    BestPrices bestPrices{};
+    offset += header.blockLength; // No root fields, only the group
+
+    bestPrices.NoMDEntries = parseType<GroupSize>(offset);
+    bestPrices.MDEntries = parseVectorType<BestPricesEntry>(offset, bestPrices.NoMDEntries);
+    packet.messages.emplace_back(std::move(bestPrices));
+}
+
+void SIMBADecoder::decodeSecurityMassStatus(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const
+{
+    SecurityMassStatus massStatus{};
+    offset += header.blockLength; // No root fields, only the group
+
+    massStatus.NoRelatedSym = parseType<GroupSize2>(offset);
+    massStatus.Entries = parseVectorType<SecurityMassStatusEntry>(offset, massStatus.NoRelatedSym);
+    packet.messages.emplace_back(std::move(massStatus));
+}
+
+void SIMBADecoder::decodeSkipped(size_t& offset, const MessageHeader& header, SIMBAPacket&) const
+{
+    skipMessage(offset, header);
+}
+
+// Schema version 3: only the order templates without MDFlags2. The layouts of its other templates are
+// not known to match version 4, so they are stepped over rather than decoded with the version 4 structs
+template<>
+constexpr void SIMBADecoder::registerTemplates<3>(DispatchTable& table) noexcept
+{
+    auto& templates = table[3];
+    templates[templateSlot(5)] = &SIMBADecoder::decodeFixed<OrderUpdate, OrderUpdateV3>;
+    templates[templateSlot(6)] = &SIMBADecoder::decodeFixed<OrderExecution, OrderExecutionV3>;
+    templates[templateSlot(7)] = &SIMBADecoder::decodeOrderBookSnapshot<OrderBookSnapshotEntryV3>;
+}
+
+void TemplateFilter::addMessage(uint16_t templateId)
+{
+    add(templateId);
+    switch (templateId) // The version 3 IDs registered above
+    {
+    case MessageTraits<OrderUpdate>::templateId: add(5); break;
+    case MessageTraits<OrderExecution>::templateId: add(6); break;
+    case MessageTraits<OrderBookSnapshot>::templateId: add(7); break;
+    default: break;
+    }
+}
+
+// Schema version 4 (SIMBA 4.x)
+template<>
+constexpr void SIMBADecoder::registerTemplates<4>(DispatchTable& table) noexcept
+{
+    auto& templates = table[4];
+    templates[templateSlot(1)] = &SIMBADecoder::decodeFixed<Heartbeat>;
+    templates[templateSlot(2)] = &SIMBADecoder::decodeFixed<SequenceReset>;
+    templates[templateSlot(3)] = &SIMBADecoder::decodeBestPrices;
+    templates[templateSlot(4)] = &SIMBADecoder::decodeFixed<EmptyBook>;
+    templates[templateSlot(9)] = &SIMBADecoder::decodeFixed<SecurityStatus>;
+    templates[templateSlot(10)] = &SIMBADecoder::decodeFixed<SecurityDefinitionUpdateReport>;
+    templates[templateSlot(11)] = &SIMBADecoder::decodeFixed<TradingSessionStatus>;
+    templates[templateSlot(15)] = &SIMBADecoder::decodeFixed<OrderUpdate>;
+    templates[templateSlot(16)] = &SIMBADecoder::decodeFixed<OrderExecution>;
+    templates[templateSlot(17)] = &SIMBADecoder::decodeOrderBookSnapshot<OrderBookSnapshotEntry>;
+    templates[templateSlot(18)] = &SIMBADecoder::decodeSecurityDefinition;
+    templates[templateSlot(19)] = &SIMBADecoder::decodeSecurityMassStatus;
+    templates[templateSlot(1000)] = &SIMBADecoder::decodeFixed<Logon>;
+    templates[templateSlot(1001)] = &SIMBADecoder::decodeFixed<Logout>;
+    templates[templateSlot(1002)] = &SIMBADecoder::decodeFixed<MarketDataRequest>;
+}
+
+// Every (version, template) pair without a decoder steps over the message. Versions older than the
+// oldest registered one have no decoders at all, anything newer than MAX_SCHEMA_VERSION shares its row
+constexpr SIMBADecoder::DispatchTable SIMBADecoder::buildDispatchTable() noexcept
+{
+    DispatchTable table{};
+    for (auto& templates : table)
+        templates.fill(&SIMBADecoder::decodeSkipped);
+
+    registerTemplates<3>(table);
+    registerTemplates<4>(table);
+    return table;
+}
+
+const SIMBADecoder::DispatchTable& SIMBADecoder::dispatchTable() noexcept
+{
+    static constexpr DispatchTable table = buildDispatchTable();
+    return table;
 }
 
 SIMBADecoder::~SIMBADecoder()
@@ -1,10 +1,43 @@
 #pragma once
 
+#include <array>
+#include <bitset>
+#include <string>
 #include <vector>
 #include <span>
 #include <variant>
 
 #include "SIMBA_Schema.hpp"
+#include "SIMBA_Messages.hpp"
+
+// Set of template IDs that are fully decoded. Every other message is stepped over by its blockLength
+// and group headers without being materialized
+class TemplateFilter
+{
+public:
+	static constexpr size_t MAX_TEMPLATE_ID = 1024; // Logon, Logout and MarketDataRequest live in the 1000 range
+
+	TemplateFilter() = default; // An empty filter decodes every template
+
+	// Builds a filter from a comma separated list such as "15,16"
+	static TemplateFilter parse(const std::string& templateList);
+
+	void add(uint16_t templateId);
+
+	// Adds a message's template ID along with the IDs older schema versions send the same message under,
+	// such as 5 for OrderUpdate (15) in version 3
+	void addMessage(uint16_t templateId);
+
+	bool decodesAll() const noexcept { return acceptAll; }
+	bool accepts(uint16_t templateId) const noexcept
+	{
+		return acceptAll || (templateId < MAX_TEMPLATE_ID && templates.test(templateId));
+	}
+
+private:
+	std::bitset<MAX_TEMPLATE_ID> templates;
+	bool acceptAll = true;
+};
 
 class SIMBADecoder {
 /*
@@ -16,10 +49,11 @@ Focus on decoding messages like OrderUpdate, OrderExecution, and OrderBookSnapsh
 */
 public:
 
-	SIMBADecoder(std::span<const char> packetData);
+	SIMBADecoder(std::span<const char> packetData, const TemplateFilter* filter = nullptr);
     ~SIMBADecoder();
 
 	SIMBAPacket decode();
+	void decode(SIMBAPacket& packet); // Reuses the packet's message storage
 
 private: //Parser functions
 		
@@ -27,12 +61,53 @@ private: //Parser functions
 	inline T parseType(size_t& offset) const noexcept;
 
 	template<typename T>
-	inline std::vector<T> parseVectorType(size_t& offset, const GroupSize& numElements) const noexcept;
+	inline T parseBlock(size_t& offset, uint16_t blockLength) const noexcept;
+
+	template<typename T, typename Wire = T, typename Group>
+	inline std::vector<T> parseVectorType(size_t& offset, const Group& numElements) const noexcept;
+	template<typename T, typename Wire = T, typename Group>
+	std::vector<T> parseVectorTypeTruncated(size_t& offset, const Group& numElements) const noexcept;
+
+	template<typename T>
+	inline T parseVarData(size_t& offset) const noexcept;
+
+	template<typename Entry>
+	OrderBookSnapshot parseOrderBookSnapshot(size_t& offset, uint16_t blockLength) const noexcept;
+	SecurityDefinition parseSecurityDefinition(size_t& offset, uint16_t blockLength) const noexcept;
+	SecurityDefinitionBlock parseSecurityDefinitionTruncated(size_t offset) const noexcept;
+
+	void skipMessage(size_t& offset, const MessageHeader& header) const noexcept;
+
+private: // Per schema version dispatch
+
+	using DecodeFunction = void (SIMBADecoder::*)(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const;
+
+	static constexpr uint16_t MAX_SCHEMA_VERSION = 4; // Newer versions decode with the latest layouts, SBE only appends to blocks
+	static constexpr size_t VERSION_SLOTS = MAX_SCHEMA_VERSION + 1;
+	static constexpr size_t TEMPLATE_SLOTS = 64; // IDs below 48 map directly, session level IDs from 1000 map onto 48 and up
+
+	using DispatchTable = std::array<std::array<DecodeFunction, TEMPLATE_SLOTS>, VERSION_SLOTS>;
+
+	static constexpr size_t templateSlot(uint16_t templateId) noexcept;
+	static constexpr size_t versionSlot(uint16_t version) noexcept;
+
+	// Specialized once per supported schema version with the decoders of every template it defines
+	template<uint16_t Version>
+	static constexpr void registerTemplates(DispatchTable& table) noexcept;
+	static constexpr DispatchTable buildDispatchTable() noexcept;
+	static const DispatchTable& dispatchTable() noexcept;
 
-	OrderBookSnapshot parseOrderBookSnapshot(size_t& offset) const noexcept;
-	SecurityDefinition parseSecurityDefinition(size_t& offset) const noexcept;
+	template<typename T, typename Wire = T>
+	void decodeFixed(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const;
+	template<typename Entry>
+	void decodeOrderBookSnapshot(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const;
+	void decodeSecurityDefinition(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const;
+	void decodeBestPrices(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const;
+	void decodeSecurityMassStatus(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const;
+	void decodeSkipped(size_t& offset, const MessageHeader& header, SIMBAPacket& packet) const;
 
 private:
 
 	std::span<const char> packetData;
+	const TemplateFilter* filter; // nullptr decodes every template
 };
\ No newline at end of file
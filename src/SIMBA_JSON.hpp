@@ -1,697 +1,819 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <optional>
 #include <ostream>
-#include <sstream>
-#include <string>
+#include <span>
+#include <string_view>
+#include <type_traits>
 #include <variant>
-#include <iomanip>
-#include <cmath>
-
-#include <iostream>
+#include <vector>
 
+#include "Field_Projection.hpp"
+#include "JSON_Writer.hpp"
 #include "SIMBA_Schema.hpp"
+#include "SIMBA_Messages.hpp"
+
+// JSON text of the decoded messages, appended to a JSONWriter. Enum and flag names come from tables
+// built at compile time and indexed by the value, instead of a switch per value written
+
+namespace SIMBAJSON
+{
+	using Names = std::array<std::string_view, 256>;
+
+	// Names of an 8 bit enum, indexed by its value as unsigned
+	template<typename Enum, size_t N>
+	constexpr Names enumNames(const std::pair<Enum, std::string_view> (&known)[N], std::string_view unknown)
+	{
+		Names names{};
+		names.fill(unknown);
+		for (const auto& [value, name] : known)
+			names[static_cast<uint8_t>(value)] = name;
+		return names;
+	}
+
+	// Names of the bits of a 64 bit flag set, indexed by bit number
+	template<typename Flag, size_t N>
+	constexpr std::array<std::string_view, 64> flagNames(const std::pair<Flag, std::string_view> (&known)[N], std::string_view unknown)
+	{
+		std::array<std::string_view, 64> names{};
+		names.fill(unknown);
+		for (const auto& [flag, name] : known)
+			names[std::countr_zero(static_cast<uint64_t>(flag))] = name;
+		return names;
+	}
+
+	// Names are written as they are, quotes included where the output has them
+	constexpr Names MD_UPDATE_ACTION_NAMES = enumNames<MDUpdateAction>({
+		{ MDUpdateAction::New, "\"New\"" },
+		{ MDUpdateAction::Change, "\"Change\"" },
+		{ MDUpdateAction::Delete, "\"Delete\"" } }, "\"Unknown MDUpdateAction\"");
+
+	constexpr Names MD_ENTRY_TYPE_NAMES = enumNames<MDEntryType>({
+		{ MDEntryType::Bid, "Bid" },
+		{ MDEntryType::Offer, "Offer" },
+		{ MDEntryType::EmptyBook, "EmptyBook" } }, "Unknown MDEntryType");
+
+	constexpr Names NEGATIVE_PRICES_NAMES = enumNames<NegativePrices>({
+		{ NegativePrices::NotEligible, "NotEligible" },
+		{ NegativePrices::Eligible, "Eligible" } }, "Unknown value");
+
+	constexpr Names TRADING_SESSION_ID_NAMES = enumNames<TradingSessionID>({
+		{ TradingSessionID::Day, "Day" },
+		{ TradingSessionID::Morning, "Morning" },
+		{ TradingSessionID::Evening, "Evening" } }, "Null");
+
+	constexpr Names SECURITY_TRADING_STATUS_NAMES = enumNames<SecurityTradingStatus>({
+		{ SecurityTradingStatus::TradingHalt, "TradingHalt" },
+		{ SecurityTradingStatus::ReadyToTrade, "ReadyToTrade" },
+		{ SecurityTradingStatus::NotAvailableForTrading, "NotAvailableForTrading" },
+		{ SecurityTradingStatus::NotTradedOnThisMarket, "NotTradedOnThisMarket" },
+		{ SecurityTradingStatus::UnknownOrInvalid, "UnknownOrInvalid" },
+		{ SecurityTradingStatus::PreOpen, "PreOpen" },
+		{ SecurityTradingStatus::DiscreteAuctionOpen, "DiscreteAuctionOpen" },
+		{ SecurityTradingStatus::DiscreteAuctionClose, "DiscreteAuctionClose" },
+		{ SecurityTradingStatus::InstrumentHalt, "InstrumentHalt" } }, "Unknown");
+
+	constexpr Names SECURITY_ALT_ID_SOURCE_NAMES = enumNames<SecurityAltIDSource>({
+		{ SecurityAltIDSource::ISIN, "ISIN" },
+		{ SecurityAltIDSource::ExchangeSymbol, "ExchangeSymbol" } }, "Unknown SecurityAltIDSource");
+
+	constexpr Names MARKET_SEGMENT_ID_NAMES = enumNames<MarketSegmentID>({
+		{ MarketSegmentID::Derivatives, "Derivatives" } }, "Unknown MarketSegmentID");
+
+	// Unknown instrument flags are left out, unknown order flags are written as "unknown"
+	constexpr std::array<std::string_view, 64> FLAGS_SET_NAMES = flagNames<FlagsSet>({
+		{ FlagsSet::EveningOrMorningSession, "\"eveningOrMorningSession\"" },
+		{ FlagsSet::AnonymousTrading, "\"anonymousTrading\"" },
+		{ FlagsSet::PrivateTrading, "\"privateTrading\"" },
+		{ FlagsSet::DaySession, "\"daySession\"" },
+		{ FlagsSet::MultiLeg, "\"multiLeg\"" },
+		{ FlagsSet::Collateral, "\"collateral\"" },
+		{ FlagsSet::IntradayExercise, "\"intradayExercise\"" } }, "");
+
+	constexpr std::array<std::string_view, 64> MD_FLAGS_SET_NAMES = flagNames<MDFlagsSet>({
+		{ MDFlagsSet::Day, "\"day\"" },
+		{ MDFlagsSet::IOC, "\"ioc\"" },
+		{ MDFlagsSet::NonQuote, "\"nonQuote\"" },
+		{ MDFlagsSet::EndOfTransaction, "\"endOfTransaction\"" },
+		{ MDFlagsSet::DueToCrossCancel, "\"dueToCrossCancel\"" },
+		{ MDFlagsSet::SecondLeg, "\"secondLeg\"" },
+		{ MDFlagsSet::FOK, "\"fok\"" },
+		{ MDFlagsSet::Replace, "\"replace\"" },
+		{ MDFlagsSet::Cancel, "\"cancel\"" },
+		{ MDFlagsSet::MassCancel, "\"massCancel\"" },
+		{ MDFlagsSet::Negotiated, "\"negotiated\"" },
+		{ MDFlagsSet::MultiLeg, "\"multiLeg\"" },
+		{ MDFlagsSet::CrossTrade, "\"crossTrade\"" },
+		{ MDFlagsSet::NegotiatedMatchByRef, "\"negotiatedMatchByRef\"" },
+		{ MDFlagsSet::COD, "\"cod\"" },
+		{ MDFlagsSet::ActiveSide, "\"activeSide\"" },
+		{ MDFlagsSet::PassiveSide, "\"passiveSide\"" },
+		{ MDFlagsSet::Synthetic, "\"synthetic\"" },
+		{ MDFlagsSet::RFS, "\"rfs\"" },
+		{ MDFlagsSet::SyntheticPassive, "\"syntheticPassive\"" },
+		{ MDFlagsSet::BOC, "\"boc\"" },
+		{ MDFlagsSet::DuringDiscreteAuction, "\"duringDiscreteAuction\"" } }, "\"unknown\"");
+
+	template<typename Enum>
+	inline std::string_view name(const Names& names, Enum value)
+	{
+		return names[static_cast<uint8_t>(value)];
+	}
+
+	// Set bits in ascending order, bits without a name skipped
+	inline void flags(JSONWriter& out, uint64_t bits, const std::array<std::string_view, 64>& names)
+	{
+		out.append('[');
+		bool first = true;
+		for (; bits != 0; bits &= bits - 1)
+		{
+			const std::string_view flag = names[std::countr_zero(bits)];
+			if (flag.empty())
+				continue;
+			if (!first)
+				out.append(", ");
+			out.append(flag);
+			first = false;
+		}
+		out.append(']');
+	}
+
+	template<size_t N>
+	inline void chars(JSONWriter& out, const char (&field)[N])
+	{
+		out.trimmed(field, N);
+	}
+
+	inline void mantissa(JSONWriter& out, int64_t mantissa, int8_t exponent, bool nullable)
+	{
+		out.append("{\"mantissa\":");
+		if (nullable && mantissa == Decimal5NULL::NULL_VALUE)
+			out.append("null");
+		else
+			out.integer(mantissa);
+		out.append(",\"exponent\":");
+		out.integer(static_cast<int>(exponent));
+		out.append('}');
+	}
+}
+
+inline void writeJSON(JSONWriter& out, MsgFlagsSet flag)
+{
+	switch (flag)
+	{
+	case MsgFlagsSet::LastFragment: out.append("LastFragment"); break;
+	case MsgFlagsSet::StartOfSnapshot: out.append("StartOfSnapshot"); break;
+	case MsgFlagsSet::EndOfSnapshot: out.append("EndOfSnapshot"); break;
+	case MsgFlagsSet::IncrementalPacket: out.append("IncrementalPacket"); break;
+	case MsgFlagsSet::PossDupFlag: out.append("PossDupFlag"); break;
+	default: out.append("Unknown MsgFlagsSet"); break;
+	}
+}
+
+template<std::integral T>
+inline void writeJSON(JSONWriter& out, T value)
+{
+	out.integer(value);
+}
 
-// MsgFlagsSet stream operator
-std::ostream& operator<<(std::ostream& os, const MsgFlagsSet& entryType)
-{
-    switch (entryType)
-   
-{
-    case MsgFlagsSet::LastFragment:
-        os << "LastFragment";
-        break;
-    case MsgFlagsSet::StartOfSnapshot:
-        os << "StartOfSnapshot";
-        break;
-    case MsgFlagsSet::EndOfSnapshot:
-        os << "EndOfSnapshot";
-        break;
-    case MsgFlagsSet::IncrementalPacket:
-        os << "IncrementalPacket";
-        break;
-    case MsgFlagsSet::PossDupFlag:
-        os << "PossDupFlag";
-        break;
-    default:
-        os << "Unknown MsgFlagsSet";
-        break;
-    }
-    return os;
-}
-
-// For any optional type
 template<typename T>
-inline std::ostream& operator<<(std::ostream& os, const std::optional<T> opt)
+inline void writeJSON(JSONWriter& out, const std::optional<T>& opt)
 {
-    if (opt.has_value())
-        os << opt.value();
-    else
-        os << 0;
+	if (opt.has_value())
+		writeJSON(out, opt.value());
+	else
+		out.append('0');
+}
 
-    return os;
+template<typename T>
+inline void writeJSON(JSONWriter& out, std::span<const T> elements)
+{
+	out.append('[');
+	for (size_t i = 0; i < elements.size(); ++i)
+	{
+		if (i != 0)
+			out.append(", ");
+		writeJSON(out, elements[i]);
+	}
+	out.append(']');
 }
 
-// Overload operator<< for std::vector<T>
 template<typename T>
-inline std::ostream& operator<<(std::ostream& os, const std::vector<T>& vec)
-{
-    if (vec.size() < 1)
-    {
-        os << "[]";
-        return os;
-    }
-
-    os << "[";
-    for (size_t i = 0; i < vec.size(); ++i)
-    {
-        os << vec[i];
-        if (i != vec.size() - 1)
-        {
-            os << ", "; // Add a comma and space between elements
-        }
-    }
-    os << "]";
-    return os;
-}
-
-// Overload operator<< for std::span<T>
-template <typename T>
-std::ostream& operator<<(std::ostream& os, const std::span<T>& span) {
-    os << "[";
-    for (size_t i = 0; i < span.size(); ++i) {
-        os << span[i];
-        if (i != span.size() - 1) {
-            os << ", ";
-        }
-    }
-    os << "]";
-    return os;
-}
-
-// Decimal5 stream operator
-inline std::ostream& operator<<(std::ostream& os, const Decimal5& decimal)
-{
-    os << "{\"mantissa\":" << decimal.mantissa << ",\"exponent\":" << static_cast<int>(decimal.exponent) << "}";
-    return os;
-}
-
-// Decimal5NULL stream operator
-inline std::ostream& operator<<(std::ostream& os, const Decimal5NULL& decimal)
-{
-    os << "{\"mantissa\":";
-    if (decimal.mantissa == Decimal5NULL::NULL_VALUE)
-        os << "null";
-    else
-        os << decimal.mantissa;
-    os << ",\"exponent\":" << static_cast<int>(decimal.exponent) << "}";
-    return os;
-}
-
-// DoubleNULL stream operator
-inline std::ostream& operator<<(std::ostream& os, const DoubleNULL& dbl)
-{
-    if (dbl.value == DoubleNULL::NULL_VALUE || std::isnan(dbl.value))
-        os << "null";
-    else
-        os << dbl.value;
-    return os;
-}
-
-// Decimal2NULL stream operator
-inline std::ostream& operator<<(std::ostream& os, const Decimal2NULL& decimal)
-{
-    os << "{\"mantissa\":";
-    if (decimal.mantissa == Decimal5NULL::NULL_VALUE)
-        os << "null";
-    else
-        os << decimal.mantissa;
-    os << ",\"exponent\":" << static_cast<int>(decimal.exponent) << "}";
-    return os;
-}
-
-// Overload operator<< for MDUpdateAction
-std::ostream& operator<<(std::ostream& os, const MDUpdateAction& action)
-{
-    switch (action)
-   
-{
-    case MDUpdateAction::New: os << "\"New\""; break;
-    case MDUpdateAction::Change: os << "\"Change\""; break;
-    case MDUpdateAction::Delete: os << "\"Delete\""; break;
-    default: os << "Unknown MDUpdateAction"; break;
-    }
-    return os;
-}
-
-// Overload operator<< for MDEntryType
-std::ostream& operator<<(std::ostream& os, const MDEntryType& entryType)
-{
-    switch (entryType)
-   
-{
-    case MDEntryType::Bid:
-        os << "Bid";
-        break;
-    case MDEntryType::Offer:
-        os << "Offer";
-        break;
-    case MDEntryType::EmptyBook:
-        os << "EmptyBook";
-        break;
-    default:
-        os << "Unknown MDEntryType";
-        break;
-    }
-    return os;
-}
-
-// Helper function to map a flag to its string name
-std::string FlagsSetToString(const FlagsSet& flag)
-{
-    switch (flag)
-    {
-    case FlagsSet::EveningOrMorningSession: return "eveningOrMorningSession";
-    case FlagsSet::AnonymousTrading: return "anonymousTrading";
-    case FlagsSet::PrivateTrading: return "privateTrading";
-    case FlagsSet::DaySession: return "daySession";
-    case FlagsSet::MultiLeg: return "multiLeg";
-    case FlagsSet::Collateral: return "collateral";
-    case FlagsSet::IntradayExercise: return "intradayExercise";
-    default: return "";
-    }
-}
-
-// Overload operator<< for FlagsSet
-std::ostream& operator<<(std::ostream& os, const FlagsSet& value)
-{
-    os << "[";
-
-    bool first = true; // To manage commas between flags
-    for (uint64_t bit = 0; bit < 64; ++bit) {
-        uint64_t flagBit = 1ULL << bit;
-
-        if (static_cast<uint64_t>(value) & flagBit) {
-            // Get the string representation of the flag
-            auto status = FlagsSetToString(static_cast<FlagsSet>(flagBit));
-
-            // If the status is not empty, add it to the stream
-            if (!status.empty()) {
-                if (!first) {
-                    os << ", ";
-                }
-                os << "\"" << status << "\"";
-                first = false; // Update to indicate a non-empty item was added
-            }
-        }
-    }
-
-    os << "]";
-
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const NegativePrices& value)
-{
-    switch (value)
-{
-    case NegativePrices::NotEligible:
-        os << "NotEligible";
-        break;
-    case NegativePrices::Eligible:
-        os << "Eligible";
-        break;
-    default:
-        os << "Unknown value";
-        break;
-    }
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const TradingSessionID& sessionID)
-{
-    switch (sessionID)
-{
-    case TradingSessionID::Day:
-        os << "Day";
-        break;
-    case TradingSessionID::Morning:
-        os << "Morning";
-        break;
-    case TradingSessionID::Evening:
-        os << "Evening";
-        break;
-    default:
-        os << "Null";
-        break;
-    }
-    return os;
-}
-
-// Helper function to map a flag to its string name
-std::string MDFlagSetToString(const MDFlagsSet& flag)
-{
-    switch (flag)
-   
-{
-    case MDFlagsSet::Day: return "day";
-    case MDFlagsSet::IOC: return "ioc";
-    case MDFlagsSet::NonQuote: return "nonQuote";
-    case MDFlagsSet::EndOfTransaction: return "endOfTransaction";
-    case MDFlagsSet::DueToCrossCancel: return "dueToCrossCancel";
-    case MDFlagsSet::SecondLeg: return "secondLeg";
-    case MDFlagsSet::FOK: return "fok";
-    case MDFlagsSet::Replace: return "replace";
-    case MDFlagsSet::Cancel: return "cancel";
-    case MDFlagsSet::MassCancel: return "massCancel";
-    case MDFlagsSet::Negotiated: return "negotiated";
-    case MDFlagsSet::MultiLeg: return "multiLeg";
-    case MDFlagsSet::CrossTrade: return "crossTrade";
-    case MDFlagsSet::NegotiatedMatchByRef: return "negotiatedMatchByRef";
-    case MDFlagsSet::COD: return "cod";
-    case MDFlagsSet::ActiveSide: return "activeSide";
-    case MDFlagsSet::PassiveSide: return "passiveSide";
-    case MDFlagsSet::Synthetic: return "synthetic";
-    case MDFlagsSet::RFS: return "rfs";
-    case MDFlagsSet::SyntheticPassive: return "syntheticPassive";
-    case MDFlagsSet::BOC: return "boc";
-    case MDFlagsSet::DuringDiscreteAuction: return "duringDiscreteAuction";
-    default: return "unknown";
-    }
+inline void writeJSON(JSONWriter& out, const std::vector<T>& elements)
+{
+	writeJSON(out, std::span<const T>(elements));
 }
 
-// Overload operator<< for MDFlagsSet
-std::ostream& operator<<(std::ostream& os, const MDFlagsSet& value)
-{    
-    os << "[";
+// A repeating group, at most numInGroup of the decoded entries
+template<typename T>
+inline void writeJSON(JSONWriter& out, const std::unique_ptr<std::vector<T>>& entries, size_t numInGroup)
+{
+	if (!entries)
+	{
+		out.append("[]");
+		return;
+	}
+	writeJSON(out, std::span<const T>(entries->data(), std::min(numInGroup, entries->size())));
+}
 
-    bool first = true; // To manage commas between flags
-    for (uint64_t bit = 0; bit < 64; ++bit)
-{
+inline void writeJSON(JSONWriter& out, const Decimal5& decimal)
+{
+	SIMBAJSON::mantissa(out, decimal.mantissa, Decimal5::exponent, false);
+}
 
-        uint64_t flagBit = 1ULL << bit;
-        
-        if (static_cast<uint64_t>(value) & flagBit)
+inline void writeJSON(JSONWriter& out, const Decimal5NULL& decimal)
 {
-            if (!first) os << ", ";
-            first = false;
+	SIMBAJSON::mantissa(out, decimal.mantissa, Decimal5NULL::exponent, true);
+}
 
-            os << "\"" << MDFlagSetToString(static_cast<MDFlagsSet>(flagBit)) << "\"";
-        }
-    }
+inline void writeJSON(JSONWriter& out, const Decimal2NULL& decimal)
+{
+	SIMBAJSON::mantissa(out, decimal.mantissa, Decimal2NULL::exponent, true);
+}
 
-    os << "]";
-    return os;
+inline void writeJSON(JSONWriter& out, const DoubleNULL& dbl)
+{
+	if (!std::isfinite(dbl.value)) // NULL_VALUE is a NaN, and JSON has no infinities either
+		out.append("null");
+	else
+		out.floating(dbl.value);
+}
+
+inline void writeJSON(JSONWriter& out, MDUpdateAction action) { out.append(SIMBAJSON::name(SIMBAJSON::MD_UPDATE_ACTION_NAMES, action)); }
+inline void writeJSON(JSONWriter& out, MDEntryType entryType) { out.append(SIMBAJSON::name(SIMBAJSON::MD_ENTRY_TYPE_NAMES, entryType)); }
+inline void writeJSON(JSONWriter& out, NegativePrices value) { out.append(SIMBAJSON::name(SIMBAJSON::NEGATIVE_PRICES_NAMES, value)); }
+inline void writeJSON(JSONWriter& out, TradingSessionID sessionID) { out.append(SIMBAJSON::name(SIMBAJSON::TRADING_SESSION_ID_NAMES, sessionID)); }
+inline void writeJSON(JSONWriter& out, SecurityTradingStatus status) { out.append(SIMBAJSON::name(SIMBAJSON::SECURITY_TRADING_STATUS_NAMES, status)); }
+inline void writeJSON(JSONWriter& out, SecurityAltIDSource source) { out.append(SIMBAJSON::name(SIMBAJSON::SECURITY_ALT_ID_SOURCE_NAMES, source)); }
+inline void writeJSON(JSONWriter& out, MarketSegmentID segment) { out.append(SIMBAJSON::name(SIMBAJSON::MARKET_SEGMENT_ID_NAMES, segment)); }
+
+inline void writeJSON(JSONWriter& out, FlagsSet value)
+{
+	SIMBAJSON::flags(out, static_cast<uint64_t>(value), SIMBAJSON::FLAGS_SET_NAMES);
 }
 
-// Overload operator<< for MDFlags2Set
-std::ostream& operator<<(std::ostream& os, const MDFlags2Set& value)
+inline void writeJSON(JSONWriter& out, MDFlagsSet value)
 {
-    os << "[]"; // Schema does not specify any contents
-    return os;
+	SIMBAJSON::flags(out, static_cast<uint64_t>(value), SIMBAJSON::MD_FLAGS_SET_NAMES);
 }
 
-std::string SecurityTradingStatusToString(const SecurityTradingStatus& status)
+inline void writeJSON(JSONWriter& out, const MDFlags2Set&)
 {
-    switch (status)
+	out.append("[]"); // Schema does not specify any contents
+}
+
+inline void writeJSON(JSONWriter& out, const MessageHeader& header)
 {
-    case SecurityTradingStatus::TradingHalt: return "TradingHalt";
-    case SecurityTradingStatus::ReadyToTrade: return "ReadyToTrade";
-    case SecurityTradingStatus::NotAvailableForTrading: return "NotAvailableForTrading";
-    case SecurityTradingStatus::NotTradedOnThisMarket: return "NotTradedOnThisMarket";
-    case SecurityTradingStatus::UnknownOrInvalid: return "UnknownOrInvalid";
-    case SecurityTradingStatus::PreOpen: return "PreOpen";
-    case SecurityTradingStatus::DiscreteAuctionOpen: return "DiscreteAuctionOpen";
-    case SecurityTradingStatus::DiscreteAuctionClose: return "DiscreteAuctionClose";
-    case SecurityTradingStatus::InstrumentHalt: return "InstrumentHalt";
-    default: return "Unknown";
-    }
-}
-
-std::ostream& operator<<(std::ostream& os, const SecurityTradingStatus& status)
-{
-    os << SecurityTradingStatusToString(status);
-    return os;
-}
-
-
-// MessageHeader stream operator
-inline std::ostream& operator<<(std::ostream& os, const MessageHeader& header)
-{
-    os << "{\"blockLength\":" << header.blockLength
-        << ",\"templateId\":" << header.templateId
-        << ",\"schemaId\":" << header.schemaId
-        << ",\"version\":" << header.version << "}";
-    return os;
+	out.append("{\"blockLength\":");
+	out.integer(header.blockLength);
+	out.append(",\"templateId\":");
+	out.integer(header.templateId);
+	out.append(",\"schemaId\":");
+	out.integer(header.schemaId);
+	out.append(",\"version\":");
+	out.integer(header.version);
+	out.append('}');
 }
 
-// MarketDataPacketHeader stream operator
-inline std::ostream& operator<<(std::ostream& os, const MarketDataPacketHeader& packetHeader)
+inline void writeJSON(JSONWriter& out, const MarketDataPacketHeader& packetHeader)
 {
-    os << "{\"MsgSeqNum\":" << packetHeader.MsgSeqNum
-        << ",\"MsgSize\":" << packetHeader.MsgSize
-        << ",\"MsgFlags\":" << packetHeader.MsgFlags
-        << ",\"SendingTime\":" << packetHeader.SendingTime << "}";
-    return os;
-}
-
-// SecurityAltIDSource stream operator
-std::ostream& operator<<(std::ostream& os, const SecurityAltIDSource& entryType)
-{
-    switch (entryType)
-   
-{
-    case SecurityAltIDSource::ISIN:
-        os << "ISIN";
-        break;
-    case SecurityAltIDSource::ExchangeSymbol:
-        os << "ExchangeSymbol";
-        break;
-    default:
-        os << "Unknown SecurityAltIDSource";
-        break;
-    }
-    return os;
-}
-
-// MarketSegmentID stream operator
-std::ostream& operator<<(std::ostream& os, const MarketSegmentID& entryType)
-{
-    switch (entryType)
-   
-{
-    case MarketSegmentID::Derivatives:
-        os << "Derivatives";
-        break;
-    default:
-        os << "Unknown MarketSegmentID";
-        break;
-    }
-    return os;
-}
-
-// IncrementalPacketHeader stream operator
-inline std::ostream& operator<<(std::ostream& os, const IncrementalPacketHeader& packetHeader)
-{
-    os << "{\"TransactTime\":" << packetHeader.TransactTime
-        << ",\"ExchangeTradingSessionID\":" << packetHeader.ExchangeTradingSessionID << "}";
-    return os;
-}
-
-// OrderUpdate stream operator
-inline std::ostream& operator<<(std::ostream& os, const OrderUpdate& update)
-{
-    os << "{\"Name\":\"OrderUpdate\","
-        << "\"MDEntryID\":" << update.MDEntryID
-        << ",\"MDEntryPx\":" << update.MDEntryPx
-        << ",\"MDEntrySize\":" << update.MDEntrySize
-        << ",\"MDFlags\":" << update.MDFlags
-        << ",\"MDFlags2\":" << update.MDFlags2
-        << ",\"SecurityID\":" << update.SecurityID
-        << ",\"RptSeq\":" << update.RptSeq
-        << ",\"MDUpdateAction\":" << update.mdUpdateAction
-        << ",\"MDEntryType\":\"" << update.mdEntryType << "\"}";
-    return os;
-}
-
-// OrderExecution stream operator
-inline std::ostream& operator<<(std::ostream& os, const OrderExecution& execution)
-{
-    os << "{\"Name\":\"OrderExecution\","
-        << "\"MDEntryID\":" << execution.MDEntryID
-        << ",\"MDEntryPx\":" << execution.MDEntryPx
-        << ",\"MDEntrySize\":" << execution.MDEntrySize
-        << ",\"LastPx\":" << execution.LastPx
-        << ",\"LastQty\":" << execution.LastQty
-        << ",\"TradeID\":" << execution.TradeID
-        << ",\"MDFlags\":" << execution.MDFlags
-        << ",\"MDFlags2\":" << execution.MDFlags2
-        << ",\"SecurityID\":" << execution.SecurityID
-        << ",\"RptSeq\":" << execution.RptSeq
-        << ",\"MDUpdateAction\":" << execution.mdUpdateAction
-        << ",\"MDEntryType\":\"" << execution.mdEntryType << "\"}";
-    return os;
-}
-
-// OrderBookSnapshot stream operator
-inline std::ostream& operator<<(std::ostream& os, const OrderBookSnapshot& snapshot)
-{
-    os << "{\"Name\":\"OrderBookSnapshot\","
-        << "\"SecurityID\":" << snapshot.SecurityID
-        << ",\"LastMsgSeqNumProcessed\":" << snapshot.LastMsgSeqNumProcessed
-        << ",\"RptSeq\":" << snapshot.RptSeq
-        << ",\"ExchangeTradingSessionID\":" << snapshot.ExchangeTradingSessionID
-        << ",\"NoMDEntries\":" << *(snapshot.MDEntries); // Using the vector << overload
-    os << "}";
-    return os;
-}
-
-// OrderBookSnapshotEntry stream operator
-inline std::ostream& operator<<(std::ostream& os, const OrderBookSnapshotEntry& snapshotEntry)
-{
-    os << "{\"MDEntryID\":" << snapshotEntry.MDEntryID
-        << ",\"TransactTime\":" << snapshotEntry.TransactTime
-        << ",\"MDEntryPx\":" << snapshotEntry.MDEntryPx
-        << ",\"MDEntrySize\":" << snapshotEntry.MDEntrySize
-        << ",\"TradeID\":" << snapshotEntry.TradeID
-        << ",\"MDFlags\":" << snapshotEntry.MDFlags
-        << ",\"MDFlags2\":" << snapshotEntry.MDFlags2
-        << ",\"MDEntryType\":\"" << snapshotEntry.mdEntryType << "\"}";
-    return os;
-}
-// Overload for Utf8String
-std::ostream& operator<<(std::ostream& os, const Utf8String& str) {
-    if (!str.empty())
-    {
-        std::ostringstream escaped;
-        escaped << "\"";
-        for (size_t i = 0; i < str.length; ++i) {
-            unsigned char c = str.varData[i];
-            switch (c) {
-            case '"':  escaped << "\\\""; break;
-            case '\\': escaped << "\\\\"; break;
-            case '\b': escaped << "\\b"; break;
-            case '\f': escaped << "\\f"; break;
-            case '\n': escaped << "\\n"; break;
-            case '\r': escaped << "\\r"; break;
-            case '\t': escaped << "\\t"; break;
-            default:
-                if (c < 0x20 || c > 0x7E) {
-                    // Encode non-ASCII characters as Unicode escape sequences
-                    escaped << "\\u" << std::hex << std::uppercase
-                        << std::setw(4) << std::setfill('0') << static_cast<int>(c);
-                }
-                else {
-                    escaped << c;
-                }
-            }
-        }
-        escaped << "\"";
-        os << escaped.str();
-    }
-    else
-    {
-        os << "null";
-    }
-    return os;
-}
-
-// Overload for VarString
-std::ostream& operator<<(std::ostream& os, const VarString& str) {
-    if (!str.empty() && str.data() != nullptr) {
-        std::string trimmedDesc(reinterpret_cast<const char*>(str.data()),
-            strnlen(reinterpret_cast<const char*>(str.data()), str.size()));
-        os << "\"" << trimmedDesc << "\"";
-    }
-    else {
-        os << "null";
-    }
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const SecurityDefinition::MDFeedTypes& entry) {
-    os << "{\"MDFeedType\":\"" << entry.MDFeedType
-        << "\",\"MarketDepth\":" << entry.MarketDepth
-        << ",\"MDBookType\":" << entry.MDBookType << "}";
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const SecurityDefinition::Underlyings& entry) {
-    os << "{\"UnderlyingSymbol\":\"" << entry.UnderlyingSymbol
-        << "\",\"UnderlyingBoard\":\"" << entry.UnderlyingBoard
-        << "\",\"UnderlyingSecurityID\":" << entry.UnderlyingSecurityID
-        << ",\"UnderlyingFutureID\":" << entry.UnderlyingFutureID << "}";
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const SecurityDefinition::Legs& entry) {
-    os << "{\"LegSymbol\":\"" << entry.LegSymbol
-        << "\",\"LegSecurityID\":" << entry.LegSecurityID
-        << ",\"LegRatioQty\":" << entry.LegRatioQty << "}";
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const SecurityDefinition::InstrAttrib& entry) {
-    os << "{\"InstrAttribType\":" << entry.InstrAttribType
-        << ",\"InstrAttribValue\":\"" << entry.InstrAttribValue << "\"}";
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const SecurityDefinition::Events& entry) {
-    os << "{\"EventType\":" << entry.EventType
-        << ",\"EventDate\":" << entry.EventDate
-        << ",\"EventTime\":" << entry.EventTime << "}";
-    return os;
-}
-
-// SecurityDefinition stream operator
-std::ostream& operator<<(std::ostream& os, const SecurityDefinition& def)
-{
-    os << "{\"Name\": \"SecurityDefinition\", ";
-    os << "\"TotNumReports\": " << def.TotNumReports << ", ";
-    os << "\"Symbol\": \"" << std::string(def.Symbol, strnlen(def.Symbol, sizeof(def.Symbol))) << "\", ";
-    os << "\"SecurityID\": " << def.SecurityID << ", ";
-    os << "\"SecurityIDSource\": " << static_cast<char>(def.SecurityIDSource) << ", ";
-    os << "\"SecurityAltID\": \"" << std::string(def.SecurityAltID) << "\", ";
-    os << "\"SecurityAltIDSource\": \"" << def.securityAltIDSource << "\", ";
-    os << "\"SecurityType\": \"" << std::string(def.SecurityType) << "\", ";
-    os << "\"CFICode\": \"" << std::string(def.CFICode, 6) << "\", ";
-    os << "\"StrikePrice\": " << def.StrikePrice << ", ";
-    os << "\"ContractMultiplier\": " << def.ContractMultiplier << ", ";
-    os << "\"SecurityTradingStatus\": \"" << def.securityTradingStatus << "\", ";
-    os << "\"Currency\": \"" << std::string(def.Currency, strnlen(def.Currency, sizeof(def.Currency))) << "\", ";
-    os << "\"MarketID\": \"" << std::string(SecurityDefinition::MarketID, 4) << "\", ";
-    os << "\"MarketSegmentID\": \"" << def.marketSegmentID << "\", ";
-    os << "\"TradingSessionID\": \"" << def.tradingSessionID << "\", ";
-    os << "\"ExchangeTradingSessionID\": " << def.ExchangeTradingSessionID << ", ";
-    os << "\"Volatility\": " << def.Volatility << ", ";
-    os << "\"HighLimitPx\": " << def.HighLimitPx << ", ";
-    os << "\"LowLimitPx\": " << def.LowLimitPx << ", ";
-    os << "\"MinPriceIncrement\": " << def.MinPriceIncrement << ", ";
-    os << "\"MinPriceIncrementAmount\": " << def.MinPriceIncrementAmount << ", ";
-    os << "\"InitialMarginOnBuy\": " << def.InitialMarginOnBuy << ", ";
-    os << "\"InitialMarginOnSell\": " << def.InitialMarginOnSell << ", ";
-    os << "\"InitialMarginSyntetic\": " << def.InitialMarginSyntetic << ", ";
-    os << "\"TheorPrice\": " << def.TheorPrice << ", ";
-    os << "\"TheorPriceLimit\": " << def.TheorPriceLimit << ", ";
-    os << "\"UnderlyingQty\": " << def.UnderlyingQty << ", ";
-    os << "\"UnderlyingCurrency\": \"" << std::string(def.UnderlyingCurrency) << "\", ";
-    os << "\"MaturityDate\": " << def.MaturityDate << ", ";
-    os << "\"MaturityTime\": " << def.MaturityTime << ", ";
-    os << "\"Flags\": " << def.Flags << ", ";
-    os << "\"MinPriceIncrementAmountCurr\": " << def.MinPriceIncrementAmountCurr << ", ";
-    os << "\"SettlPriceOpen\": " << def.SettlPriceOpen << ", ";
-    os << "\"ValuationMethod\": \"" << std::string(def.ValuationMethod) << "\", ";
-    os << "\"RiskFreeRate\": " << def.RiskFreeRate << ", ";
-    os << "\"FixedSpotDiscount\": " << def.FixedSpotDiscount << ", ";
-    os << "\"ProjectedSpotDiscount\": " << def.ProjectedSpotDiscount << ", ";
-    os << "\"SettlCurrency\": \"" << std::string(def.SettlCurrency, strnlen(def.SettlCurrency, sizeof(def.SettlCurrency))) << "\", ";
-    os << "\"NegativePrices\": \"" << def.negativePrices << "\", ";
-    os << "\"DerivativeContractMultiplier\": " << def.DerivativeContractMultiplier << ", ";
-    os << "\"InterestRateRiskUp\": " << def.InterestRateRiskUp << ", ";
-    os << "\"InterestRateRiskDown\": " << def.InterestRateRiskDown << ", ";
-    os << "\"RiskFreeRate2\": " << def.RiskFreeRate2 << ", ";
-    os << "\"InterestRate2RiskUp\": " << def.InterestRate2RiskUp << ", ";
-    os << "\"InterestRate2RiskDown\": " << def.InterestRate2RiskDown << ", ";
-    os << "\"SettlPrice\": " << def.SettlPrice << ", ";
-    os << "\"NoMDFeedTypes\":" << std::span<SecurityDefinition::MDFeedTypes>((*def.MDFeedTypesEntries).data(), def.NoMDFeedTypes.numInGroup) << ", ";
-    os << "\"NoUnderlyings\":" << std::span<SecurityDefinition::Underlyings>((*def.UnderlyingsEntries).data(), def.NoUnderlyings.numInGroup) << ", ";
-    os << "\"NoLegs\":" << std::span<SecurityDefinition::Legs>((*def.LegsEntries).data(), def.NoLegs.numInGroup) << ", ";
-    os << "\"NoInstrAttrib\":" << std::span<SecurityDefinition::InstrAttrib>((*def.InstrAttribEntries).data(), def.NoInstrAttrib.numInGroup) << ", ";
-    os << "\"NoEvents\":" << std::span<SecurityDefinition::Events>((*def.EventsEntries).data(), def.NoEvents.numInGroup) << ", ";
-    os << "\"SecurityDesc\":" << (def.SecurityDesc.empty()
-        ? "null"
-        : std::string(reinterpret_cast<const char*>(def.SecurityDesc.data()), def.SecurityDesc.size())); // Temporary solution, need wide stream to properly support UTF8
-    os << ", ";
-    os << "\"QuotationList\":" << def.QuotationList << "}";
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const SequenceReset& entry) {
-    os << "{\"SequenceReset\":" << entry.NewSeqNo << "}";
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const SecurityStatus& status)
-{
-    os << "{ \"Name\": \"SecurityStatus\", ";
-    os << "SecurityID: " << status.SecurityID << ", ";
-    os << "SecurityIDSource: " << status.SecurityIDSource << ", ";
-    os << "Symbol: " << std::string(status.Symbol, 25) << ", ";
-    os << "SecurityTradingStatus: " << status.securityTradingStatus << ", ";
-    os << "HighLimitPx: " << status.HighLimitPx << ", ";
-    os << "LowLimitPx: " << status.LowLimitPx << ", ";
-    os << "InitialMarginOnBuy: " << status.InitialMarginOnBuy << ", ";
-    os << "InitialMarginOnSell: " << status.InitialMarginOnSell << ", ";
-    os << "InitialMarginSyntetic: " << status.InitialMarginSyntetic;
-    os << " }";
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const SecurityDefinitionUpdateReport& report)
-{
-    os << "{ ";
-    os << "\"SecurityID\": " << report.SecurityID << ", ";
-    os << "\"SecurityIDSource\": \"" << report.SecurityIDSource << "\", ";
-    os << "\"Volatility\": " << report.Volatility << ", ";
-    os << "\"TheorPrice\": " << report.TheorPrice << ", ";
-    os << "\"TheorPriceLimit\": " << report.TheorPriceLimit;
-    os << " }";
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const TradingSessionStatus& status) {
-    os << "{ \"Name\": \"TradingSessionStatus\", ";
-    os << "\"TradSesOpenTime\": " << status.TradSesOpenTime << ", ";
-    os << "\"TradSesCloseTime\": " << status.TradSesCloseTime << ", ";
-    if (status.TradSesIntermClearingStartTime != 0) {
-        os << "\"TradSesIntermClearingStartTime\": " << status.TradSesIntermClearingStartTime << ", ";
-    }
-    else {
-        os << "\"TradSesIntermClearingStartTime\": null, ";
-    }
-    if (status.TradSesIntermClearingEndTime != 0) {
-        os << "\"TradSesIntermClearingEndTime\": " << status.TradSesIntermClearingEndTime << ", ";
-    }
-    else {
-        os << "\"TradSesIntermClearingEndTime\": null, ";
-    }
-    os << "\"TradingSessionID\": " << static_cast<int>(status.TradingSessionID) << ", ";
-    if (status.ExchangeTradingSessionID != 0) {
-        os << "\"ExchangeTradingSessionID\": " << status.ExchangeTradingSessionID << ", ";
-    }
-    else {
-        os << "\"ExchangeTradingSessionID\": null, ";
-    }
-    os << "\"TradSesStatus\": " << static_cast<int>(status.TradSesStatus) << ", ";
-    os << "\"MarketID\": \"" << std::string(status.MarketID, 4) << "\", ";
-    os << "\"MarketSegmentID\": \"" << status.MarketSegmentID << "\", ";
-    os << "\"TradSesEvent\": " << static_cast<int>(status.TradSesEvent);
-    os << "}";
-
-    return os;
-}
-
-std::ostream& operator<<(std::ostream& os, const SIMBAPacket& packet)
-{
-    os << packet.marketDataHeader << ", ";
-    if (packet.incrementalHeader)
-{
-        os << *packet.incrementalHeader << ", ";
-    }
-    os << packet.messageHeader << ", ";
-    os << packet.messages;
-    return os;
-}
-
-// Define the operator<< for the std::variant
+	out.append("{\"MsgSeqNum\":");
+	out.integer(packetHeader.MsgSeqNum);
+	out.append(",\"MsgSize\":");
+	out.integer(packetHeader.MsgSize);
+	out.append(",\"MsgFlags\":");
+	out.integer(packetHeader.MsgFlags);
+	out.append(",\"SendingTime\":");
+	out.integer(packetHeader.SendingTime);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const IncrementalPacketHeader& packetHeader)
+{
+	out.append("{\"TransactTime\":");
+	out.integer(packetHeader.TransactTime);
+	out.append(",\"ExchangeTradingSessionID\":");
+	out.integer(packetHeader.ExchangeTradingSessionID);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const OrderUpdate& update)
+{
+	out.append("{\"Name\":\"OrderUpdate\",\"MDEntryID\":");
+	out.integer(update.MDEntryID);
+	out.append(",\"MDEntryPx\":");
+	writeJSON(out, update.MDEntryPx);
+	out.append(",\"MDEntrySize\":");
+	out.integer(update.MDEntrySize);
+	out.append(",\"MDFlags\":");
+	writeJSON(out, update.MDFlags);
+	out.append(",\"MDFlags2\":");
+	writeJSON(out, update.MDFlags2);
+	out.append(",\"SecurityID\":");
+	out.integer(update.SecurityID);
+	out.append(",\"RptSeq\":");
+	out.integer(update.RptSeq);
+	out.append(",\"MDUpdateAction\":");
+	writeJSON(out, update.mdUpdateAction);
+	out.append(",\"MDEntryType\":\"");
+	writeJSON(out, update.mdEntryType);
+	out.append("\"}");
+}
+
+inline void writeJSON(JSONWriter& out, const OrderExecution& execution)
+{
+	out.append("{\"Name\":\"OrderExecution\",\"MDEntryID\":");
+	out.integer(execution.MDEntryID);
+	out.append(",\"MDEntryPx\":");
+	writeJSON(out, execution.MDEntryPx);
+	out.append(",\"MDEntrySize\":");
+	out.integer(execution.MDEntrySize);
+	out.append(",\"LastPx\":");
+	writeJSON(out, execution.LastPx);
+	out.append(",\"LastQty\":");
+	out.integer(execution.LastQty);
+	out.append(",\"TradeID\":");
+	out.integer(execution.TradeID);
+	out.append(",\"MDFlags\":");
+	writeJSON(out, execution.MDFlags);
+	out.append(",\"MDFlags2\":");
+	writeJSON(out, execution.MDFlags2);
+	out.append(",\"SecurityID\":");
+	out.integer(execution.SecurityID);
+	out.append(",\"RptSeq\":");
+	out.integer(execution.RptSeq);
+	out.append(",\"MDUpdateAction\":");
+	writeJSON(out, execution.mdUpdateAction);
+	out.append(",\"MDEntryType\":\"");
+	writeJSON(out, execution.mdEntryType);
+	out.append("\"}");
+}
+
+inline void writeJSON(JSONWriter& out, const OrderBookSnapshotEntry& snapshotEntry)
+{
+	out.append("{\"MDEntryID\":");
+	out.integer(snapshotEntry.MDEntryID);
+	out.append(",\"TransactTime\":");
+	out.integer(snapshotEntry.TransactTime);
+	out.append(",\"MDEntryPx\":");
+	writeJSON(out, snapshotEntry.MDEntryPx);
+	out.append(",\"MDEntrySize\":");
+	out.integer(snapshotEntry.MDEntrySize);
+	out.append(",\"TradeID\":");
+	out.integer(snapshotEntry.TradeID);
+	out.append(",\"MDFlags\":");
+	writeJSON(out, snapshotEntry.MDFlags);
+	out.append(",\"MDFlags2\":");
+	writeJSON(out, snapshotEntry.MDFlags2);
+	out.append(",\"MDEntryType\":\"");
+	writeJSON(out, snapshotEntry.mdEntryType);
+	out.append("\"}");
+}
+
+inline void writeJSON(JSONWriter& out, const OrderBookSnapshot& snapshot)
+{
+	out.append("{\"Name\":\"OrderBookSnapshot\",\"SecurityID\":");
+	out.integer(snapshot.SecurityID);
+	out.append(",\"LastMsgSeqNumProcessed\":");
+	out.integer(snapshot.LastMsgSeqNumProcessed);
+	out.append(",\"RptSeq\":");
+	out.integer(snapshot.RptSeq);
+	out.append(",\"ExchangeTradingSessionID\":");
+	out.integer(snapshot.ExchangeTradingSessionID);
+	out.append(",\"NoMDEntries\":");
+	writeJSON(out, snapshot.MDEntries, snapshot.MDEntries ? snapshot.MDEntries->size() : 0);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const Utf8String& str)
+{
+	if (str.empty())
+	{
+		out.append("null");
+		return;
+	}
+	out.append('"');
+	out.escaped(reinterpret_cast<const char*>(str.data()), str.size(), true);
+	out.append('"');
+}
+
+inline void writeJSON(JSONWriter& out, const VarString& str)
+{
+	if (str.empty())
+	{
+		out.append("null");
+		return;
+	}
+	out.append('"');
+	out.trimmed(reinterpret_cast<const char*>(str.data()), str.size());
+	out.append('"');
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityDefinition::MDFeedTypes& entry)
+{
+	out.append("{\"MDFeedType\":\"");
+	SIMBAJSON::chars(out, entry.MDFeedType);
+	out.append("\",\"MarketDepth\":");
+	out.integer(entry.MarketDepth);
+	out.append(",\"MDBookType\":");
+	out.integer(entry.MDBookType);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityDefinition::Underlyings& entry)
+{
+	out.append("{\"UnderlyingSymbol\":\"");
+	SIMBAJSON::chars(out, entry.UnderlyingSymbol);
+	out.append("\",\"UnderlyingBoard\":\"");
+	SIMBAJSON::chars(out, entry.UnderlyingBoard);
+	out.append("\",\"UnderlyingSecurityID\":");
+	out.integer(entry.UnderlyingSecurityID);
+	out.append(",\"UnderlyingFutureID\":");
+	out.integer(entry.UnderlyingFutureID);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityDefinition::Legs& entry)
+{
+	out.append("{\"LegSymbol\":\"");
+	SIMBAJSON::chars(out, entry.LegSymbol);
+	out.append("\",\"LegSecurityID\":");
+	out.integer(entry.LegSecurityID);
+	out.append(",\"LegRatioQty\":");
+	out.integer(entry.LegRatioQty);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityDefinition::InstrAttrib& entry)
+{
+	out.append("{\"InstrAttribType\":");
+	out.integer(entry.InstrAttribType);
+	out.append(",\"InstrAttribValue\":\"");
+	SIMBAJSON::chars(out, entry.InstrAttribValue);
+	out.append("\"}");
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityDefinition::Events& entry)
+{
+	out.append("{\"EventType\":");
+	out.integer(entry.EventType);
+	out.append(",\"EventDate\":");
+	out.integer(entry.EventDate);
+	out.append(",\"EventTime\":");
+	out.integer(entry.EventTime);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityDefinition& def)
+{
+	out.append("{\"Name\": \"SecurityDefinition\", \"TotNumReports\": ");
+	out.integer(def.TotNumReports);
+	out.append(", \"Symbol\": \"");
+	SIMBAJSON::chars(out, def.Symbol);
+	out.append("\", \"SecurityID\": ");
+	out.integer(def.SecurityID);
+	out.append(", \"SecurityIDSource\": ");
+	out.append(SecurityDefinition::SecurityIDSource);
+	out.append(", \"SecurityAltID\": \"");
+	SIMBAJSON::chars(out, def.SecurityAltID);
+	out.append("\", \"SecurityAltIDSource\": \"");
+	writeJSON(out, def.securityAltIDSource);
+	out.append("\", \"SecurityType\": \"");
+	SIMBAJSON::chars(out, def.SecurityType);
+	out.append("\", \"CFICode\": \"");
+	SIMBAJSON::chars(out, def.CFICode);
+	out.append("\", \"StrikePrice\": ");
+	writeJSON(out, def.StrikePrice);
+	out.append(", \"ContractMultiplier\": ");
+	out.integer(def.ContractMultiplier);
+	out.append(", \"SecurityTradingStatus\": \"");
+	writeJSON(out, def.securityTradingStatus);
+	out.append("\", \"Currency\": \"");
+	SIMBAJSON::chars(out, def.Currency);
+	out.append("\", \"MarketID\": \"");
+	SIMBAJSON::chars(out, SecurityDefinition::MarketID);
+	out.append("\", \"MarketSegmentID\": \"");
+	writeJSON(out, def.marketSegmentID);
+	out.append("\", \"TradingSessionID\": \"");
+	writeJSON(out, def.tradingSessionID);
+	out.append("\", \"ExchangeTradingSessionID\": ");
+	out.integer(def.ExchangeTradingSessionID);
+	out.append(", \"Volatility\": ");
+	writeJSON(out, def.Volatility);
+	out.append(", \"HighLimitPx\": ");
+	writeJSON(out, def.HighLimitPx);
+	out.append(", \"LowLimitPx\": ");
+	writeJSON(out, def.LowLimitPx);
+	out.append(", \"MinPriceIncrement\": ");
+	writeJSON(out, def.MinPriceIncrement);
+	out.append(", \"MinPriceIncrementAmount\": ");
+	writeJSON(out, def.MinPriceIncrementAmount);
+	out.append(", \"InitialMarginOnBuy\": ");
+	writeJSON(out, def.InitialMarginOnBuy);
+	out.append(", \"InitialMarginOnSell\": ");
+	writeJSON(out, def.InitialMarginOnSell);
+	out.append(", \"InitialMarginSyntetic\": ");
+	writeJSON(out, def.InitialMarginSyntetic);
+	out.append(", \"TheorPrice\": ");
+	writeJSON(out, def.TheorPrice);
+	out.append(", \"TheorPriceLimit\": ");
+	writeJSON(out, def.TheorPriceLimit);
+	out.append(", \"UnderlyingQty\": ");
+	writeJSON(out, def.UnderlyingQty);
+	out.append(", \"UnderlyingCurrency\": \"");
+	SIMBAJSON::chars(out, def.UnderlyingCurrency);
+	out.append("\", \"MaturityDate\": ");
+	out.integer(def.MaturityDate);
+	out.append(", \"MaturityTime\": ");
+	out.integer(def.MaturityTime);
+	out.append(", \"Flags\": ");
+	writeJSON(out, def.Flags);
+	out.append(", \"MinPriceIncrementAmountCurr\": ");
+	writeJSON(out, def.MinPriceIncrementAmountCurr);
+	out.append(", \"SettlPriceOpen\": ");
+	writeJSON(out, def.SettlPriceOpen);
+	out.append(", \"ValuationMethod\": \"");
+	SIMBAJSON::chars(out, def.ValuationMethod);
+	out.append("\", \"RiskFreeRate\": ");
+	writeJSON(out, def.RiskFreeRate);
+	out.append(", \"FixedSpotDiscount\": ");
+	writeJSON(out, def.FixedSpotDiscount);
+	out.append(", \"ProjectedSpotDiscount\": ");
+	writeJSON(out, def.ProjectedSpotDiscount);
+	out.append(", \"SettlCurrency\": \"");
+	SIMBAJSON::chars(out, def.SettlCurrency);
+	out.append("\", \"NegativePrices\": \"");
+	writeJSON(out, def.negativePrices);
+	out.append("\", \"DerivativeContractMultiplier\": ");
+	out.integer(def.DerivativeContractMultiplier);
+	out.append(", \"InterestRateRiskUp\": ");
+	writeJSON(out, def.InterestRateRiskUp);
+	out.append(", \"InterestRateRiskDown\": ");
+	writeJSON(out, def.InterestRateRiskDown);
+	out.append(", \"RiskFreeRate2\": ");
+	writeJSON(out, def.RiskFreeRate2);
+	out.append(", \"InterestRate2RiskUp\": ");
+	writeJSON(out, def.InterestRate2RiskUp);
+	out.append(", \"InterestRate2RiskDown\": ");
+	writeJSON(out, def.InterestRate2RiskDown);
+	out.append(", \"SettlPrice\": ");
+	writeJSON(out, def.SettlPrice);
+	out.append(", \"NoMDFeedTypes\":");
+	writeJSON(out, def.MDFeedTypesEntries, def.NoMDFeedTypes.numInGroup);
+	out.append(", \"NoUnderlyings\":");
+	writeJSON(out, def.UnderlyingsEntries, def.NoUnderlyings.numInGroup);
+	out.append(", \"NoLegs\":");
+	writeJSON(out, def.LegsEntries, def.NoLegs.numInGroup);
+	out.append(", \"NoInstrAttrib\":");
+	writeJSON(out, def.InstrAttribEntries, def.NoInstrAttrib.numInGroup);
+	out.append(", \"NoEvents\":");
+	writeJSON(out, def.EventsEntries, def.NoEvents.numInGroup);
+	out.append(", \"SecurityDesc\":");
+	writeJSON(out, def.SecurityDesc);
+	out.append(", \"QuotationList\":");
+	writeJSON(out, def.QuotationList);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const SequenceReset& entry)
+{
+	out.append("{\"SequenceReset\":");
+	out.integer(entry.NewSeqNo);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityStatus& status)
+{
+	out.append("{ \"Name\": \"SecurityStatus\", \"SecurityID\": ");
+	out.integer(status.SecurityID);
+	out.append(", \"SecurityIDSource\": \"");
+	out.append(SecurityStatus::SecurityIDSource);
+	out.append("\", \"Symbol\": \"");
+	SIMBAJSON::chars(out, status.Symbol);
+	out.append("\", \"SecurityTradingStatus\": \"");
+	writeJSON(out, status.securityTradingStatus);
+	out.append("\", \"HighLimitPx\": ");
+	writeJSON(out, status.HighLimitPx);
+	out.append(", \"LowLimitPx\": ");
+	writeJSON(out, status.LowLimitPx);
+	out.append(", \"InitialMarginOnBuy\": ");
+	writeJSON(out, status.InitialMarginOnBuy);
+	out.append(", \"InitialMarginOnSell\": ");
+	writeJSON(out, status.InitialMarginOnSell);
+	out.append(", \"InitialMarginSyntetic\": ");
+	writeJSON(out, status.InitialMarginSyntetic);
+	out.append(" }");
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityDefinitionUpdateReport& report)
+{
+	out.append("{ \"SecurityID\": ");
+	out.integer(report.SecurityID);
+	out.append(", \"SecurityIDSource\": \"");
+	out.append(SecurityDefinitionUpdateReport::SecurityIDSource);
+	out.append("\", \"Volatility\": ");
+	writeJSON(out, report.Volatility);
+	out.append(", \"TheorPrice\": ");
+	writeJSON(out, report.TheorPrice);
+	out.append(", \"TheorPriceLimit\": ");
+	writeJSON(out, report.TheorPriceLimit);
+	out.append(" }");
+}
+
+inline void writeJSON(JSONWriter& out, const TradingSessionStatus& status)
+{
+	// Zero is null for the optional times and session ID
+	const auto nullable = [&out](uint64_t value)
+	{
+		if (value != 0)
+			out.integer(value);
+		else
+			out.append("null");
+	};
+
+	out.append("{ \"Name\": \"TradingSessionStatus\", \"TradSesOpenTime\": ");
+	out.integer(status.TradSesOpenTime);
+	out.append(", \"TradSesCloseTime\": ");
+	out.integer(status.TradSesCloseTime);
+	out.append(", \"TradSesIntermClearingStartTime\": ");
+	nullable(status.TradSesIntermClearingStartTime);
+	out.append(", \"TradSesIntermClearingEndTime\": ");
+	nullable(status.TradSesIntermClearingEndTime);
+	out.append(", \"TradingSessionID\": ");
+	out.integer(static_cast<int>(status.TradingSessionID));
+	out.append(", \"ExchangeTradingSessionID\": ");
+	nullable(status.ExchangeTradingSessionID);
+	out.append(", \"TradSesStatus\": ");
+	out.integer(static_cast<int>(status.TradSesStatus));
+	out.append(", \"MarketID\": \"");
+	SIMBAJSON::chars(out, TradingSessionStatus::MarketID);
+	out.append("\", \"MarketSegmentID\": \"");
+	out.escaped(&status.MarketSegmentID, 1);
+	out.append("\", \"TradSesEvent\": ");
+	out.integer(static_cast<int>(status.TradSesEvent));
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const Heartbeat&)
+{
+	out.append("{\"Name\":\"Heartbeat\"}");
+}
+
+inline void writeJSON(JSONWriter& out, const BestPricesEntry& entry)
+{
+	out.append("{\"MktBidPx\":");
+	writeJSON(out, entry.MktBidPx);
+	out.append(",\"MktOfferPx\":");
+	writeJSON(out, entry.MktOfferPx);
+	out.append(",\"MktBidSize\":");
+	out.integer(entry.MktBidSize);
+	out.append(",\"MktOfferSize\":");
+	out.integer(entry.MktOfferSize);
+	out.append(",\"SecurityID\":");
+	out.integer(entry.SecurityID);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const BestPrices& bestPrices)
+{
+	out.append("{\"Name\":\"BestPrices\",\"NoMDEntries\":");
+	writeJSON(out, bestPrices.MDEntries);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const EmptyBook& emptyBook)
+{
+	out.append("{\"Name\":\"EmptyBook\",\"LastMsgSeqNumProcessed\":");
+	out.integer(emptyBook.LastMsgSeqNumProcessed);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityMassStatusEntry& entry)
+{
+	out.append("{\"SecurityID\":");
+	out.integer(entry.SecurityID);
+	out.append(",\"SecurityIDSource\":\"");
+	out.append(SecurityMassStatusEntry::SecurityIDSource);
+	out.append("\",\"SecurityTradingStatus\":\"");
+	writeJSON(out, entry.securityTradingStatus);
+	out.append("\"}");
+}
+
+inline void writeJSON(JSONWriter& out, const SecurityMassStatus& massStatus)
+{
+	out.append("{\"Name\":\"SecurityMassStatus\",\"NoRelatedSym\":");
+	writeJSON(out, massStatus.Entries);
+	out.append('}');
+}
+
+inline void writeJSON(JSONWriter& out, const Logon&)
+{
+	out.append("{\"Name\":\"Logon\"}");
+}
+
+inline void writeJSON(JSONWriter& out, const Logout& logout)
+{
+	out.append("{\"Name\":\"Logout\",\"Text\":\"");
+	SIMBAJSON::chars(out, logout.Text);
+	out.append("\"}");
+}
+
+inline void writeJSON(JSONWriter& out, const MarketDataRequest& request)
+{
+	out.append("{\"Name\":\"MarketDataRequest\",\"ApplBegSeqNum\":");
+	out.integer(request.ApplBegSeqNum);
+	out.append(",\"ApplEndSeqNum\":");
+	out.integer(request.ApplEndSeqNum);
+	out.append('}');
+}
+
 template<typename... Types>
-std::ostream& operator<<(std::ostream& os, const std::variant<Types...>& var)
-{
-    // Check that all types in the variant are streamable
-    static_assert((std::is_same_v<std::ostream&, decltype(os << std::declval<Types>())> && ...),
-                   "All types in std::variant must be streamable with operator<<");
-    
-    std::visit([&os](const auto& value)
-{ os << value; }, var);
-    return os;
-}
\ No newline at end of file
+inline void writeJSON(JSONWriter& out, const std::variant<Types...>& var)
+{
+	std::visit([&out](const auto& value) { writeJSON(out, value); }, var);
+}
+
+// Same layout as the std::vector overload. Messages of a template the projection has a plan for are
+// written with only the fields it selects
+inline void writeJSON(JSONWriter& out, const SIMBAMessageList& messages, const FieldProjection& fields = {})
+{
+	out.append('[');
+	bool first = true;
+	messages.forEach([&out, &first, &fields](const auto& message)
+	{
+		if (!first)
+			out.append(", ");
+		first = false;
+		if (!fields.write(out, message))
+			writeJSON(out, message);
+	});
+	out.append(']');
+}
+
+inline void writeJSON(JSONWriter& out, const SIMBAPacket& packet, const FieldProjection& fields = {})
+{
+	writeJSON(out, packet.marketDataHeader);
+	out.append(", ");
+	if (packet.incrementalHeader)
+	{
+		writeJSON(out, *packet.incrementalHeader);
+		out.append(", ");
+	}
+	writeJSON(out, packet.messageHeader);
+	out.append(", ");
+	writeJSON(out, packet.messages, fields);
+}
+
+// One line per message of the packet, each a complete object carrying the packet's metadata, so the
+// output can be split anywhere between lines and every line parsed on its own
+inline void writeNDJSON(JSONWriter& out, const SIMBAPacket& packet, const FieldProjection& fields = {})
+{
+	size_t index = 0;
+	packet.messages.forEach([&](const auto& message)
+	{
+		using Message = std::remove_cvref_t<decltype(message)>;
+
+		out.append("{\"Template\":\"");
+		out.append(MessageTraits<Message>::name);
+		out.append("\",\"TemplateId\":");
+		out.integer(MessageTraits<Message>::templateId);
+		out.append(",\"CaptureTime\":");
+		out.integer(packet.captureTime);
+		out.append(",\"MsgSeqNum\":");
+		out.integer(packet.marketDataHeader.MsgSeqNum);
+		out.append(",\"MsgFlags\":");
+		out.integer(packet.marketDataHeader.MsgFlags);
+		out.append(",\"SendingTime\":");
+		out.integer(packet.marketDataHeader.SendingTime);
+		if (packet.incrementalHeader)
+		{
+			out.append(",\"TransactTime\":");
+			out.integer(packet.incrementalHeader->TransactTime);
+			out.append(",\"ExchangeTradingSessionID\":");
+			out.integer(packet.incrementalHeader->ExchangeTradingSessionID);
+		}
+		out.append(",\"SchemaVersion\":");
+		out.integer(packet.messageHeader.version);
+		out.append(",\"Index\":");
+		out.integer(index++);
+		out.append(",\"Message\":");
+		if (!fields.write(out, message))
+			writeJSON(out, message);
+		out.append("}\n");
+	});
+}
+
+// For output still written to a stream, such as the book snapshots
+template<typename T>
+	requires (std::is_class_v<T> || std::is_enum_v<T>) && requires(JSONWriter& out, const T& value) { writeJSON(out, value); }
+inline std::ostream& operator<<(std::ostream& os, const T& value)
+{
+	JSONWriter text(256);
+	writeJSON(text, value);
+	return os.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
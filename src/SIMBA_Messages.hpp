@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "SIMBA_Schema.hpp"
+
+// Decoded message types as they are stored in a packet. templateId is the SIMBA 4.x template the message
+// is normalized to, whatever schema version it was decoded from
+template<typename T> struct MessageTraits;
+
+template<> struct MessageTraits<Heartbeat> { static constexpr uint16_t templateId = 1; static constexpr const char* name = "Heartbeat"; };
+template<> struct MessageTraits<SequenceReset> { static constexpr uint16_t templateId = 2; static constexpr const char* name = "SequenceReset"; };
+template<> struct MessageTraits<BestPrices> { static constexpr uint16_t templateId = 3; static constexpr const char* name = "BestPrices"; };
+template<> struct MessageTraits<EmptyBook> { static constexpr uint16_t templateId = 4; static constexpr const char* name = "EmptyBook"; };
+template<> struct MessageTraits<SecurityStatus> { static constexpr uint16_t templateId = 9; static constexpr const char* name = "SecurityStatus"; };
+template<> struct MessageTraits<SecurityDefinitionUpdateReport> { static constexpr uint16_t templateId = 10; static constexpr const char* name = "SecurityDefinitionUpdateReport"; };
+template<> struct MessageTraits<TradingSessionStatus> { static constexpr uint16_t templateId = 11; static constexpr const char* name = "TradingSessionStatus"; };
+template<> struct MessageTraits<OrderUpdate> { static constexpr uint16_t templateId = 15; static constexpr const char* name = "OrderUpdate"; };
+template<> struct MessageTraits<OrderExecution> { static constexpr uint16_t templateId = 16; static constexpr const char* name = "OrderExecution"; };
+template<> struct MessageTraits<OrderBookSnapshot> { static constexpr uint16_t templateId = 17; static constexpr const char* name = "OrderBookSnapshot"; };
+template<> struct MessageTraits<SecurityDefinition> { static constexpr uint16_t templateId = 18; static constexpr const char* name = "SecurityDefinition"; };
+template<> struct MessageTraits<SecurityMassStatus> { static constexpr uint16_t templateId = 19; static constexpr const char* name = "SecurityMassStatus"; };
+template<> struct MessageTraits<Logon> { static constexpr uint16_t templateId = 1000; static constexpr const char* name = "Logon"; };
+template<> struct MessageTraits<Logout> { static constexpr uint16_t templateId = 1001; static constexpr const char* name = "Logout"; };
+template<> struct MessageTraits<MarketDataRequest> { static constexpr uint16_t templateId = 1002; static constexpr const char* name = "MarketDataRequest"; };
+
+// Small fixed layout messages are stored inline in the packet's record buffer, everything else
+// (groups, var data, Logout's 256 byte text) lives out of line
+static constexpr size_t MAX_INLINE_MESSAGE_SIZE = 128;
+
+template<typename T>
+inline constexpr bool isInlineMessage = std::is_trivially_copyable_v<T> && sizeof(T) <= MAX_INLINE_MESSAGE_SIZE;
+
+using OutOfLineMessage = std::variant<OrderBookSnapshot, SecurityDefinition, BestPrices, SecurityMassStatus, Logout>;
+
+// Messages of one packet as a contiguous run of tagged records. A record is an 8 byte header followed by
+// the message body padded to 8 bytes, so an OrderUpdate takes a single cache line instead of the size of
+// the largest message type. Large and rare messages keep only their header here and an index into outOfLine
+class SIMBAMessageList
+{
+public:
+	template<typename T>
+	void emplace_back(T&& message)
+	{
+		using Message = std::remove_cvref_t<T>;
+
+		RecordHeader header{ MessageTraits<Message>::templateId, 0, 0 };
+		size_t bodySize = 0;
+		if constexpr (isInlineMessage<Message>)
+		{
+			bodySize = sizeof(Message);
+		}
+		else
+		{
+			header.outOfLineIndex = static_cast<uint32_t>(outOfLine.size());
+			outOfLine.emplace_back(std::in_place_type<Message>, std::forward<T>(message));
+		}
+
+		header.recordSize = static_cast<uint16_t>(sizeof(RecordHeader) + ((bodySize + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1)));
+
+		const size_t recordOffset = records.size();
+		records.resize(recordOffset + header.recordSize);
+		std::memcpy(records.data() + recordOffset, &header, sizeof(RecordHeader));
+		if constexpr (isInlineMessage<Message>)
+			std::memcpy(records.data() + recordOffset + sizeof(RecordHeader), &message, sizeof(Message));
+
+		++count;
+	}
+
+	// Calls visitor with each message as its concrete type, in packet order
+	template<typename Visitor>
+	void forEach(Visitor&& visitor) const
+	{
+		for (size_t recordOffset = 0; recordOffset < records.size();)
+		{
+			RecordHeader header;
+			std::memcpy(&header, records.data() + recordOffset, sizeof(RecordHeader));
+			const std::byte* body = records.data() + recordOffset + sizeof(RecordHeader);
+
+			switch (header.templateId)
+			{
+			case MessageTraits<OrderUpdate>::templateId: visit<OrderUpdate>(visitor, header, body); break;
+			case MessageTraits<OrderExecution>::templateId: visit<OrderExecution>(visitor, header, body); break;
+			case MessageTraits<OrderBookSnapshot>::templateId: visit<OrderBookSnapshot>(visitor, header, body); break;
+			case MessageTraits<SecurityDefinition>::templateId: visit<SecurityDefinition>(visitor, header, body); break;
+			case MessageTraits<SecurityStatus>::templateId: visit<SecurityStatus>(visitor, header, body); break;
+			case MessageTraits<SecurityDefinitionUpdateReport>::templateId: visit<SecurityDefinitionUpdateReport>(visitor, header, body); break;
+			case MessageTraits<SequenceReset>::templateId: visit<SequenceReset>(visitor, header, body); break;
+			case MessageTraits<TradingSessionStatus>::templateId: visit<TradingSessionStatus>(visitor, header, body); break;
+			case MessageTraits<Heartbeat>::templateId: visit<Heartbeat>(visitor, header, body); break;
+			case MessageTraits<BestPrices>::templateId: visit<BestPrices>(visitor, header, body); break;
+			case MessageTraits<EmptyBook>::templateId: visit<EmptyBook>(visitor, header, body); break;
+			case MessageTraits<SecurityMassStatus>::templateId: visit<SecurityMassStatus>(visitor, header, body); break;
+			case MessageTraits<Logon>::templateId: visit<Logon>(visitor, header, body); break;
+			case MessageTraits<Logout>::templateId: visit<Logout>(visitor, header, body); break;
+			case MessageTraits<MarketDataRequest>::templateId: visit<MarketDataRequest>(visitor, header, body); break;
+			default: break;
+			}
+
+			recordOffset += header.recordSize;
+		}
+	}
+
+	size_t size() const noexcept { return count; }
+	bool empty() const noexcept { return count == 0; }
+
+	// Keeps the allocated capacity so a packet object can be reused for the next decode
+	void clear() noexcept
+	{
+		records.clear();
+		outOfLine.clear();
+		count = 0;
+	}
+
+private:
+	static constexpr size_t RECORD_ALIGNMENT = 8;
+
+	struct RecordHeader
+	{
+		uint16_t templateId;     // MessageTraits<T>::templateId of the stored message
+		uint16_t recordSize;     // Header and padded body, the distance to the next record
+		uint32_t outOfLineIndex; // Index into outOfLine for messages that are not stored inline
+	};
+	static_assert(sizeof(RecordHeader) == RECORD_ALIGNMENT, "RecordHeader must keep records aligned");
+
+	template<typename T, typename Visitor>
+	static void visitInline(Visitor& visitor, const std::byte* body)
+	{
+		// Schema structs are packed, any address is suitably aligned. The bytes were memcpy'd into a
+		// byte buffer, which implicitly created the object there
+		visitor(*std::launder(reinterpret_cast<const T*>(body)));
+	}
+
+	template<typename T, typename Visitor>
+	void visit(Visitor& visitor, const RecordHeader& header, const std::byte* body) const
+	{
+		if constexpr (isInlineMessage<T>)
+			visitInline<T>(visitor, body);
+		else
+			visitor(std::get<T>(outOfLine[header.outOfLineIndex]));
+	}
+
+	std::vector<std::byte> records;
+	std::vector<OutOfLineMessage> outOfLine;
+	size_t count = 0;
+};
+
+struct SIMBAPacket
+{
+    MarketDataPacketHeader marketDataHeader{};
+    std::optional<IncrementalPacketHeader> incrementalHeader{};
+    MessageHeader messageHeader{};
+    SIMBAMessageList messages;
+    uint64_t captureTime = 0; // Nanoseconds since the Unix epoch, from the pcap record the packet came in
+    uint16_t channel = 0;     // UDP or TCP destination port of the packet
+};
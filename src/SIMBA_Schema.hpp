@@ -14,7 +14,7 @@ static constexpr char MarketID[4] = { 'M', 'O', 'E', 'X' }; // Constant value "M
 
 struct Utf8String {
     uint16_t length;         // Length of the string
-    uint8_t* varData;        // Pointer to UTF-8 data
+    const uint8_t* varData;  // Pointer to UTF-8 data, aliases the packet it was decoded from
 
     // Provide data() and size() methods
     const uint8_t* data() const { return varData; }
@@ -24,7 +24,7 @@ struct Utf8String {
 
 struct VarString {
     uint16_t length;         // Length of the string
-    uint8_t* varData;        // Pointer to ASCII data
+    const uint8_t* varData;  // Pointer to ASCII data, aliases the packet it was decoded from
 
     // Provide data() and size() methods
     const uint8_t* data() const { return varData; }
@@ -239,7 +239,7 @@ enum class MDFlagsSet : uint64_t
 // MDFlags2Set
 struct MDFlags2Set
 {
-    const uint64_t value = 0; // Bitmask representing MD Flags 2
+    uint64_t value = 0; // Bitmask representing MD Flags 2
 };
 
 // Enum class for FlagsSet
@@ -276,6 +276,7 @@ struct BestPricesEntry
     int64_t MktOfferSize;   // Total quantity in best offer
     int32_t SecurityID;         // Instrument numeric code
 };
+static_assert(sizeof(BestPricesEntry) == 36, "BestPricesEntry size is incorrect");
 
 struct BestPrices
 {
@@ -288,6 +289,7 @@ struct EmptyBook
 {
     uint32_t LastMsgSeqNumProcessed; // Sequence number of the last valid Incremental feed packet
 };
+static_assert(sizeof(EmptyBook) == 4, "EmptyBook size is incorrect");
 
 // Message: OrderUpdate
 struct OrderUpdate
@@ -333,21 +335,87 @@ struct OrderBookSnapshotEntry
     MDEntryType mdEntryType;     // Market Data entry type
 };
 
-struct OrderBookSnapshot
+// Root block of OrderBookSnapshot, laid out as on the wire so it is copied in one go
+struct OrderBookSnapshotBlock
 {
     int32_t SecurityID;              // Instrument numeric code
     uint32_t LastMsgSeqNumProcessed; // Sequence number of the last Incremental feed packet processed
     uint32_t RptSeq;                 // Market Data entry sequence number
     uint32_t ExchangeTradingSessionID; // Trading session ID
+};
+static_assert(sizeof(OrderBookSnapshotBlock) == 16, "OrderBookSnapshotBlock size is incorrect");
+
+struct OrderBookSnapshot : OrderBookSnapshotBlock
+{
     GroupSize NoMDEntries;         // Group size for entries
     std::unique_ptr<std::vector<OrderBookSnapshotEntry>> MDEntries; // Entries array
 
-    static constexpr size_t BASE_SIZE = sizeof(SecurityID) + sizeof(LastMsgSeqNumProcessed) +
-                                        sizeof(RptSeq) + sizeof(ExchangeTradingSessionID);
+    static constexpr size_t BASE_SIZE = sizeof(OrderBookSnapshotBlock);
 };
 
-// Message: SecurityDefinition
-struct SecurityDefinition
+// Schema version 3 layouts of the order templates (IDs 5, 6 and 7), before MDFlags2 was added in version 4
+// and the templates were renumbered. They are upgraded to the current messages when decoded
+struct OrderUpdateV3
+{
+    int64_t MDEntryID;
+    Decimal5 MDEntryPx;
+    int64_t MDEntrySize;
+    MDFlagsSet MDFlags;
+    int32_t SecurityID;
+    uint32_t RptSeq;
+    MDUpdateAction mdUpdateAction;
+    MDEntryType mdEntryType;
+};
+static_assert(sizeof(OrderUpdateV3) == 42, "OrderUpdateV3 size is incorrect");
+
+struct OrderExecutionV3
+{
+    int64_t MDEntryID;
+    Decimal5NULL MDEntryPx;
+    int64_t MDEntrySize;
+    Decimal5 LastPx;
+    int64_t LastQty;
+    int64_t TradeID;
+    MDFlagsSet MDFlags;
+    int32_t SecurityID;
+    uint32_t RptSeq;
+    MDUpdateAction mdUpdateAction;
+    MDEntryType mdEntryType;
+};
+static_assert(sizeof(OrderExecutionV3) == 66, "OrderExecutionV3 size is incorrect");
+
+struct OrderBookSnapshotEntryV3
+{
+    int64_t MDEntryID;
+    uint64_t TransactTime;
+    Decimal5NULL MDEntryPx;
+    int64_t MDEntrySize;
+    int64_t TradeID;
+    MDFlagsSet MDFlags;
+    MDEntryType mdEntryType;
+};
+static_assert(sizeof(OrderBookSnapshotEntryV3) == 49, "OrderBookSnapshotEntryV3 size is incorrect");
+
+inline OrderUpdate upgrade(const OrderUpdateV3& v3) noexcept
+{
+    return OrderUpdate{ v3.MDEntryID, v3.MDEntryPx, v3.MDEntrySize, v3.MDFlags, MDFlags2Set{},
+                        v3.SecurityID, v3.RptSeq, v3.mdUpdateAction, v3.mdEntryType };
+}
+
+inline OrderExecution upgrade(const OrderExecutionV3& v3) noexcept
+{
+    return OrderExecution{ v3.MDEntryID, v3.MDEntryPx, v3.MDEntrySize, v3.LastPx, v3.LastQty, v3.TradeID, v3.MDFlags,
+                           MDFlags2Set{}, v3.SecurityID, v3.RptSeq, v3.mdUpdateAction, v3.mdEntryType };
+}
+
+inline OrderBookSnapshotEntry upgrade(const OrderBookSnapshotEntryV3& v3) noexcept
+{
+    return OrderBookSnapshotEntry{ v3.MDEntryID, v3.TransactTime, v3.MDEntryPx, v3.MDEntrySize, v3.TradeID,
+                                   v3.MDFlags, MDFlags2Set{}, v3.mdEntryType };
+}
+
+// Root block of SecurityDefinition, laid out as on the wire so it is copied in one go
+struct SecurityDefinitionBlock
 {
     uint32_t TotNumReports;         // Total messages number in the current list
     char Symbol[25];              // Symbol code of the instrument
@@ -395,7 +463,11 @@ struct SecurityDefinition
     DoubleNULL InterestRate2RiskUp; // Interest rate risk for upward scenario (second rate)
     DoubleNULL InterestRate2RiskDown; // Interest rate risk for downward scenario (second rate)
     Decimal5NULL SettlPrice;      // Settlement price at the end of the clearing session
-    
+};
+
+// Message: SecurityDefinition
+struct SecurityDefinition : SecurityDefinitionBlock
+{
     struct MDFeedTypes
     {
         char MDFeedType[25];
@@ -449,59 +521,12 @@ struct SecurityDefinition
     Utf8String SecurityDesc;
     VarString QuotationList;
 
-    // Static constexpr member for size
-    static constexpr size_t BASE_SIZE =
-        sizeof(TotNumReports) +
-        sizeof(Symbol) +
-        sizeof(SecurityID) +
-        sizeof(SecurityIDSource) +
-        sizeof(SecurityAltID) +
-        sizeof(SecurityAltIDSource) +
-        sizeof(SecurityType) +
-        sizeof(CFICode) +
-        sizeof(StrikePrice) +
-        sizeof(ContractMultiplier) +
-        sizeof(SecurityTradingStatus) +
-        sizeof(Currency) +
-        sizeof(MarketID) +
-        sizeof(MarketSegmentID) +
-        sizeof(TradingSessionID) +
-        sizeof(ExchangeTradingSessionID) +
-        sizeof(Volatility) +
-        sizeof(HighLimitPx) +
-        sizeof(LowLimitPx) +
-        sizeof(MinPriceIncrement) +
-        sizeof(MinPriceIncrementAmount) +
-        sizeof(InitialMarginOnBuy) +
-        sizeof(InitialMarginOnSell) +
-        sizeof(InitialMarginSyntetic) +
-        sizeof(TheorPrice) +
-        sizeof(TheorPriceLimit) +
-        sizeof(UnderlyingQty) +
-        sizeof(UnderlyingCurrency) +
-        sizeof(MaturityDate) +
-        sizeof(MaturityTime) +
-        sizeof(Flags) +
-        sizeof(MinPriceIncrementAmountCurr) +
-        sizeof(SettlPriceOpen) +
-        sizeof(ValuationMethod) +
-        sizeof(RiskFreeRate) +
-        sizeof(FixedSpotDiscount) +
-        sizeof(ProjectedSpotDiscount) +
-        sizeof(SettlCurrency) +
-        sizeof(NegativePrices) +
-        sizeof(DerivativeContractMultiplier) +
-        sizeof(InterestRateRiskUp) +
-        sizeof(InterestRateRiskDown) +
-        sizeof(RiskFreeRate2) +
-        sizeof(InterestRate2RiskUp) +
-        sizeof(InterestRate2RiskDown) +
-        sizeof(SettlPrice);
+    static constexpr size_t BASE_SIZE = sizeof(SecurityDefinitionBlock);
 };
 
 struct SecurityStatus {
     int32_t SecurityID;                     // Instrument numeric code
-    char SecurityIDSource = SECURITY_ID_SOURCE; // Identifies class or source of SecurityID value
+    static constexpr char SecurityIDSource = SECURITY_ID_SOURCE; // Identifies class or source of SecurityID value, not on the wire
     char Symbol[25];                        // Symbol code of the instrument
     SecurityTradingStatus securityTradingStatus; // Identifies the trading status of the instrument
     Decimal5NULL HighLimitPx;               // Upper price limit
@@ -516,9 +541,10 @@ struct SecurityStatus {
 struct SecurityMassStatusEntry
 {
     int32_t SecurityID;            // Instrument numeric code
-    char SecurityIDSource = SECURITY_ID_SOURCE; // Class or source of SecurityID
+    static constexpr char SecurityIDSource = SECURITY_ID_SOURCE; // Class or source of SecurityID, not on the wire
     SecurityTradingStatus securityTradingStatus; // Trading status of the instrument
 };
+static_assert(sizeof(SecurityMassStatusEntry) == 5, "SecurityMassStatusEntry size is incorrect");
 
 struct SecurityMassStatus
 {
@@ -568,14 +594,26 @@ struct MarketDataRequest
     uint32_t ApplEndSeqNum; // Sequence number of the last requested message
 };
 
-using SIMBAMessage = std::variant<OrderUpdate, OrderExecution, OrderBookSnapshot, SecurityDefinition, SecurityStatus, SecurityDefinitionUpdateReport, SequenceReset, TradingSessionStatus>;
-
-struct SIMBAPacket
+// Wire layout of everything that follows a message's root block. Enough to step over a message by its
+// group headers and var data lengths without knowing what the fields are
+struct TemplateLayout
 {
-    MarketDataPacketHeader marketDataHeader{};
-    std::optional<IncrementalPacketHeader> incrementalHeader{};
-    MessageHeader messageHeader{};
-    std::vector<SIMBAMessage> messages;
+    uint8_t numGroups;   // Repeating groups after the root block
+    bool groupSize2;     // Groups are prefixed by GroupSize2 (uint16_t numInGroup) instead of GroupSize
+    uint8_t numVarData;  // Length prefixed var data fields after the groups
 };
 
+constexpr TemplateLayout templateLayout(uint16_t templateId) noexcept
+{
+    switch (templateId)
+    {
+    case 3:  return { 1, false, 0 }; // BestPrices
+    case 7:  return { 1, false, 0 }; // OrderBookSnapshot (schema version 3)
+    case 17: return { 1, false, 0 }; // OrderBookSnapshot
+    case 18: return { 5, false, 2 }; // SecurityDefinition
+    case 19: return { 1, true, 0 };  // SecurityMassStatus
+    default: return { 0, false, 0 }; // Root block only
+    }
+}
+
 #pragma pack(pop)
\ No newline at end of file
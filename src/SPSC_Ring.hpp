@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Bounded lock-free ring between exactly one producer and one consumer thread. Head and tail sit on
+// their own cache lines, and each side keeps a cached copy of the other side's index so the shared
+// line is only read when the ring looks full or empty
+template<typename T>
+class SPSCRing
+{
+public:
+	explicit SPSCRing(size_t capacity)
+	{
+		size_t size = 2;
+		while (size < capacity)
+			size <<= 1;
+		slots.resize(size);
+		mask = size - 1;
+	}
+
+	SPSCRing(const SPSCRing&) = delete;
+	SPSCRing& operator=(const SPSCRing&) = delete;
+
+	// Producer side
+	bool tryPush(const T& value)
+	{
+		const size_t tail = tailIndex.load(std::memory_order_relaxed);
+		if (tail - cachedHead > mask)
+		{
+			cachedHead = headIndex.load(std::memory_order_acquire);
+			if (tail - cachedHead > mask)
+				return false;
+		}
+
+		slots[tail & mask] = value;
+		tailIndex.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side
+	bool tryPop(T& value)
+	{
+		const size_t head = headIndex.load(std::memory_order_relaxed);
+		if (head == cachedTail)
+		{
+			cachedTail = tailIndex.load(std::memory_order_acquire);
+			if (head == cachedTail)
+				return false;
+		}
+
+		value = slots[head & mask];
+		headIndex.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	static constexpr size_t CACHE_LINE = 64;
+
+	std::vector<T> slots;
+	size_t mask = 0;
+
+	alignas(CACHE_LINE) std::atomic<size_t> headIndex{ 0 }; // Next slot to pop, written by the consumer
+	size_t cachedTail = 0;                                  // Consumer's view of tailIndex
+
+	alignas(CACHE_LINE) std::atomic<size_t> tailIndex{ 0 }; // Next slot to push, written by the producer
+	size_t cachedHead = 0;                                  // Producer's view of headIndex
+};
+
+// Spins briefly, then yields the core, while waiting on a ring
+class Backoff
+{
+public:
+	void pause() noexcept
+	{
+		if (++spins < SPIN_LIMIT)
+			return;
+		std::this_thread::yield();
+	}
+
+	void reset() noexcept { spins = 0; }
+
+private:
+	static constexpr unsigned SPIN_LIMIT = 64;
+	unsigned spins = 0;
+};
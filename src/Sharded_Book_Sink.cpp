@@ -0,0 +1,261 @@
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Flat_Index.hpp"
+#include "Sharded_Book_Sink.hpp"
+
+ShardedBookSink::ShardedBookSink(const std::string& outputFilePath, const ParserOptions& options)
+    : outputFile(outputFilePath, options.compression)
+{
+    for (size_t i = 0; i < options.threads; ++i)
+    {
+        auto shard = std::make_unique<Shard>(options);
+        for (size_t j = 0; j < BATCHES_PER_SHARD; ++j)
+        {
+            shard->batches.push_back(std::make_unique<Batch>());
+            shard->free.push_back(shard->batches.back().get());
+        }
+        shards.push_back(std::move(shard));
+    }
+
+    for (auto& shard : shards)
+        shard->thread = std::thread(&ShardedBookSink::run, this, std::ref(*shard));
+}
+
+void ShardedBookSink::run(Shard& shard)
+{
+    Backoff backoff;
+    Batch* batch = nullptr;
+    while (true)
+    {
+        if (!shard.work.tryPop(batch))
+        {
+            // A batch pushed before stopping was set is visible once stopping is
+            if (stopping.load(std::memory_order_acquire) && !shard.work.tryPop(batch))
+                return;
+            if (!batch)
+            {
+                backoff.pause();
+                continue;
+            }
+        }
+        backoff.reset();
+
+        batch->outputEnds.clear();
+        for (size_t i = 0; i < batch->count; ++i)
+        {
+            shard.builder.onPacket(batch->packets[i]);
+            batch->outputEnds.push_back(static_cast<size_t>(shard.output.tellp()));
+        }
+        batch->output = std::move(shard.output).str();
+        shard.output.str(std::string());
+
+        // Never full, a shard has no more batches than the ring holds
+        while (!shard.done.tryPush(batch))
+            backoff.pause();
+        batch = nullptr;
+    }
+}
+
+void ShardedBookSink::onPacket(const SIMBAPacket& packet)
+{
+    if (!shards.front()->current)
+        acquire();
+
+    for (auto& shard : shards)
+    {
+        SIMBAPacket& copy = shard->current->packets[shard->current->count];
+        copy.marketDataHeader = packet.marketDataHeader;
+        copy.incrementalHeader = packet.incrementalHeader;
+        copy.messageHeader = packet.messageHeader;
+        copy.messages.clear();
+    }
+
+    route(packet);
+
+    for (auto& shard : shards)
+        ++shard->current->count;
+
+    if (shards.front()->current->count == BATCH_PACKETS)
+        dispatch();
+}
+
+SIMBAPacket& ShardedBookSink::packetFor(int32_t securityId)
+{
+    Shard& shard = *shards[mixHash(static_cast<uint32_t>(securityId)) % shards.size()];
+    return shard.current->packets[shard.current->count];
+}
+
+void ShardedBookSink::route(const SIMBAPacket& packet)
+{
+    packet.messages.forEach([this](const auto& message)
+    {
+        using Message = std::remove_cvref_t<decltype(message)>;
+        if constexpr (std::is_same_v<Message, OrderUpdate> || std::is_same_v<Message, OrderExecution> ||
+                      std::is_same_v<Message, SecurityDefinitionUpdateReport>)
+        {
+            packetFor(message.SecurityID).messages.emplace_back(message);
+        }
+        else if constexpr (std::is_same_v<Message, OrderBookSnapshot>)
+        {
+            OrderBookSnapshot copy;
+            static_cast<OrderBookSnapshotBlock&>(copy) = message;
+            copy.NoMDEntries = message.NoMDEntries;
+            if (message.MDEntries)
+                copy.MDEntries = std::make_unique<std::vector<OrderBookSnapshotEntry>>(*message.MDEntries);
+            packetFor(message.SecurityID).messages.emplace_back(std::move(copy));
+        }
+        else if constexpr (std::is_same_v<Message, SecurityDefinition>)
+        {
+            // The books only need the fixed block, the var data aliases the packet being parsed
+            SecurityDefinition copy{};
+            static_cast<SecurityDefinitionBlock&>(copy) = message;
+            packetFor(message.SecurityID).messages.emplace_back(std::move(copy));
+        }
+        else if constexpr (std::is_same_v<Message, BestPrices>)
+        {
+            for (const BestPricesEntry& entry : message.MDEntries)
+            {
+                BestPrices single{ message.NoMDEntries, { entry } };
+                single.NoMDEntries.numInGroup = 1;
+                packetFor(entry.SecurityID).messages.emplace_back(std::move(single));
+            }
+        }
+    });
+}
+
+void ShardedBookSink::dispatch()
+{
+    for (auto& shard : shards)
+    {
+        Backoff backoff;
+        while (!shard->work.tryPush(shard->current))
+            backoff.pause();
+        shard->current = nullptr;
+    }
+    merge(false);
+}
+
+void ShardedBookSink::acquire()
+{
+    // Shards take batches in lockstep, so either all of them have one free or none has
+    while (shards.front()->free.empty())
+        merge(true);
+
+    for (auto& shard : shards)
+    {
+        shard->current = shard->free.back();
+        shard->free.pop_back();
+        shard->current->count = 0;
+    }
+}
+
+bool ShardedBookSink::merge(bool wait)
+{
+    Backoff backoff;
+    bool merged = false;
+    while (true)
+    {
+        bool complete = true;
+        for (auto& shard : shards)
+        {
+            Batch* batch;
+            while (shard->done.tryPop(batch))
+                shard->finished.push_back(batch);
+            complete = complete && !shard->finished.empty();
+        }
+
+        if (!complete)
+        {
+            if (merged || !wait)
+                return merged;
+            backoff.pause();
+            continue;
+        }
+
+        // Every shard is done with the oldest batch: write it packet by packet, shards in order
+        const size_t count = shards.front()->finished.front()->count;
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (auto& shard : shards)
+            {
+                const Batch& batch = *shard->finished.front();
+                const size_t begin = i == 0 ? 0 : batch.outputEnds[i - 1];
+                outputFile.write(batch.output.data() + begin, batch.outputEnds[i] - begin);
+            }
+        }
+
+        for (auto& shard : shards)
+        {
+            shard->free.push_back(shard->finished.front());
+            shard->finished.pop_front();
+        }
+        merged = true;
+        backoff.reset();
+    }
+}
+
+void ShardedBookSink::save(CheckpointWriter& writer)
+{
+    if (shards.front()->current && shards.front()->current->count != 0)
+        dispatch();
+    while (shards.front()->free.size() + (shards.front()->current ? 1 : 0) < BATCHES_PER_SHARD)
+        merge(true);
+
+    writer.write<uint32_t>(static_cast<uint32_t>(shards.size()));
+    for (auto& shard : shards)
+        shard->builder.save(writer);
+}
+
+void ShardedBookSink::restore(CheckpointReader& reader)
+{
+    // Before the first packet, the workers have not touched their builders yet
+    if (reader.read<uint32_t>() != shards.size())
+        throw std::runtime_error("Checkpoint was written with a different number of book threads.");
+    for (auto& shard : shards)
+        shard->builder.restore(reader);
+}
+
+ShardedBookSink::~ShardedBookSink()
+{
+    if (!shards.empty() && shards.front()->current)
+    {
+        if (shards.front()->current->count != 0)
+        {
+            dispatch();
+        }
+        else
+        {
+            for (auto& shard : shards)
+            {
+                shard->free.push_back(shard->current);
+                shard->current = nullptr;
+            }
+        }
+    }
+
+    stopping.store(true, std::memory_order_release);
+    for (auto& shard : shards)
+        shard->thread.join();
+    merge(false);
+
+    BookBuilder::Statistics statistics;
+    for (auto& shard : shards)
+    {
+        shard->builder.finish();
+        outputFile << shard->output.str();
+        shard->output.str(std::string());
+        statistics.add(shard->builder.statistics());
+    }
+    try
+    {
+        outputFile.close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+
+    statistics.print(std::cout);
+}
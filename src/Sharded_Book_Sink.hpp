@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Async_Writer.hpp"
+#include "Book_Builder.hpp"
+#include "Packet_Sink.hpp"
+#include "Parser_Options.hpp"
+#include "SPSC_Ring.hpp"
+
+// Builds the books on worker threads, each owning the instruments whose SecurityID hashes to it. The
+// parsing thread copies every packet header to every shard and each book message only to its owner, in
+// batches handed over through SPSC rings, so an instrument's updates are applied in feed order by a single
+// thread. Shards write their output per packet; the parsing thread merges it back packet by packet, so
+// lines stay in SendingTime order across instruments and interval boundaries fall on the same packet
+// in every shard
+class ShardedBookSink : public PacketSink
+{
+public:
+	ShardedBookSink(const std::string& outputFilePath, const ParserOptions& options);
+	~ShardedBookSink() override;
+
+	void onPacket(const SIMBAPacket& packet) override;
+
+	// Only between packets: waits for the shards to finish everything handed to them, the builders are
+	// then left alone by the workers until the next batch
+	void save(CheckpointWriter& writer) override;
+	void restore(CheckpointReader& reader) override;
+
+private:
+	static constexpr size_t BATCH_PACKETS = 256;   // Packets handed to a shard at a time
+	static constexpr size_t BATCHES_PER_SHARD = 8; // Bounds memory and how far parsing runs ahead of a shard
+
+	// A run of packets for one shard, returned with the output the shard wrote for them
+	struct Batch
+	{
+		std::vector<SIMBAPacket> packets{ BATCH_PACKETS }; // Reused, only the first count are filled
+		size_t count = 0;
+		std::string output;
+		std::vector<size_t> outputEnds; // End of each packet's output within output
+	};
+
+	struct Shard
+	{
+		explicit Shard(const ParserOptions& options) : builder(output, options) {}
+
+		std::ostringstream output;
+		BookBuilder builder;
+		SPSCRing<Batch*> work{ BATCHES_PER_SHARD }; // Parsing thread to worker
+		SPSCRing<Batch*> done{ BATCHES_PER_SHARD }; // Worker back to parsing thread
+		std::thread thread;
+
+		// Parsing thread only
+		std::vector<std::unique_ptr<Batch>> batches;
+		std::vector<Batch*> free;
+		std::deque<Batch*> finished; // Processed, waiting for the other shards to finish the same batch
+		Batch* current = nullptr;
+	};
+
+	void run(Shard& shard);
+	void route(const SIMBAPacket& packet);
+	SIMBAPacket& packetFor(int32_t securityId);
+	void dispatch();
+	void acquire();
+	bool merge(bool wait);
+
+	AsyncFileStream outputFile;
+	std::vector<std::unique_ptr<Shard>> shards;
+	std::atomic<bool> stopping{ false };
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include "SIMBA_Messages.hpp"
+
+// Follows the fragments of one instrument's snapshot, StartOfSnapshot to EndOfSnapshot, on the snapshot
+// feed. Feeds A and B carry every fragment under the same MsgSeqNum, so a fragment of the same snapshot
+// at or before the last one taken is the other feed's copy; only a jump forward loses a fragment
+struct SnapshotFragments
+{
+	enum class Fragment : uint8_t
+	{
+		Duplicate, // Already seen on the other feed, ignored
+		First,     // StartOfSnapshot, a new snapshot begins
+		Next,      // Continues the snapshot being loaded
+		Lost       // Joined in the middle of a snapshot or a fragment is missing, wait for the next one
+	};
+
+	Fragment next(const OrderBookSnapshot& snapshot, const MarketDataPacketHeader& header) noexcept
+	{
+		if (header.MsgSeqNum <= lastSeq && snapshot.RptSeq == rptSeq)
+			return Fragment::Duplicate;
+
+		Fragment fragment = Fragment::Next;
+		if (header.MsgFlags & static_cast<uint16_t>(MsgFlagsSet::StartOfSnapshot))
+		{
+			fragment = Fragment::First;
+			rptSeq = snapshot.RptSeq;
+			loading = true;
+		}
+		else if (!loading || header.MsgSeqNum != lastSeq + 1 || snapshot.RptSeq != rptSeq)
+		{
+			// The other feed may still deliver the whole snapshot, none of it is a duplicate any more
+			loading = false;
+			lastSeq = 0;
+			return Fragment::Lost;
+		}
+
+		lastSeq = header.MsgSeqNum;
+		if (header.MsgFlags & static_cast<uint16_t>(MsgFlagsSet::EndOfSnapshot))
+			loading = false;
+		return fragment;
+	}
+
+	uint32_t lastSeq = 0; // MsgSeqNum of the last fragment taken
+	uint32_t rptSeq = 0;  // Of the snapshot being loaded, or the last one
+	bool loading = false; // Between the first and the last fragment
+};
@@ -0,0 +1,30 @@
+#include "Thread_Affinity.hpp"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+bool pinThread(std::thread& thread, unsigned core)
+{
+#ifdef _WIN32
+    if (core >= 64)
+        return false; // Beyond the first processor group
+    return SetThreadAffinityMask(static_cast<HANDLE>(thread.native_handle()), DWORD_PTR(1) << core) != 0;
+#elif defined(__linux__)
+    if (core >= CPU_SETSIZE)
+        return false;
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    CPU_SET(core, &cores);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(cores), &cores) == 0;
+#else
+    (void)thread;
+    (void)core;
+    return false; // No hard affinity on macOS
+#endif
+}
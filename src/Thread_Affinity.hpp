@@ -0,0 +1,7 @@
+#pragma once
+
+#include <thread>
+
+// Pins a thread to one CPU core. False where the platform has no such call or the core does not exist,
+// the thread then keeps running wherever the scheduler puts it
+bool pinThread(std::thread& thread, unsigned core);
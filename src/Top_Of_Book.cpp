@@ -0,0 +1,56 @@
+#include "Top_Of_Book.hpp"
+
+void TopOfBook::onLevel(uint32_t book, OrderBook::Side, int64_t, int64_t, uint32_t)
+{
+    touch(book);
+}
+
+void TopOfBook::onClear(uint32_t book)
+{
+    touch(book);
+}
+
+TopOfBook::Quote TopOfBook::quoteOf(const OrderBook& books, uint32_t book) noexcept
+{
+    Quote quote;
+    if (const OrderBook::PriceLevel* bid = books.bestLevel(book, OrderBook::Bid))
+    {
+        quote.bidPrice = bid->price;
+        quote.bidSize = bid->size;
+    }
+    if (const OrderBook::PriceLevel* offer = books.bestLevel(book, OrderBook::Offer))
+    {
+        quote.offerPrice = offer->price;
+        quote.offerSize = offer->size;
+    }
+    return quote;
+}
+
+bool TopOfBook::report(uint32_t book, const Quote& quote)
+{
+    if (book >= quotes.size())
+        quotes.resize(book + 1);
+
+    if (quotes[book] == quote)
+        return false;
+    quotes[book] = quote;
+    return true;
+}
+
+void TopOfBook::restore(CheckpointReader& reader)
+{
+    reader.readVector(quotes);
+    takeTouched([](uint32_t) {});
+}
+
+void TopOfBook::touch(uint32_t book)
+{
+    if (book >= touched.size())
+        touched.resize(book + 1);
+
+    if (!touched[book])
+    {
+        touched[book] = true;
+        touchedBooks.push_back(book);
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Checkpoint.hpp"
+#include "Order_Book.hpp"
+#include "SIMBA_Schema.hpp"
+
+// Best bid and offer of every instrument, as last reported. Listens to the L3 book only to learn which
+// books were touched; whether their best prices really changed is decided once per packet by comparing
+// the book's best levels with the last reported quote
+class TopOfBook : public OrderBook::Listener
+{
+public:
+	struct Quote
+	{
+		int64_t bidPrice = Decimal5NULL::NULL_VALUE; // Decimal5 mantissa, NULL_VALUE for an empty side
+		int64_t bidSize = 0;
+		int64_t offerPrice = Decimal5NULL::NULL_VALUE;
+		int64_t offerSize = 0;
+
+		bool operator==(const Quote&) const = default;
+	};
+
+	void onLevel(uint32_t book, OrderBook::Side side, int64_t price, int64_t size, uint32_t orderCount) override;
+	void onClear(uint32_t book) override;
+
+	static Quote quoteOf(const OrderBook& books, uint32_t book) noexcept;
+
+	// Remembers quote as the book's last one, returns false if it is the same as before
+	bool report(uint32_t book, const Quote& quote);
+
+	// The last reported quotes. Books touched while the book itself was being restored are forgotten,
+	// their quotes were reported before the checkpoint
+	void save(CheckpointWriter& writer) const { writer.writeVector(quotes); }
+	void restore(CheckpointReader& reader);
+
+	// Calls function(book) for every book touched since the last call
+	template<typename Function>
+	void takeTouched(Function&& function)
+	{
+		for (uint32_t book : touchedBooks)
+		{
+			touched[book] = false;
+			function(book);
+		}
+		touchedBooks.clear();
+	}
+
+private:
+	void touch(uint32_t book);
+
+	std::vector<Quote> quotes;    // Same positions as OrderBook::books()
+	std::vector<uint8_t> touched;
+	std::vector<uint32_t> touchedBooks;
+};
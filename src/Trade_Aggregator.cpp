@@ -0,0 +1,86 @@
+#include "Trade_Aggregator.hpp"
+
+bool TradeAggregator::onExecution(uint64_t time, const OrderExecution& execution, Trade& trade)
+{
+    if (execution.LastQty <= 0)
+        return false;
+
+    const uint32_t instrument = instruments.add(execution.SecurityID);
+    if (instrument >= lastTradeIds.size())
+    {
+        lastTradeIds.resize(instruments.size(), 0);
+        bars.resize(instruments.size());
+    }
+
+    if (execution.TradeID <= lastTradeIds[instrument])
+    {
+        ++stats.repeats;
+        return false;
+    }
+    lastTradeIds[instrument] = execution.TradeID;
+    ++stats.trades;
+
+    // The executed order is either the resting one, so the aggressor took the other side, or the
+    // aggressive order itself
+    const uint64_t flags = static_cast<uint64_t>(execution.MDFlags);
+    const bool bid = execution.mdEntryType == MDEntryType::Bid;
+    Side aggressor = Side::Unknown;
+    if (flags & static_cast<uint64_t>(MDFlagsSet::PassiveSide))
+        aggressor = bid ? Side::Sell : Side::Buy;
+    else if (flags & static_cast<uint64_t>(MDFlagsSet::ActiveSide))
+        aggressor = bid ? Side::Buy : Side::Sell;
+
+    trade.time = time;
+    trade.instrument = instrument;
+    trade.securityId = execution.SecurityID;
+    trade.tradeId = execution.TradeID;
+    trade.price = execution.LastPx.mantissa;
+    trade.qty = execution.LastQty;
+    trade.aggressor = aggressor;
+    return true;
+}
+
+void TradeAggregator::add(Bar& bar, const Trade& trade, int64_t qty)
+{
+    if (bar.trades == 0)
+    {
+        if (barInterval != 0)
+        {
+            bar.start = trade.time / barInterval * barInterval;
+            bar.end = bar.start + barInterval;
+            openBars.push_back(trade.instrument);
+        }
+        else
+        {
+            bar.start = trade.time;
+        }
+        bar.open = bar.high = bar.low = trade.price;
+    }
+    if (barInterval == 0)
+        bar.end = trade.time;
+
+    bar.high = std::max(bar.high, trade.price);
+    bar.low = std::min(bar.low, trade.price);
+    bar.close = trade.price;
+    bar.volume += qty;
+    if (trade.aggressor == Side::Buy)
+        bar.buyVolume += qty;
+    else if (trade.aggressor == Side::Sell)
+        bar.sellVolume += qty;
+    ++bar.trades;
+    bar.notional += static_cast<Notional>(trade.price) * qty;
+}
+
+int64_t TradeAggregator::Bar::vwap() const noexcept
+{
+    if (volume == 0)
+        return Decimal5NULL::NULL_VALUE;
+
+#if defined(__SIZEOF_INT128__)
+    const Notional half = volume / 2;
+    return static_cast<int64_t>(notional >= 0 ? (notional + half) / volume : (notional - half) / volume);
+#else
+    const Notional average = notional / volume;
+    return static_cast<int64_t>(average >= 0 ? average + 0.5L : average - 0.5L);
+#endif
+}
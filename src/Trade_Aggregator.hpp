@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Instrument_Directory.hpp"
+#include "SIMBA_Schema.hpp"
+
+// Trades of every instrument taken from OrderExecution, and OHLCV bars built from them by time or by
+// volume. Both sides of a match may be published with the same TradeID, and so is every trade again on
+// the second feed; exchange TradeIDs only grow, so anything not above an instrument's last TradeID is
+// a repeat. Prices stay Decimal5 mantissas and bar state is a plain array by instrument index, nothing
+// is allocated per trade
+class TradeAggregator
+{
+public:
+#if defined(__SIZEOF_INT128__)
+	using Notional = __int128;
+#else
+	using Notional = long double; // No 128 bit integer on MSVC, VWAP may be off by one in the last digit
+#endif
+
+	enum class Side : uint8_t { Unknown, Buy, Sell };
+
+	struct Trade
+	{
+		uint64_t time = 0;       // SendingTime of the packet
+		uint32_t instrument = 0; // InstrumentDirectory index
+		int32_t securityId = 0;
+		int64_t tradeId = 0;
+		int64_t price = 0;       // Decimal5 mantissa
+		int64_t qty = 0;
+		Side aggressor = Side::Unknown;
+	};
+
+	struct Bar
+	{
+		uint64_t start = 0; // Interval bounds for time bars, first and last trade for volume bars
+		uint64_t end = 0;
+		int64_t open = 0;   // Decimal5 mantissas
+		int64_t high = 0;
+		int64_t low = 0;
+		int64_t close = 0;
+		int64_t volume = 0;
+		int64_t buyVolume = 0;  // Bought by the aggressor
+		int64_t sellVolume = 0; // Sold by the aggressor
+		uint32_t trades = 0;
+		Notional notional = 0;  // Sum of price mantissa times quantity
+
+		int64_t vwap() const noexcept; // Decimal5 mantissa, rounded half away from zero
+	};
+
+	struct Statistics
+	{
+		uint64_t trades = 0;
+		uint64_t repeats = 0; // Executions of a trade that was already counted
+		uint64_t bars = 0;
+	};
+
+	// barInterval in nanoseconds for time bars, or barVolume in contracts for volume bars
+	TradeAggregator(InstrumentDirectory& instruments, uint64_t barInterval, int64_t barVolume)
+		: instruments(instruments), barInterval(barInterval), barVolume(barVolume) {}
+
+	// Fills trade from execution, returns false if it is a repeat or not a trade
+	bool onExecution(uint64_t time, const OrderExecution& execution, Trade& trade);
+
+	// Time bars: a packet at time closes the interval before it, function(bar, instrument) gets every
+	// instrument that traded in it. Called before the trades of the packet are added
+	template<typename Function>
+	void closeInterval(uint64_t time, Function&& function)
+	{
+		if (barInterval == 0 || time < nextBarTime)
+			return;
+
+		for (uint32_t instrument : openBars)
+			emit(instrument, function);
+		openBars.clear();
+		nextBarTime = (time / barInterval + 1) * barInterval;
+	}
+
+	// Volume bars: function(bar, instrument) gets every bar the trade fills up. A trade larger than
+	// what is left of the bar is split over as many bars as it takes
+	template<typename Function>
+	void addTrade(const Trade& trade, Function&& function)
+	{
+		int64_t qty = trade.qty;
+		while (qty > 0)
+		{
+			Bar& bar = bars[trade.instrument];
+			const int64_t part = barVolume == 0 ? qty : std::min(qty, barVolume - bar.volume);
+			add(bar, trade, part);
+			qty -= part;
+
+			if (barVolume != 0 && bar.volume == barVolume)
+				emit(trade.instrument, function);
+		}
+	}
+
+	// Writes out the bars still open at the end of the capture, by instrument index
+	template<typename Function>
+	void finish(Function&& function)
+	{
+		for (uint32_t instrument = 0; instrument < bars.size(); ++instrument)
+		{
+			if (bars[instrument].trades != 0)
+				emit(instrument, function);
+		}
+		openBars.clear();
+	}
+
+	const Statistics& statistics() const noexcept { return stats; }
+
+private:
+	void add(Bar& bar, const Trade& trade, int64_t qty);
+
+	template<typename Function>
+	void emit(uint32_t instrument, Function& function)
+	{
+		function(bars[instrument], instrument);
+		bars[instrument] = Bar{};
+		++stats.bars;
+	}
+
+	InstrumentDirectory& instruments;
+	uint64_t barInterval;
+	int64_t barVolume;
+	uint64_t nextBarTime = 0; // End of the current time bar interval
+
+	std::vector<int64_t> lastTradeIds; // By instrument index
+	std::vector<Bar> bars;             // By instrument index, trades == 0 while nothing traded
+	std::vector<uint32_t> openBars;    // Instruments that traded in the current time bar interval
+	Statistics stats;
+};
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "Trade_Sink.hpp"
+
+TradeSink::TradeSink(const std::string& outputFilePath, const ParserOptions& options)
+    : outputFile(outputFilePath, options.compression), mode(options.mode),
+      aggregator(instruments, options.mode == OutputMode::Bars ? options.interval : 0, options.mode == OutputMode::Bars ? options.barVolume : 0)
+{
+}
+
+TemplateFilter TradeSink::requiredTemplates()
+{
+    TemplateFilter filter;
+    filter.addMessage(MessageTraits<OrderExecution>::templateId);
+    return filter;
+}
+
+void TradeSink::onPacket(const SIMBAPacket& packet)
+{
+    const uint64_t sendingTime = packet.marketDataHeader.SendingTime;
+    const auto writeBar = [this](const TradeAggregator::Bar& bar, uint32_t instrument) { this->writeBar(bar, instrument); };
+
+    if (mode == OutputMode::Bars)
+        aggregator.closeInterval(sendingTime, writeBar);
+
+    packet.messages.forEach([&](const auto& message)
+    {
+        if constexpr (std::is_same_v<std::remove_cvref_t<decltype(message)>, OrderExecution>)
+        {
+            TradeAggregator::Trade trade;
+            if (!aggregator.onExecution(sendingTime, message, trade))
+                return;
+
+            if (mode == OutputMode::Trades)
+                writeTrade(trade);
+            else
+                aggregator.addTrade(trade, writeBar);
+        }
+    });
+}
+
+void TradeSink::writeTrade(const TradeAggregator::Trade& trade)
+{
+    outputFile << "{\"SendingTime\":" << trade.time << ",\"SecurityID\":" << trade.securityId << ",\"TradeID\":" << trade.tradeId
+        << ",\"Price\":" << trade.price << ",\"Qty\":" << trade.qty << ",\"Side\":"
+        << (trade.aggressor == TradeAggregator::Side::Buy ? "\"Buy\"" : trade.aggressor == TradeAggregator::Side::Sell ? "\"Sell\"" : "null")
+        << "}\n";
+}
+
+void TradeSink::writeBar(const TradeAggregator::Bar& bar, uint32_t instrument)
+{
+    outputFile << "{\"SecurityID\":" << instruments.securityId(instrument) << ",\"Start\":" << bar.start << ",\"End\":" << bar.end
+        << ",\"Open\":" << bar.open << ",\"High\":" << bar.high << ",\"Low\":" << bar.low << ",\"Close\":" << bar.close
+        << ",\"Volume\":" << bar.volume << ",\"VWAP\":" << bar.vwap() << ",\"Trades\":" << bar.trades
+        << ",\"BuyVolume\":" << bar.buyVolume << ",\"SellVolume\":" << bar.sellVolume << "}\n";
+}
+
+TradeSink::~TradeSink()
+{
+    try
+    {
+        if (mode == OutputMode::Bars)
+            aggregator.finish([this](const TradeAggregator::Bar& bar, uint32_t instrument) { writeBar(bar, instrument); });
+        outputFile.close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+
+    const TradeAggregator::Statistics& statistics = aggregator.statistics();
+    std::cout << statistics.trades << " trades | " << statistics.repeats << " repeated executions | "
+        << statistics.bars << " bars" << "\n";
+}
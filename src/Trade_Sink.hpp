@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+
+#include "Async_Writer.hpp"
+#include "Instrument_Directory.hpp"
+#include "Packet_Sink.hpp"
+#include "Parser_Options.hpp"
+#include "Trade_Aggregator.hpp"
+
+// Writes the trades of the capture as JSON lines, either every trade as it happens (Trades) or OHLCV
+// bars per instrument (Bars), closed at the end of each time interval or whenever the volume is reached
+class TradeSink : public PacketSink
+{
+public:
+	TradeSink(const std::string& outputFilePath, const ParserOptions& options);
+	~TradeSink() override;
+
+	// OrderExecution is all the trades are built from
+	static TemplateFilter requiredTemplates();
+
+	void onPacket(const SIMBAPacket& packet) override;
+
+private:
+	void writeTrade(const TradeAggregator::Trade& trade);
+	void writeBar(const TradeAggregator::Bar& bar, uint32_t instrument);
+
+	AsyncFileStream outputFile;
+	OutputMode mode;
+	InstrumentDirectory instruments;
+	TradeAggregator aggregator;
+};
@@ -0,0 +1,136 @@
+#include <chrono>
+#include <iostream>
+#include <utility>
+
+#include "Work_Stealing_Scheduler.hpp"
+#include "Thread_Affinity.hpp"
+
+namespace
+{
+    // Which scheduler's worker the current thread is, so a task submitting more work keeps it local
+    thread_local const WorkStealingScheduler* currentScheduler = nullptr;
+    thread_local size_t currentWorker = 0;
+}
+
+WorkStealingScheduler::WorkStealingScheduler(size_t workers, const std::vector<int>& cores)
+    : stats(workers)
+{
+    for (size_t i = 0; i < workers; ++i)
+        queues.push_back(std::make_unique<Queue>());
+
+    for (size_t i = 0; i < workers; ++i)
+    {
+        threads.emplace_back(&WorkStealingScheduler::run, this, i);
+        if (i < cores.size() && cores[i] >= 0 && !pinThread(threads.back(), static_cast<unsigned>(cores[i])))
+            std::cerr << "Unable to pin worker " << i << " to core " << cores[i] << "\n";
+    }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads)
+        thread.join();
+}
+
+void WorkStealingScheduler::submit(Task task)
+{
+    unfinished.fetch_add(1, std::memory_order_relaxed);
+
+    const size_t queue = currentScheduler == this
+        ? currentWorker
+        : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        queues[queue]->tasks.push_back(std::move(task));
+    }
+
+    {
+        // Under the lock a worker checks queued with before sleeping, so the wake up is not lost
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued.fetch_add(1, std::memory_order_relaxed);
+    }
+    wake.notify_one();
+}
+
+void WorkStealingScheduler::wait()
+{
+    std::unique_lock<std::mutex> lock(idleMutex);
+    idle.wait(lock, [this]() { return unfinished.load(std::memory_order_acquire) == 0; });
+    if (error)
+        std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+bool WorkStealingScheduler::takeOwn(size_t worker, Task& task)
+{
+    Queue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+        return false;
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool WorkStealingScheduler::steal(size_t worker, Task& task)
+{
+    for (size_t i = 1; i < queues.size(); ++i)
+    {
+        Queue& victim = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty())
+            continue;
+        task = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingScheduler::run(size_t worker)
+{
+    currentScheduler = this;
+    currentWorker = worker;
+    WorkerStatistics& statistics = stats[worker];
+
+    for (;;)
+    {
+        Task task;
+        const bool own = takeOwn(worker, task);
+        if (!own && !steal(worker, task))
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this]() { return stopping || queued.load(std::memory_order_relaxed) != 0; });
+            if (stopping && queued.load(std::memory_order_relaxed) == 0)
+                return;
+            continue;
+        }
+        queued.fetch_sub(1, std::memory_order_relaxed);
+
+        const auto start = std::chrono::steady_clock::now();
+        try
+        {
+            task(worker);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            if (!error)
+                error = std::current_exception();
+        }
+        statistics.busy += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        ++statistics.tasks;
+        if (!own)
+            ++statistics.stolen;
+
+        if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            idle.notify_all();
+        }
+    }
+}
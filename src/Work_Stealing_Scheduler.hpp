@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs tasks on a fixed set of worker threads, each with its own deque. Tasks submitted from outside
+// are dealt to the deques in turn, a task submitted by a worker goes to that worker's deque. A worker
+// takes its own tasks oldest first, so work submitted in sequence also completes close to it, and once
+// its deque is empty steals from the other end of another worker's. A burst of heavy tasks on one
+// deque is thereby spread over every idle worker instead of waiting behind its owner
+class WorkStealingScheduler
+{
+public:
+	using Task = std::function<void(size_t worker)>; // Given the index of the worker running it, for per worker state
+
+	struct WorkerStatistics
+	{
+		uint64_t tasks = 0;  // Run by the worker
+		uint64_t stolen = 0; // Of those, taken from another worker's deque
+		uint64_t busy = 0;   // Nanoseconds spent running tasks
+	};
+
+	// cores pins the workers in order, -1 or a missing entry leaves a worker unpinned
+	explicit WorkStealingScheduler(size_t workers, const std::vector<int>& cores = {});
+	~WorkStealingScheduler();
+
+	WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+	WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+	void submit(Task task);
+
+	// Until every task submitted so far has run. Rethrows the first exception a task threw
+	void wait();
+
+	size_t workers() const noexcept { return queues.size(); }
+
+	// Only meaningful once wait() returned
+	const std::vector<WorkerStatistics>& statistics() const noexcept { return stats; }
+
+private:
+	struct alignas(64) Queue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	void run(size_t worker);
+	bool takeOwn(size_t worker, Task& task);
+	bool steal(size_t worker, Task& task);
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<WorkerStatistics> stats; // Each written only by its worker
+	std::vector<std::thread> threads;
+	std::atomic<size_t> nextQueue{ 0 };  // For tasks from outside the workers
+
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::atomic<size_t> queued{ 0 };     // Tasks in the deques
+	bool stopping = false;
+
+	std::mutex idleMutex;
+	std::condition_variable idle;
+	std::atomic<size_t> unfinished{ 0 }; // Submitted and not yet run to the end
+	std::exception_ptr error;
+};
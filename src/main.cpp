@@ -1,14 +1,38 @@
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 
+#include "Column_File.hpp"
+#include "Event_Log.hpp"
 #include "PCAP_Parser.hpp"
+#include "Parallel_Decoder.hpp"
+#include "Pipeline.hpp"
 
 int main(int argc, char* argv[])
 {
 	std::string pcapDumpFile = "";
 	std::string outputFile = "output.json";
+	std::string templateList = "";
+	std::string mode = "json";
+	std::string depth = "";
+	std::string interval = "";
+	std::string threads = "";
+	std::string volume = "";
+	bool verify = false;
+	std::string checkpoint = "";
+	std::string checkpointInterval = "";
+	std::string restore = "";
+	bool pipeline = false;
+	std::string pin = "";
+	std::string scan = "";
+	std::string range = "";
+	std::string replay = "";
+	std::string fieldList = "";
+	std::string compression = "";
+	std::string compressionThreads = "";
 
 	for (int i = 1; i < argc; ++i)
 	{
@@ -21,19 +45,240 @@ int main(int argc, char* argv[])
 		{
 	        outputFile = argv[++i];
 	    }
+	    else if ((arg == "-t" || arg == "--templates") && i + 1 < argc)
+		{
+	        templateList = argv[++i];
+	    }
+	    else if ((arg == "-m" || arg == "--mode") && i + 1 < argc)
+		{
+	        mode = argv[++i];
+	    }
+	    else if ((arg == "-d" || arg == "--depth") && i + 1 < argc)
+		{
+	        depth = argv[++i];
+	    }
+	    else if ((arg == "-i" || arg == "--interval") && i + 1 < argc)
+		{
+	        interval = argv[++i];
+	    }
+	    else if ((arg == "-v" || arg == "--volume") && i + 1 < argc)
+		{
+	        volume = argv[++i];
+	    }
+	    else if (arg == "--checkpoint" && i + 1 < argc)
+		{
+	        checkpoint = argv[++i];
+	    }
+	    else if (arg == "--checkpoint-interval" && i + 1 < argc)
+		{
+	        checkpointInterval = argv[++i];
+	    }
+	    else if (arg == "--restore" && i + 1 < argc)
+		{
+	        restore = argv[++i];
+	    }
+	    else if (arg == "--verify")
+		{
+	        verify = true;
+	    }
+	    else if (arg == "--pipeline")
+		{
+	        pipeline = true;
+	    }
+	    else if (arg == "--pin" && i + 1 < argc)
+		{
+	        pin = argv[++i];
+	    }
+	    else if (arg == "--fields" && i + 1 < argc)
+		{
+	        fieldList = argv[++i];
+	    }
+	    else if (arg == "--compress" && i + 1 < argc)
+		{
+	        compression = argv[++i];
+	    }
+	    else if (arg == "--compress-threads" && i + 1 < argc)
+		{
+	        compressionThreads = argv[++i];
+	    }
+	    else if (arg == "--replay" && i + 1 < argc)
+		{
+	        replay = argv[++i];
+	    }
+	    else if (arg == "--scan" && i + 1 < argc)
+		{
+	        scan = argv[++i];
+	    }
+	    else if (arg == "--range" && i + 1 < argc)
+		{
+	        range = argv[++i];
+	    }
+	    else if ((arg == "-j" || arg == "--threads") && i + 1 < argc)
+		{
+	        threads = argv[++i];
+	    }
+	}
+
+	// Reads a column file written in columns mode, no capture is involved
+	if (!scan.empty())
+	{
+		try
+		{
+			const size_t colon = range.find(':');
+			const std::string low = range.substr(0, colon);
+			const std::string high = colon == std::string::npos ? low : range.substr(colon + 1);
+
+			ColumnReader column(scan);
+			const ColumnScan result = scanColumn(column, low, high);
+			std::cout << result.matches << " of " << result.rows << " rows in range, "
+				<< result.chunksRead << " of " << result.chunks << " chunks read" << std::endl;
+		}
+		catch (const std::exception& e)
+		{
+			std::cerr << "Error: " << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
 	}
 
-	if (pcapDumpFile.empty() || outputFile.empty()) {
-	    std::cerr << "Usage: " << std::endl << " -p [pcap file] " << std::endl << " -o [output file]" << std::endl;
+	if ((pcapDumpFile.empty() && replay.empty()) || outputFile.empty()) {
+	    std::cerr << "Usage: " << std::endl << " -p [pcap file] " << std::endl << " -o [output file]" << std::endl
+	        << " --replay [event log written in log mode, read instead of a pcap file] (optional)" << std::endl
+	        << " -t [template IDs to decode, e.g. 15,16] (optional, default all)" << std::endl
+	        << " --fields [Template.Field names written in json and ndjson modes, e.g. OrderUpdate.SecurityID,OrderUpdate.MDEntryPx] (optional, default all)" << std::endl
+	        << " -m [output mode: json, ndjson, l3, l2, bbo, trades, bars, columns, arrow, log] (optional, default json)" << std::endl
+	        << " -d [levels per side in l2 mode] (optional, default 10)" << std::endl
+	        << " -i [microseconds between l2 snapshots or per bar] (optional, default 0: on every change, 60 seconds for bars)" << std::endl
+	        << " -v [contracts per bar, instead of bars by time] (optional)" << std::endl
+	        << " -j [threads decoding the capture in json, ndjson and arrow modes or building books in l3, l2 and bbo modes] (optional, default 1)" << std::endl
+	        << " --verify [check live books against the snapshot feed] (optional)" << std::endl
+	        << " --checkpoint [prefix of book state checkpoint files, one is written at the end] (optional)" << std::endl
+	        << " --checkpoint-interval [seconds of SendingTime between checkpoints] (optional)" << std::endl
+	        << " --restore [checkpoint file to continue from] (optional)" << std::endl
+	        << " --pipeline [json or ndjson output through input, framing, decode, serialize and write threads] (optional)" << std::endl
+	        << " --pin [cores of the pipeline stages in that order, then of the -j workers, -1 for none, e.g. 0,1,2,3,-1] (optional)" << std::endl
+	        << " --compress [zstd or lz4 with an optional level, e.g. zstd:3, of the output file in every mode but columns and arrow] (optional)" << std::endl
+	        << " --compress-threads [zstd workers compressing the output] (optional, default 1)" << std::endl
+	        << " --scan [column file written in columns mode, counts the values in --range instead of parsing] (optional)" << std::endl
+	        << " --range [low:high bounds of --scan, either may be empty, a single value matches only itself] (optional)" << std::endl;
 	    return EXIT_FAILURE;
 	}
 
-	std::cout << "Start processing file: " << pcapDumpFile << std::endl;
+	std::cout << "Start processing file: " << (replay.empty() ? pcapDumpFile : replay) << std::endl;
 
 	try
 	{
-		PCAPParser parser(pcapDumpFile, outputFile);
-		parser.parse();
+		ParserOptions options;
+		if (!templateList.empty())
+			options.templates = TemplateFilter::parse(templateList);
+
+		if (mode == "json")
+			options.mode = OutputMode::JSON;
+		else if (mode == "ndjson")
+			options.mode = OutputMode::NDJSON;
+		else if (mode == "l3")
+			options.mode = OutputMode::L3Book;
+		else if (mode == "l2")
+			options.mode = OutputMode::L2Depth;
+		else if (mode == "bbo")
+			options.mode = OutputMode::BBO;
+		else if (mode == "trades")
+			options.mode = OutputMode::Trades;
+		else if (mode == "bars")
+			options.mode = OutputMode::Bars;
+		else if (mode == "columns")
+			options.mode = OutputMode::Columns;
+		else if (mode == "arrow")
+			options.mode = OutputMode::Arrow;
+		else if (mode == "log")
+			options.mode = OutputMode::EventLog;
+		else
+			throw std::runtime_error("Unknown output mode: " + mode);
+
+		if (!depth.empty())
+			options.depth = std::stoul(depth);
+		if (options.depth == 0)
+			throw std::runtime_error("Depth must be at least one level");
+		if (!interval.empty())
+			options.interval = std::stoull(interval) * 1000;
+		if (!volume.empty())
+			options.barVolume = std::stoll(volume);
+		if (options.barVolume < 0 || (options.barVolume != 0 && options.interval != 0))
+			throw std::runtime_error("Bars are either by time or by a positive volume");
+		if (options.mode == OutputMode::Bars && options.interval == 0 && options.barVolume == 0)
+			options.interval = 60'000'000'000ULL; // One minute bars
+		options.verifyBooks = verify;
+		options.checkpointPath = checkpoint;
+		if (!checkpointInterval.empty())
+			options.checkpointInterval = std::stoull(checkpointInterval) * 1'000'000'000ULL;
+		options.restorePath = restore;
+		if (!threads.empty())
+			options.threads = std::stoul(threads);
+		if (options.threads == 0)
+			throw std::runtime_error("At least one thread is needed");
+		options.pipeline = pipeline;
+		const bool json = options.mode == OutputMode::JSON || options.mode == OutputMode::NDJSON;
+		if (!fieldList.empty())
+		{
+			if (!json)
+				throw std::runtime_error("--fields only applies to json and ndjson output");
+			options.fields = FieldProjection::parse(fieldList);
+			if (options.templates.decodesAll())
+				options.templates = options.fields.templates(); // Templates without a selected field are not written
+		}
+		if (!compression.empty())
+		{
+			if (options.mode == OutputMode::Columns || options.mode == OutputMode::Arrow)
+				throw std::runtime_error("--compress does not apply to the columns and arrow directories");
+			options.compression = CompressionOptions::parse(compression);
+			if (!CompressionOptions::available(options.compression.codec))
+				throw std::runtime_error("This build has no support for " + compression.substr(0, compression.find(':')) + " compression");
+		}
+		if (!compressionThreads.empty())
+		{
+			if (options.compression.codec != CompressionOptions::Codec::Zstd)
+				throw std::runtime_error("--compress-threads only applies to zstd compression");
+			options.compression.threads = std::stoul(compressionThreads);
+		}
+		if (pipeline && !json)
+			throw std::runtime_error("The pipeline only writes json and ndjson output");
+		if (!pin.empty())
+		{
+			if (!pipeline)
+				throw std::runtime_error("--pin only applies to the pipeline stages");
+			std::stringstream cores(pin);
+			std::string core;
+			while (std::getline(cores, core, ','))
+				options.stageCores.push_back(std::stoi(core));
+			if (options.stageCores.size() > Pipeline::STAGES + (options.threads > 1 ? options.threads : 0))
+				throw std::runtime_error("More cores given than pipeline stages and workers to pin");
+		}
+
+		if (!replay.empty())
+		{
+			if (pipeline || !checkpoint.empty() || !restore.empty())
+				throw std::runtime_error("An event log is replayed on its own, without --pipeline or checkpoints");
+			EventLogReader log(replay);
+			std::unique_ptr<PacketSink> sink = PCAPParser::createSink(outputFile, options);
+			const uint64_t packets = log.replay(*sink, options.templates);
+			sink.reset(); // Sinks write their remaining output when destroyed
+			std::cout << packets << " packets replayed" << std::endl;
+		}
+		else if (options.pipeline)
+		{
+			Pipeline pipeline(pcapDumpFile, outputFile, options);
+			pipeline.parse();
+		}
+		else if ((json || options.mode == OutputMode::Arrow) && options.threads > 1)
+		{
+			ParallelDecoder decoder(pcapDumpFile, outputFile, options);
+			decoder.parse();
+		}
+		else
+		{
+			PCAPParser parser(pcapDumpFile, outputFile, options);
+			parser.parse();
+		}
 	}
 	catch (const std::exception& e)
 	{